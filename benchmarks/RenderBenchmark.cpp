@@ -0,0 +1,129 @@
+// Times the image conversion and blending kernels used when rendering a room. Build with
+// -DLANDSTALKER_BUILD_BENCHMARKS=ON and run without arguments.
+
+#include <main/AlphaBlend.h>
+#include <main/ImageBufferWx.h>
+
+#include <wx/init.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// Roughly the size of the largest rooms, in pixels
+	const int ROOM_WIDTH = 2048;
+	const int ROOM_HEIGHT = 1280;
+	const std::size_t ROOM_PIXELS = static_cast<std::size_t>(ROOM_WIDTH) * ROOM_HEIGHT;
+
+	// Stops the optimiser from discarding work whose result is otherwise unused
+	volatile unsigned int g_sink = 0;
+
+	void Consume(unsigned int value)
+	{
+		g_sink = g_sink + value;
+	}
+
+	void Run(const char* name, int iterations, const std::function<void()>& fn)
+	{
+		fn();
+		const auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < iterations; ++i)
+		{
+			fn();
+		}
+		const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		std::printf("%-40s %10.3f ms\n", name, elapsed.count() / iterations);
+	}
+
+	std::vector<uint8_t> RandomBytes(std::size_t count, std::mt19937& rng)
+	{
+		std::vector<uint8_t> bytes(count);
+		std::uniform_int_distribution<int> dist(0, 255);
+		for (auto& b : bytes)
+		{
+			b = static_cast<uint8_t>(dist(rng));
+		}
+		return bytes;
+	}
+
+	// Sprite and overlay alpha is mostly runs of clear and opaque pixels
+	std::vector<uint8_t> RunAlpha(std::size_t count, std::mt19937& rng)
+	{
+		std::vector<uint8_t> alpha(count);
+		std::uniform_int_distribution<int> kind(0, 9);
+		std::uniform_int_distribution<int> len(8, 64);
+		std::size_t i = 0;
+		while (i < count)
+		{
+			const int k = kind(rng);
+			const uint8_t value = k < 5 ? 0x00 : k < 9 ? 0xFF : 0x80;
+			const std::size_t end = std::min(count, i + len(rng));
+			for (; i < end; ++i)
+			{
+				alpha[i] = value;
+			}
+		}
+		return alpha;
+	}
+
+	void BenchmarkMakeImage()
+	{
+		ImageBufferWx buf(ROOM_WIDTH, ROOM_HEIGHT);
+		std::vector<std::shared_ptr<Landstalker::Palette>> pals;
+		for (int i = 0; i < 4; ++i)
+		{
+			pals.push_back(std::make_shared<Landstalker::Palette>());
+		}
+
+		std::printf("MakeImage, %dx%d buffer\n", ROOM_WIDTH, ROOM_HEIGHT);
+		// Get() bumps the buffer version, so every conversion misses the memo as it would
+		// have before the memo was added
+		Run("  rgb, uncached", 20, [&]() { buf.Get(); Consume(buf.MakeImage(pals).GetData()[0]); });
+		Run("  rgb, memoised", 200, [&]() { Consume(buf.MakeImage(pals).GetData()[0]); });
+		Run("  rgb + alpha, uncached", 20, [&]() { buf.Get(); Consume(buf.MakeImage(pals, true).GetAlpha()[0]); });
+		Run("  rgb + alpha, memoised", 200, [&]() { Consume(buf.MakeImage(pals, true).GetAlpha()[0]); });
+		Run("  rgb + alpha, memoised + copy", 50, [&]() { Consume(buf.MakeImage(pals, true).Copy().GetAlpha()[0]); });
+	}
+
+	void BenchmarkAlphaBlend()
+	{
+		std::mt19937 rng(1234);
+		const auto src_rgb = RandomBytes(ROOM_PIXELS * 3, rng);
+		const auto src_alpha = RunAlpha(ROOM_PIXELS, rng);
+		const auto priority = RunAlpha(ROOM_PIXELS, rng);
+		auto dst_rgb = RandomBytes(ROOM_PIXELS * 3, rng);
+		auto dst_alpha = RunAlpha(ROOM_PIXELS, rng);
+		auto alpha = src_alpha;
+
+		std::printf("AlphaBlend, %zu pixels\n", ROOM_PIXELS);
+		Run("  ClampAlpha", 200, [&]() { AlphaBlend::ClampAlpha(alpha.data(), ROOM_PIXELS, 0x80); });
+		Run("  ClampAlphaScalar", 200, [&]() { AlphaBlend::ClampAlphaScalar(alpha.data(), ROOM_PIXELS, 0x80); });
+		Run("  ClampAlpha (priority)", 200, [&]() { AlphaBlend::ClampAlpha(alpha.data(), priority.data(), ROOM_PIXELS, 0x80); });
+		Run("  ClampAlphaScalar (priority)", 200, [&]() { AlphaBlend::ClampAlphaScalar(alpha.data(), priority.data(), ROOM_PIXELS, 0x80); });
+		Run("  BlendOver", 50, [&]() { AlphaBlend::BlendOver(dst_rgb.data(), src_rgb.data(), src_alpha.data(), ROOM_PIXELS); });
+		Run("  BlendOverScalar", 50, [&]() { AlphaBlend::BlendOverScalar(dst_rgb.data(), src_rgb.data(), src_alpha.data(), ROOM_PIXELS); });
+		Run("  BlendOver (opacity)", 50, [&]() { AlphaBlend::BlendOver(dst_rgb.data(), src_rgb.data(), src_alpha.data(), ROOM_PIXELS, 0xA0); });
+		Run("  BlendOverScalar (opacity)", 50, [&]() { AlphaBlend::BlendOverScalar(dst_rgb.data(), src_rgb.data(), src_alpha.data(), ROOM_PIXELS, 0xA0); });
+		Run("  BlendOverAlpha", 50, [&]() { AlphaBlend::BlendOverAlpha(dst_rgb.data(), dst_alpha.data(), src_rgb.data(), src_alpha.data(), ROOM_PIXELS); });
+		Run("  BlendOverAlphaScalar", 50, [&]() { AlphaBlend::BlendOverAlphaScalar(dst_rgb.data(), dst_alpha.data(), src_rgb.data(), src_alpha.data(), ROOM_PIXELS); });
+		Consume(dst_rgb[0] + dst_alpha[0] + alpha[0]);
+	}
+}
+
+int main()
+{
+	wxInitializer initializer;
+	if (!initializer.IsOk())
+	{
+		std::fprintf(stderr, "Failed to initialise wxWidgets\n");
+		return 1;
+	}
+	BenchmarkMakeImage();
+	BenchmarkAlphaBlend();
+	return 0;
+}
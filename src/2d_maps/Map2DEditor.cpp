@@ -3,6 +3,8 @@
 #include <wx/dcmemory.h>
 #include <wx/dcbuffer.h>
 #include <algorithm>
+#include <main/TileAtlas.h>
+#include <main/UndoJournal.h>
 
 wxBEGIN_EVENT_TABLE(Map2DEditor, wxHVScrolledWindow)
 EVT_PAINT(Map2DEditor::OnPaint)
@@ -30,6 +32,7 @@ Map2DEditor::Map2DEditor(wxWindow* parent)
 	  m_tileset_entry(nullptr),
 	  m_g(nullptr),
 	  m_active_palette(nullptr),
+	  m_journal(nullptr),
 	  m_mode(Map2DEditor::Mode::SELECT),
 	  m_pixelsize(8),
 	  m_selectable(true),
@@ -42,6 +45,7 @@ Map2DEditor::Map2DEditor(wxWindow* parent)
 	  m_enablehover(true),
 	  m_enablealpha(true),
 	  m_redraw_all(true),
+	  m_chunks(CHUNK_SIZE, CHUNK_CACHE_BYTES),
       m_drawtile(Tile(0))
 {
 	SetRowColumnCount(1, 1);
@@ -133,12 +137,12 @@ void Map2DEditor::RedrawTiles(int index)
 	}
 	else
 	{
-		for (std::size_t x = 0; x < m_map->GetWidth(); ++x)
-			for (std::size_t y = 0; y < m_map->GetHeight(); ++y)
+		for (std::size_t y = 0; y < m_map->GetHeight(); ++y)
+			for (std::size_t x = 0; x < m_map->GetWidth(); ++x)
 			{
 				if (m_map->GetTile(x, y).GetIndex() == index)
 				{
-					m_redraw_list.insert(x + y * m_map->GetWidth());
+					InvalidateTile(x + y * m_map->GetWidth());
 					refresh = true;
 				}
 			}
@@ -151,13 +155,13 @@ void Map2DEditor::RedrawTiles(int index)
 
 void Map2DEditor::RedrawMapTile(const TilePosition& tp)
 {
-	m_redraw_list.insert(tp.x + tp.y * m_map->GetWidth());
+	InvalidateTile(ToIndex(tp));
 	Refresh(true);
 }
 
 void Map2DEditor::RedrawMapTile(int index)
 {
-	m_redraw_list.insert(index);
+	InvalidateTile(index);
 	Refresh(true);
 }
 
@@ -278,7 +282,6 @@ void Map2DEditor::SetSelectionEnabled(bool enabled)
 {
 	if (m_enableselection != enabled)
 	{
-		m_redraw_list.insert(m_selectedtile);
 		if (enabled == false)
 		{
 			m_selectedtile = -1;
@@ -297,7 +300,7 @@ void Map2DEditor::SetHoverEnabled(bool enabled)
 {
 	if (m_enablehover != enabled)
 	{
-		m_redraw_list.insert(m_selectedtile);
+		InvalidateTile(m_hoveredtile);
 		if (enabled == false)
 		{
 			m_hoveredtile = -1;
@@ -394,9 +397,26 @@ Tile Map2DEditor::GetTileAtPosition(const TilePosition& tp) const
 
 void Map2DEditor::SetTileAtPosition(const TilePosition& tp, const Tile& tile)
 {
-	m_map->SetTile(tile, tp.x, tp.y);
-	RedrawMapTile(tp);
-	FireEvent(EVT_MAP_CHANGE, std::to_string(ToIndex(tp)));
+	if (m_journal != nullptr)
+	{
+		auto map = m_map;
+		auto delta = std::make_unique<CellDelta<std::pair<int, int>, Tile>>(map.get(),
+			[this, map](const std::pair<int, int>& pos, const Tile& value) { WriteTile(map, { pos.first, pos.second }, value); },
+			nullptr);
+		delta->Add({ tp.x, tp.y }, m_map->GetTile(tp.x, tp.y), tile);
+		m_journal->Push("Draw Tile", std::move(delta));
+	}
+	WriteTile(m_map, tp, tile);
+}
+
+void Map2DEditor::WriteTile(std::shared_ptr<Tilemap2D> map, const TilePosition& tp, const Tile& tile)
+{
+	map->SetTile(tile, tp.x, tp.y);
+	if (map == m_map)
+	{
+		RedrawMapTile(tp);
+		FireEvent(EVT_MAP_CHANGE, std::to_string(ToIndex(tp)));
+	}
 }
 
 bool Map2DEditor::IsPositionValid(const TilePosition& tp) const
@@ -437,72 +457,148 @@ bool Map2DEditor::UpdateRowCount()
 
 void Map2DEditor::DrawTile(wxDC& dc, int x, int y, const Tile& tile)
 {
-	wxPen pen = dc.GetPen();
-	wxBrush brush = dc.GetBrush();
+	const auto& tile_pixels = TileAtlas::GetTile(m_tileset, GetSelectedPalette(), tile);
+	m_blitter.Draw(dc, x, y, tile_pixels.data(), m_tileset->GetTileWidth(), m_tileset->GetTileHeight(), m_pixelsize);
+}
+
+Tile Map2DEditor::GetDisplayedTile(int x, int y) const
+{
+	if (m_enablehover && (m_mode != Mode::SELECT) && IsHoverValid() && ToIndex({ x,y }) == m_hoveredtile)
+	{
+		// Preview when in draw mode
+		return m_drawtile;
+	}
+	return m_map->GetTile(x, y);
+}
+
+void Map2DEditor::DrawTileAtPosition(wxDC& dc, int x, int y)
+{
+	const int cellwidth = m_tileset->GetTileWidth() * m_pixelsize;
+	const int cellheight = m_tileset->GetTileHeight() * m_pixelsize;
+
+	dc.SetPen(*wxTRANSPARENT_PEN);
+	dc.SetBrush(m_enablealpha ? *m_alpha_brush : *wxBLACK_BRUSH);
+	dc.DrawRectangle({ x * cellwidth, y * cellheight, cellwidth, cellheight });
+	const auto t = GetDisplayedTile(x, y);
+	DrawTile(dc, x * cellwidth, y * cellheight, t);
+	DrawTileDecorations(dc, x, y, t);
+}
+
+void Map2DEditor::DrawTileRow(wxDC& dc, int y, int first_x, int last_x)
+{
+	const int cellwidth = m_tileset->GetTileWidth() * m_pixelsize;
+	const int cellheight = m_tileset->GetTileHeight() * m_pixelsize;
 
-	pen.SetStyle(wxPENSTYLE_TRANSPARENT);
-	brush.SetStyle(wxBRUSHSTYLE_SOLID);
-	dc.SetPen(pen);
+	dc.SetPen(*wxTRANSPARENT_PEN);
+	dc.SetBrush(m_enablealpha ? *m_alpha_brush : *wxBLACK_BRUSH);
+	dc.DrawRectangle({ first_x * cellwidth, y * cellheight, (last_x - first_x) * cellwidth, cellheight });
+	// All tiles of the row are enlarged into one image, which is blitted once
+	m_blitter.Begin(first_x * cellwidth, y * cellheight, (last_x - first_x) * cellwidth, cellheight);
+	for (int x = first_x; x < last_x; ++x)
+	{
+		const auto& tile_pixels = TileAtlas::GetTile(m_tileset, GetSelectedPalette(), GetDisplayedTile(x, y));
+		m_blitter.Add((x - first_x) * cellwidth, 0, tile_pixels.data(), m_tileset->GetTileWidth(),
+			m_tileset->GetTileHeight(), m_pixelsize);
+	}
+	m_blitter.End(dc);
+	for (int x = first_x; x < last_x; ++x)
+	{
+		DrawTileDecorations(dc, x, y, GetDisplayedTile(x, y));
+	}
+}
 
-	auto tile_pixels = m_tileset->GetTileBGRA(tile, *GetSelectedPalette());
+void Map2DEditor::DrawTileDecorations(wxDC& dc, int x, int y, const Tile& t)
+{
+	const int cellwidth = m_tileset->GetTileWidth() * m_pixelsize;
+	const int cellheight = m_tileset->GetTileHeight() * m_pixelsize;
 
-	for (std::size_t i = 0; i < tile_pixels.size(); ++i)
+	if (m_enableborders)
+	{
+		dc.SetPen(*m_border_pen);
+		dc.SetBrush(*wxTRANSPARENT_BRUSH);
+		dc.DrawRectangle({ x * cellwidth, y * cellheight, cellwidth + 1, cellheight + 1 });
+	}
+	if (m_enabletilenumbers)
 	{
-		int xx = x + (i % m_tileset->GetTileWidth()) * m_pixelsize;
-		int yy = y + (i / m_tileset->GetTileWidth()) * m_pixelsize;
-		brush.SetColour(wxColour(tile_pixels[i]));
-		dc.SetBrush(brush);
-		// Has alpha
-		if ((tile_pixels[i] & 0xFF000000) > 0)
+		auto label = wxString::Format("%03d%c%c%c", t.GetIndex(), t.Attributes().getAttribute(TileAttributes::Attribute::ATTR_HFLIP) ? 'H' : ' ',
+			t.Attributes().getAttribute(TileAttributes::Attribute::ATTR_VFLIP) ? 'V' : ' ',
+			t.Attributes().getAttribute(TileAttributes::Attribute::ATTR_PRIORITY) ? '!' : ' ');
+		auto extent = dc.GetTextExtent(label);
+		if ((extent.GetWidth() < cellwidth - 2) && (extent.GetHeight() < cellheight - 2))
 		{
-			dc.DrawRectangle({ xx, yy, m_pixelsize, m_pixelsize });
+			dc.DrawText(label, { x * cellwidth + 2, y * cellheight + 2 });
 		}
 	}
 }
 
-bool Map2DEditor::DrawTileAtPosition(wxDC& dc, int x, int y)
+void Map2DEditor::InvalidateTile(int index)
 {
-	bool retval = false;
-	wxPosition s = GetVisibleBegin();
-	wxPosition e = GetVisibleEnd();
+	const auto tp = ToPosition(index);
+	if (index < 0 || !IsPositionValid(tp))
+	{
+		return;
+	}
+	m_chunks.InvalidateTile(index);
+}
 
-	int cellwidth = m_tileset->GetTileWidth() * m_pixelsize;
-	int cellheight = m_tileset->GetTileHeight() * m_pixelsize;
+void Map2DEditor::ClearChunks()
+{
+	m_chunks.Clear();
+	m_chunk_bmps.clear();
+}
 
-	dc.SetBrush(*wxTRANSPARENT_BRUSH);
-	if ((x >= s.GetCol()) && (x < e.GetCol()) &&
-		(y >= s.GetRow()) && (y < e.GetRow()))
+void Map2DEditor::EvictChunks()
+{
+	for (int key : m_chunks.Evict())
 	{
-		dc.SetPen(*wxTRANSPARENT_PEN);
-		dc.SetBrush(m_enablealpha ? *m_alpha_brush : *wxBLACK_BRUSH);
-		dc.DrawRectangle({ x * cellwidth, y * cellheight, cellwidth, cellheight });
-		auto t = m_map->GetTile(x, y);
-		if (m_enablehover && (m_mode != Mode::SELECT) && IsHoverValid() && ToIndex({ x,y }) == m_hoveredtile)
-		{
-			// Preview when in draw mode
-			t = m_drawtile;
-		}
-		DrawTile(dc, x * cellwidth, y * cellheight, t);
-		if (m_enableborders)
+		m_chunk_bmps.erase(key);
+	}
+}
+
+wxBitmap& Map2DEditor::UpdateChunk(int cx, int cy)
+{
+	// Leaves the chunk bitmap selected into m_memdc, with the device origin set so that tiles
+	// are drawn at their map pixel coordinates
+	const int cellwidth = m_tileset->GetTileWidth() * m_pixelsize;
+	const int cellheight = m_tileset->GetTileHeight() * m_pixelsize;
+	const int first_x = cx * CHUNK_SIZE;
+	const int first_y = cy * CHUNK_SIZE;
+	const int last_x = std::min(first_x + CHUNK_SIZE, GetTilemapWidth());
+	const int last_y = std::min(first_y + CHUNK_SIZE, GetTilemapHeight());
+	const int key = m_chunks.GetKey(cx, cy);
+
+	const bool cached = m_chunks.Touch(key);
+	wxBitmap& bmp = m_chunk_bmps[key];
+	if (!cached)
+	{
+		// One extra pixel for the right and bottom tile borders. It overlaps the next chunk,
+		// which is blitted later and draws the same border.
+		bmp.Create((last_x - first_x) * cellwidth + 1, (last_y - first_y) * cellheight + 1);
+		m_chunks.Insert(key, bmp.GetWidth() * bmp.GetHeight() * 4);
+	}
+
+	m_memdc.SelectObject(bmp);
+	m_memdc.SetDeviceOrigin(-first_x * cellwidth, -first_y * cellheight);
+	m_memdc.SetTextForeground(wxColour(255, 255, 255));
+	m_memdc.SetTextBackground(wxColour(150, 150, 150));
+	m_memdc.SetBackgroundMode(wxSOLID);
+	if (cached)
+	{
+		for (int index : m_chunks.TakeDirtyTiles(key))
 		{
-			dc.SetPen(*m_border_pen);
-			dc.SetBrush(*wxTRANSPARENT_BRUSH);
-			dc.DrawRectangle({ x * cellwidth, y * cellheight, cellwidth + 1, cellheight + 1 });
+			DrawTileAtPosition(m_memdc, index % GetTilemapWidth(), index / GetTilemapWidth());
 		}
-		if (m_enabletilenumbers)
+	}
+	else
+	{
+		m_memdc.SetBackground(wxBrush(wxSystemSettings::GetColour(wxSYS_COLOUR_APPWORKSPACE)));
+		m_memdc.Clear();
+		for (int y = first_y; y < last_y; ++y)
 		{
-			auto label = wxString::Format("%03d%c%c%c", t.GetIndex(), t.Attributes().getAttribute(TileAttributes::Attribute::ATTR_HFLIP) ? 'H' : ' ',
-				t.Attributes().getAttribute(TileAttributes::Attribute::ATTR_VFLIP) ? 'V' : ' ',
-				t.Attributes().getAttribute(TileAttributes::Attribute::ATTR_PRIORITY) ? '!' : ' ');
-			auto extent = dc.GetTextExtent(label);
-			if ((extent.GetWidth() < cellwidth - 2) && (extent.GetHeight() < cellheight - 2))
-			{
-				dc.DrawText(label, { x * cellwidth + 2, y * cellheight + 2 });
-			}
+			DrawTileRow(m_memdc, y, first_x, last_x);
 		}
-		retval = true;
 	}
-	return retval;
+	return bmp;
 }
 
 void Map2DEditor::DrawSelectionBorders(wxDC& dc)
@@ -536,23 +632,45 @@ void Map2DEditor::PaintBitmap(wxDC& dc)
 {
 	dc.SetBackground(wxBrush(wxSystemSettings::GetColour(wxSYS_COLOUR_APPWORKSPACE)));
 	dc.Clear();
-	int sx = GetVisibleColumnsBegin() * m_tileset->GetTileWidth() * m_pixelsize;
-	int sy = GetVisibleRowsBegin() * m_tileset->GetTileHeight() * m_pixelsize;
+	const int cellwidth = m_tileset->GetTileWidth() * m_pixelsize;
+	const int cellheight = m_tileset->GetTileHeight() * m_pixelsize;
+	const int chunkwidth = cellwidth * CHUNK_SIZE;
+	const int chunkheight = cellheight * CHUNK_SIZE;
+	const int sx = GetVisibleColumnsBegin() * cellwidth;
+	const int sy = GetVisibleRowsBegin() * cellheight;
 
-	int vX, vY, vW, vH;                 // Dimensions of client area in pixels
-	wxRegionIterator upd(GetUpdateRegion()); // get the update rect list
-	while (upd)
+	// Only chunks touching the update region are rasterised, in row-major order
+	wxRect box = GetUpdateRegion().GetBox();
+	if (box.IsEmpty())
 	{
-		vX = upd.GetX();
-		vY = upd.GetY();
-		vW = upd.GetW();
-		vH = upd.GetH();
-		// Alternatively we can do this:
-		// wxRect rect(upd.GetRect());
-		// Repaint this rectangle
-		dc.Blit(vX + sx, vY + sy, vW, vH, &m_memdc, vX + sx, vY + sy);
-		upd++;
+		return;
 	}
+	box.Offset(sx, sy);
+	const int cx_begin = std::max(0, box.GetLeft() / chunkwidth);
+	const int cy_begin = std::max(0, box.GetTop() / chunkheight);
+	const int cx_end = std::min(m_chunks.GetColumns(), box.GetRight() / chunkwidth + 1);
+	const int cy_end = std::min(m_chunks.GetRows(), box.GetBottom() / chunkheight + 1);
+	for (int cy = cy_begin; cy < cy_end; ++cy)
+	{
+		for (int cx = cx_begin; cx < cx_end; ++cx)
+		{
+			const wxBitmap& bmp = UpdateChunk(cx, cy);
+			const wxRect chunk_rect(cx * chunkwidth, cy * chunkheight, bmp.GetWidth(), bmp.GetHeight());
+			for (wxRegionIterator upd(GetUpdateRegion()); upd; ++upd)
+			{
+				wxRect rect = upd.GetRect();
+				rect.Offset(sx, sy);
+				rect.Intersect(chunk_rect);
+				if (!rect.IsEmpty())
+				{
+					dc.Blit(rect.GetX(), rect.GetY(), rect.GetWidth(), rect.GetHeight(), &m_memdc, rect.GetX(), rect.GetY());
+				}
+			}
+			m_memdc.SetDeviceOrigin(0, 0);
+			m_memdc.SelectObject(wxNullBitmap);
+		}
+	}
+	EvictChunks();
 }
 
 void Map2DEditor::InitialiseBrushesAndPens()
@@ -632,10 +750,6 @@ Map2DEditor::TilePosition Map2DEditor::ConvertXYToTilePos(const wxPoint& point)
 void Map2DEditor::SelectTile(const TilePosition& tp)
 {
 	int tile = ToIndex(tp);
-	if ((m_selectedtile != -1) && (tile != m_selectedtile))
-	{
-		m_redraw_list.insert(m_selectedtile);
-	}
 	if (tile != m_selectedtile)
 	{
 		FireEvent(EVT_MAP_SELECT, std::to_string(m_selectedtile));
@@ -647,30 +761,21 @@ void Map2DEditor::SelectTile(const TilePosition& tp)
 
 void Map2DEditor::OnDraw(wxDC& dc)
 {
-	if (!m_tileset)
+	if (!m_tileset || !m_map)
 	{
 		return;
 	}
-	int columns = m_map->GetWidth();
-	int rows = m_map->GetHeight();
-	int cellwidth = m_tileset->GetTileWidth() * m_pixelsize;
-	int cellheight = m_tileset->GetTileHeight() * m_pixelsize;
-
-	if (m_redraw_all == true)
-	{
-		m_bmp.Create(cellwidth * columns + 1, cellheight * rows + 1);
-	}
-	m_memdc.SelectObject(m_bmp);
-	if (m_redraw_all == true)
+	const wxSize cell_size(m_tileset->GetTileWidth() * m_pixelsize, m_tileset->GetTileHeight() * m_pixelsize);
+	const wxSize map_size(GetTilemapWidth(), GetTilemapHeight());
+	if (m_redraw_all || cell_size != m_chunk_cell_size || map_size != m_chunk_map_size)
 	{
-		m_memdc.SetBackground(wxBrush(wxSystemSettings::GetColour(wxSYS_COLOUR_APPWORKSPACE)));
-		m_memdc.Clear();
+		ClearChunks();
+		m_chunks.SetMapSize(map_size.GetWidth(), map_size.GetHeight());
+		m_chunk_cell_size = cell_size;
+		m_chunk_map_size = map_size;
+		m_redraw_all = false;
 	}
 
-	m_memdc.SetTextForeground(wxColour(255, 255, 255));
-	m_memdc.SetTextBackground(wxColour(150, 150, 150));
-	m_memdc.SetBackgroundMode(wxSOLID);
-
 	if (m_pixelsize > 3)
 	{
 		m_border_pen->SetStyle(wxPENSTYLE_SOLID);
@@ -680,45 +785,8 @@ void Map2DEditor::OnDraw(wxDC& dc)
 		m_border_pen->SetStyle(wxPENSTYLE_TRANSPARENT);
 	}
 
-	m_memdc.SetBrush(*wxTRANSPARENT_BRUSH);
-	if (m_redraw_all == true)
-	{
-		m_redraw_list.clear();
-		for (std::size_t x = 0; x < m_map->GetWidth(); ++x)
-			for (std::size_t y = 0; y < m_map->GetHeight(); ++y)
-			{
-				int i = x + y * m_map->GetWidth();
-				if (!DrawTileAtPosition(m_memdc, x, y))
-				{
-					m_redraw_list.insert(i);
-				}
-			}
-		m_redraw_all = false;
-	}
-	else
-	{
-		auto it = m_redraw_list.begin();
-		while (it != m_redraw_list.end())
-		{
-			if ((*it >= 0) && (*it < static_cast<int>(m_map->GetWidth() * m_map->GetHeight())))
-			{
-				int x = *it % m_map->GetWidth();
-				int y = *it / m_map->GetWidth();
-				if (DrawTileAtPosition(m_memdc, x, y))
-				{
-					m_redraw_list.erase(it++);
-				}
-				else
-				{
-					++it;
-				}
-			}
-		}
-	}
-
-	DrawSelectionBorders(m_memdc);
 	PaintBitmap(dc);
-	m_memdc.SelectObject(wxNullBitmap);
+	DrawSelectionBorders(dc);
 }
 
 void Map2DEditor::OnPaint(wxPaintEvent& /*evt*/)
@@ -740,12 +808,11 @@ void Map2DEditor::OnMouseMove(wxMouseEvent& evt)
 {
 	if (!m_enablehover) return;
 	int sel = ConvertXYToTileIdx(evt.GetPosition());
-	if ((m_hoveredtile != -1) && (sel != m_hoveredtile))
-	{
-		m_redraw_list.insert(m_hoveredtile);
-	}
 	if (sel != m_hoveredtile)
 	{
+		// The draw tile is previewed in place of the hovered tile
+		InvalidateTile(m_hoveredtile);
+		InvalidateTile(sel);
 		m_hoveredtile = sel;
 		FireEvent(EVT_MAP_HOVER, std::to_string(m_hoveredtile));
 		Refresh();
@@ -758,7 +825,7 @@ void Map2DEditor::OnMouseLeave(wxMouseEvent& evt)
 	if (!m_enablehover) return;
 	if (m_hoveredtile != -1)
 	{
-		m_redraw_list.insert(m_hoveredtile);
+		InvalidateTile(m_hoveredtile);
 		m_hoveredtile = -1;
 		FireEvent(EVT_MAP_HOVER, std::to_string(m_hoveredtile));
 		Refresh();
@@ -814,7 +881,11 @@ bool Map2DEditor::InsertRow(int row)
 		return false;
 	}
 	auto pos = GetSelection();
-	m_map->InsertRow(row, GetSelectedTile());
+	auto map = m_map;
+	const auto fill = GetSelectedTile();
+	m_map->InsertRow(row, fill);
+	JournalResize("Insert Row", [map, row]() { map->DeleteRow(row); },
+		[map, row, fill]() { map->InsertRow(row, fill); });
 	SetRowColumnCount(m_map->GetHeight(), m_map->GetWidth());
 	SetSelection(pos);
 	RedrawTiles();
@@ -828,7 +899,22 @@ bool Map2DEditor::DeleteRow(int row)
 		return false;
 	}
 	auto pos = GetSelection();
+	auto map = m_map;
+	std::vector<Tile> tiles;
+	for (int x = 0; x < static_cast<int>(m_map->GetWidth()); ++x)
+	{
+		tiles.push_back(m_map->GetTile(x, row));
+	}
 	m_map->DeleteRow(row);
+	JournalResize("Delete Row", [map, row, tiles]()
+		{
+			map->InsertRow(row, Tile());
+			for (int x = 0; x < static_cast<int>(tiles.size()); ++x)
+			{
+				map->SetTile(tiles[x], x, row);
+			}
+		},
+		[map, row]() { map->DeleteRow(row); }, tiles.size() * sizeof(Tile));
 	SetRowColumnCount(m_map->GetHeight(), m_map->GetWidth());
 	SetSelection(pos);
 	RedrawTiles();
@@ -842,7 +928,11 @@ bool Map2DEditor::InsertColumn(int column)
 		return false;
 	}
 	auto pos = GetSelection();
-	m_map->InsertColumn(column, GetSelectedTile());
+	auto map = m_map;
+	const auto fill = GetSelectedTile();
+	m_map->InsertColumn(column, fill);
+	JournalResize("Insert Column", [map, column]() { map->DeleteColumn(column); },
+		[map, column, fill]() { map->InsertColumn(column, fill); });
 	SetRowColumnCount(m_map->GetHeight(), m_map->GetWidth());
 	SetSelection(pos);
 	RedrawTiles();
@@ -856,10 +946,53 @@ bool Map2DEditor::DeleteColumn(int column)
 		return false;
 	}
 	auto pos = GetSelection();
+	auto map = m_map;
+	std::vector<Tile> tiles;
+	for (int y = 0; y < static_cast<int>(m_map->GetHeight()); ++y)
+	{
+		tiles.push_back(m_map->GetTile(column, y));
+	}
 	m_map->DeleteColumn(column);
+	JournalResize("Delete Column", [map, column, tiles]()
+		{
+			map->InsertColumn(column, Tile());
+			for (int y = 0; y < static_cast<int>(tiles.size()); ++y)
+			{
+				map->SetTile(tiles[y], column, y);
+			}
+		},
+		[map, column]() { map->DeleteColumn(column); }, tiles.size() * sizeof(Tile));
 	SetRowColumnCount(m_map->GetHeight(), m_map->GetWidth());
 	SetSelection(pos);
 	RedrawTiles();
 	return true;
 }
 
+void Map2DEditor::JournalResize(const std::string& description, std::function<void()> undo, std::function<void()> redo, std::size_t size)
+{
+	if (m_journal == nullptr)
+	{
+		return;
+	}
+	auto map = m_map;
+	auto refresh = [this, map]()
+	{
+		if (map == m_map)
+		{
+			OnMapResized();
+		}
+	};
+	m_journal->Push(description, std::make_unique<ActionDelta>(
+		[undo, refresh]() { undo(); refresh(); },
+		[redo, refresh]() { redo(); refresh(); }, size));
+}
+
+void Map2DEditor::OnMapResized()
+{
+	auto pos = GetSelection();
+	SetRowColumnCount(m_map->GetHeight(), m_map->GetWidth());
+	SetSelection(pos);
+	RedrawTiles();
+	FireEvent(EVT_MAP_CHANGE, "");
+}
+
@@ -9,12 +9,17 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <functional>
 
 #include <landstalker/tileset/Tileset.h>
 #include <landstalker/palettes/Palette.h>
 #include <landstalker/main/DataTypes.h>
 #include <landstalker/main/GameData.h>
 #include <landstalker/2d_maps/Tilemap2DRLE.h>
+#include <main/TileBlitter.h>
+#include <2d_maps/MapChunkCache.h>
+
+class UndoJournal;
 
 class Map2DEditor : public wxHVScrolledWindow
 {
@@ -48,6 +53,8 @@ public:
 
 	void SetGameData(std::shared_ptr<Landstalker::GameData> gd) { m_g = gd; }
 	void ClearGameData() { m_g = nullptr; }
+	// Tile and row/column edits are recorded here if set
+	void SetUndoJournal(UndoJournal* journal) { m_journal = journal; }
 
 	void SetPixelSize(int n);
 	int GetPixelSize() const;
@@ -99,7 +106,14 @@ private:
 
 	bool UpdateRowCount();
 	void DrawTile(wxDC& dc, int x, int y, const Landstalker::Tile& tile);
-	bool DrawTileAtPosition(wxDC& dc, int x, int y);
+	void DrawTileAtPosition(wxDC& dc, int x, int y);
+	void DrawTileRow(wxDC& dc, int y, int first_x, int last_x);
+	void DrawTileDecorations(wxDC& dc, int x, int y, const Landstalker::Tile& tile);
+	Landstalker::Tile GetDisplayedTile(int x, int y) const;
+	void InvalidateTile(int index);
+	void ClearChunks();
+	void EvictChunks();
+	wxBitmap& UpdateChunk(int cx, int cy);
 	void DrawSelectionBorders(wxDC& dc);
 	void PaintBitmap(wxDC& dc);
 	void InitialiseBrushesAndPens();
@@ -110,6 +124,9 @@ private:
 	int ConvertXYToTileIdx(const wxPoint& point) const;
 	TilePosition ConvertXYToTilePos(const wxPoint& point) const;
 	void SelectTile(const TilePosition& tp);
+	void WriteTile(std::shared_ptr<Landstalker::Tilemap2D> map, const TilePosition& tp, const Landstalker::Tile& tile);
+	void JournalResize(const std::string& description, std::function<void()> undo, std::function<void()> redo, std::size_t size = 0);
+	void OnMapResized();
 
 	void OnDraw(wxDC& dc);
 	void OnPaint(wxPaintEvent& evt);
@@ -128,6 +145,7 @@ private:
 	std::shared_ptr<Landstalker::TilesetEntry> m_tileset_entry;
 	std::shared_ptr<Landstalker::GameData> m_g;
 	std::shared_ptr<Landstalker::PaletteEntry> m_active_palette;
+	UndoJournal* m_journal;
 	Landstalker::Palette m_default_palette;
 
 	Mode m_mode;
@@ -144,8 +162,13 @@ private:
 	bool m_enablehover;
 	bool m_enablealpha;
 
+	// The map is rasterised in square chunks of tiles, drawn when they first scroll into view.
+	// m_chunks decides which stay cached and which of their tiles need redrawing.
 	bool m_redraw_all;
-	std::set<int> m_redraw_list;
+	MapChunkCache m_chunks;
+	std::map<int, wxBitmap> m_chunk_bmps;
+	wxSize m_chunk_cell_size;
+	wxSize m_chunk_map_size;
 	Landstalker::Tile m_drawtile;
 
 	std::unique_ptr<wxBrush> m_alpha_brush;
@@ -154,9 +177,12 @@ private:
 	std::unique_ptr<wxPen> m_highlighted_border_pen;
 	std::unique_ptr<wxBrush> m_highlighted_brush;
 	std::unique_ptr<wxBitmap> m_stipple;
+	TileBlitter m_blitter;
 
 	wxMemoryDC m_memdc;
-	wxBitmap m_bmp;
+
+	static const int CHUNK_SIZE = 16;
+	static const std::size_t CHUNK_CACHE_BYTES = 64 * 1024 * 1024;
 
 	wxDECLARE_EVENT_TABLE();
 };
@@ -33,6 +33,7 @@ enum MENU_IDS
 	ID_FILE_EXPORT_PNG,
 	ID_FILE_IMPORT_BIN,
 	ID_FILE_IMPORT_CSV,
+	ID_EDIT,
 	ID_VIEW,
 	ID_VIEW_TOGGLE_GRIDLINES,
 	ID_VIEW_TOGGLE_TILE_NOS,
@@ -48,6 +49,7 @@ EVT_SLIDER(ID_ZOOM_SLIDER, Map2DEditorFrame::OnZoomChange)
 EVT_SLIDER(ID_TILESET_ZOOM, Map2DEditorFrame::OnTilesetZoomChange)
 EVT_COMMAND(wxID_ANY, EVT_MAP_SELECT, Map2DEditorFrame::OnTileChanged)
 EVT_COMMAND(wxID_ANY, EVT_MAP_HOVER, Map2DEditorFrame::OnTileHovered)
+EVT_COMMAND(wxID_ANY, EVT_MAP_CHANGE, Map2DEditorFrame::OnMapChanged)
 EVT_COMMAND(wxID_ANY, EVT_TILESET_SELECT, Map2DEditorFrame::OnTileSelect)
 EVT_COMMAND(wxID_ANY, EVT_MAP_EDIT_REQUEST, Map2DEditorFrame::OnTileEditRequested)
 EVT_COMBOBOX(ID_TILESET_SELECT, Map2DEditorFrame::OnTilesetSelect)
@@ -74,6 +76,7 @@ Map2DEditorFrame::Map2DEditorFrame(wxWindow* parent, ImageList* imglst)
 	m_mgr.SetManagedWindow(this);
 
 	m_mapedit = new Map2DEditor(this);
+	m_mapedit->SetUndoJournal(&m_journal);
 	m_tileset = new TilesetEditor(this);
 	m_mapedit->SetPixelSize(m_zoom);
 	m_tileset->SetPixelSize(4);
@@ -103,6 +106,7 @@ void Map2DEditorFrame::Open(const std::string& map_name)
 	m_palette = m_gd->GetPalette(m_tiles->GetDefaultPalette());
 
 	m_mapedit->Open(m_map);
+	m_journal.Clear();
 	m_tileset->Open(m_tiles->GetData());
 	m_tileset->SetActivePalette(m_tiles->GetDefaultPalette());
 	m_tile = 0;
@@ -119,6 +123,7 @@ void Map2DEditorFrame::SetGameData(std::shared_ptr<GameData> gd)
 	m_gd = gd;
 	m_tileset->SetGameData(gd);
 	m_mapedit->SetGameData(gd);
+	m_journal.Clear();
 }
 
 void Map2DEditorFrame::ClearGameData()
@@ -126,6 +131,7 @@ void Map2DEditorFrame::ClearGameData()
 	m_gd = nullptr;
 	m_tileset->SetGameData(nullptr);
 	m_mapedit->ClearGameData();
+	m_journal.Clear();
 	if (m_tileset_select != nullptr)
 	{
 		m_tileset_select->Clear();
@@ -181,6 +187,17 @@ void Map2DEditorFrame::Redraw()
 	m_tileset->RedrawTiles();
 }
 
+void Map2DEditorFrame::RecolourPalette(const Landstalker::Palette* palette)
+{
+	if (m_palette == nullptr || (palette != nullptr && palette != m_palette->GetData().get()))
+	{
+		return;
+	}
+	// The tile atlas has already dropped the tiles decoded with the old colours
+	m_mapedit->RedrawTiles();
+	m_tileset->RecolourTiles();
+}
+
 void Map2DEditorFrame::RedrawTiles(int index) const
 {
 	m_mapedit->RedrawTiles(index);
@@ -323,6 +340,13 @@ void Map2DEditorFrame::OnTileHovered(wxCommandEvent& evt)
 	evt.Skip();
 }
 
+void Map2DEditorFrame::OnMapChanged(wxCommandEvent& evt)
+{
+	FireEvent(EVT_STATUSBAR_UPDATE);
+	FireEvent(EVT_PROPERTIES_UPDATE);
+	evt.Skip();
+}
+
 void Map2DEditorFrame::OnTileSelect(wxCommandEvent& evt)
 {
 	int tileId = std::stoi(evt.GetString().ToStdString());
@@ -551,17 +575,20 @@ void Map2DEditorFrame::InitMenu(wxMenuBar& menu, ImageList& ilist) const
 	AddMenuItem(fileMenu, 2, ID_FILE_EXPORT_PNG, "Export Tileset as PNG...");
 	AddMenuItem(fileMenu, 3, ID_FILE_IMPORT_BIN, "Import Tileset from Binary...");
 	AddMenuItem(fileMenu, 4, ID_FILE_IMPORT_CSV, "Import Tileset from CSV...");
-	auto& viewMenu = AddMenu(menu, 1, ID_VIEW, "View");
+	auto& editMenu = AddMenu(menu, 1, ID_EDIT, "Edit");
+	AddUndoMenuItems(editMenu, 0);
+	auto& viewMenu = AddMenu(menu, 2, ID_VIEW, "View");
 	AddMenuItem(viewMenu, 0, ID_VIEW_TOGGLE_GRIDLINES, "Gridlines", wxITEM_CHECK);
 	AddMenuItem(viewMenu, 1, ID_VIEW_TOGGLE_TILE_NOS, "Tile Numbers", wxITEM_CHECK);
 	AddMenuItem(viewMenu, 2, ID_VIEW_TOGGLE_ALPHA, "Show Alpha as Black", wxITEM_CHECK);
-	auto& toolsMenu = AddMenu(menu, 2, ID_TOOLS, "Tools");
+	auto& toolsMenu = AddMenu(menu, 3, ID_TOOLS, "Tools");
 	AddMenuItem(toolsMenu, 0, ID_TOOLS_TILES, "Tiles", wxITEM_CHECK);
 	AddMenuItem(toolsMenu, 1, ID_TOOLS_TILEMAP_TOOLBAR, "Tilemap Toolbar", wxITEM_CHECK);
 	AddMenuItem(toolsMenu, 2, ID_TOOLS_TILESET_TOOLBAR, "Tileset Toolbar", wxITEM_CHECK);
 
 	wxAuiToolBar* tilemap_tb = new wxAuiToolBar(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxAUI_TB_DEFAULT_STYLE | wxAUI_TB_HORIZONTAL);
 
+	AddUndoTools(*tilemap_tb, "Tilemap", ilist);
 	tilemap_tb->AddTool(ID_TOGGLE_GRIDLINES, "Toggle Gridlines", ilist.GetImage("gridlines"), "Toggle Gridlines", wxITEM_CHECK);
 	tilemap_tb->AddTool(ID_TOGGLE_TILE_NUMBERS, "Toggle Tile Numbers", ilist.GetImage("tile_nums"), "Toggle Tile Numbers", wxITEM_CHECK);
 	tilemap_tb->AddTool(ID_TOGGLE_ALPHA, "Toggle Alpha", ilist.GetImage("alpha"), "Toggle Alpha", wxITEM_CHECK);
@@ -603,12 +630,17 @@ void Map2DEditorFrame::InitMenu(wxMenuBar& menu, ImageList& ilist) const
 	
 	InitCombos();
 	UpdateUI();
+	UpdateUndoUI();
 
 	m_mgr.Update();
 }
 
 void Map2DEditorFrame::OnMenuClick(wxMenuEvent& evt)
 {
+	if (HandleUndoMenuClick(evt.GetId()))
+	{
+		return;
+	}
 	switch (evt.GetId())
 	{
 	case ID_FILE_EXPORT_BIN:
@@ -890,6 +922,7 @@ void Map2DEditorFrame::OnImportBin()
 		{
 			ImportBin(path, base & 0xFFFF);
 		}
+		m_journal.Clear();
 	}
 	m_mapedit->RedrawAll();
 	FireEvent(EVT_PROPERTIES_UPDATE);
@@ -903,6 +936,7 @@ void Map2DEditorFrame::OnImportCsv()
 	{
 		std::string path = fd.GetPath().ToStdString();
 		ImportCsv(path);
+		m_journal.Clear();
 	}
 	m_mapedit->RedrawAll();
 	FireEvent(EVT_PROPERTIES_UPDATE);
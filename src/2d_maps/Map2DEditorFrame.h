@@ -15,6 +15,7 @@ public:
 
 	virtual void SetGameData(std::shared_ptr<Landstalker::GameData> gd);
 	virtual void ClearGameData();
+	virtual void RecolourPalette(const Landstalker::Palette* palette) override;
 
 	void SetActivePalette(const std::string& name);
 	void SetTileset(const std::string& name);
@@ -37,6 +38,7 @@ private:
 	void OnTilesetZoomChange(wxCommandEvent& evt);
 	void OnTileChanged(wxCommandEvent& evt);
 	void OnTileHovered(wxCommandEvent& evt);
+	void OnMapChanged(wxCommandEvent& evt);
 	void OnTileSelect(wxCommandEvent& evt);
 	void OnTileEditRequested(wxCommandEvent& evt);
 	void OnTilesetSelect(wxCommandEvent& evt);
@@ -0,0 +1,125 @@
+#include <2d_maps/MapChunkCache.h>
+
+MapChunkCache::MapChunkCache(int chunk_size, std::size_t max_bytes)
+	: m_chunk_size(chunk_size),
+	  m_max_bytes(max_bytes),
+	  m_width(0),
+	  m_height(0),
+	  m_bytes(0)
+{
+}
+
+void MapChunkCache::SetMapSize(int width, int height)
+{
+	if (width != m_width || height != m_height)
+	{
+		Clear();
+		m_width = width;
+		m_height = height;
+	}
+}
+
+void MapChunkCache::Clear()
+{
+	m_chunks.clear();
+	m_lru.clear();
+	m_bytes = 0;
+}
+
+int MapChunkCache::GetColumns() const
+{
+	return (m_width + m_chunk_size - 1) / m_chunk_size;
+}
+
+int MapChunkCache::GetRows() const
+{
+	return (m_height + m_chunk_size - 1) / m_chunk_size;
+}
+
+int MapChunkCache::GetKey(int cx, int cy) const
+{
+	return cy * GetColumns() + cx;
+}
+
+bool MapChunkCache::InvalidateTile(int index)
+{
+	if (index < 0 || index >= m_width * m_height)
+	{
+		return false;
+	}
+	const int x = index % m_width;
+	const int y = index / m_width;
+	auto it = m_chunks.find(GetKey(x / m_chunk_size, y / m_chunk_size));
+	if (it == m_chunks.end())
+	{
+		return false;
+	}
+	it->second.dirty.insert(index);
+	return true;
+}
+
+bool MapChunkCache::Touch(int key)
+{
+	auto it = m_chunks.find(key);
+	if (it == m_chunks.end())
+	{
+		return false;
+	}
+	m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+	return true;
+}
+
+void MapChunkCache::Insert(int key, std::size_t bytes)
+{
+	auto it = m_chunks.find(key);
+	if (it != m_chunks.end())
+	{
+		m_bytes -= it->second.bytes;
+		m_lru.erase(it->second.lru);
+		m_chunks.erase(it);
+	}
+	m_lru.push_front(key);
+	m_chunks.emplace(key, Chunk{ bytes, {}, m_lru.begin() });
+	m_bytes += bytes;
+}
+
+std::set<int> MapChunkCache::TakeDirtyTiles(int key)
+{
+	std::set<int> dirty;
+	auto it = m_chunks.find(key);
+	if (it != m_chunks.end())
+	{
+		dirty.swap(it->second.dirty);
+	}
+	return dirty;
+}
+
+std::vector<int> MapChunkCache::Evict()
+{
+	std::vector<int> evicted;
+	while (m_bytes > m_max_bytes && m_lru.size() > 1)
+	{
+		const int key = m_lru.back();
+		auto it = m_chunks.find(key);
+		m_bytes -= it->second.bytes;
+		m_chunks.erase(it);
+		m_lru.pop_back();
+		evicted.push_back(key);
+	}
+	return evicted;
+}
+
+bool MapChunkCache::IsCached(int key) const
+{
+	return m_chunks.find(key) != m_chunks.end();
+}
+
+std::size_t MapChunkCache::GetCount() const
+{
+	return m_chunks.size();
+}
+
+std::size_t MapChunkCache::GetBytes() const
+{
+	return m_bytes;
+}
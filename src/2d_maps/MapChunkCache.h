@@ -0,0 +1,63 @@
+#ifndef _MAP_CHUNK_CACHE_H_
+#define _MAP_CHUNK_CACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+// Bookkeeping for a tilemap rasterised in square chunks of tiles. Chunks are identified by
+// key (row * columns + column) and kept in least recently used order under a memory limit.
+// Tiles are invalidated within the chunk that holds them; chunks not in the cache have
+// nothing to invalidate, as they will be drawn in full when next needed. The rasterised
+// images themselves are kept by the caller, under the same keys.
+class MapChunkCache
+{
+public:
+	MapChunkCache(int chunk_size, std::size_t max_bytes);
+
+	// Discards every chunk if the map dimensions differ from the ones the chunks were drawn at
+	void SetMapSize(int width, int height);
+	void Clear();
+
+	int GetColumns() const;
+	int GetRows() const;
+	int GetKey(int cx, int cy) const;
+
+	// Marks a tile, given as y * width + x, for redrawing. Returns false if its chunk is not
+	// cached.
+	bool InvalidateTile(int index);
+	// Makes a chunk the most recently used. Returns false if it is not cached.
+	bool Touch(int key);
+	// Adds a chunk that has just been drawn in full as the most recently used
+	void Insert(int key, std::size_t bytes);
+	// Returns the tiles marked for redrawing in a cached chunk in row-major order, and
+	// forgets them
+	std::set<int> TakeDirtyTiles(int key);
+	// Discards the least recently used chunks while over the memory limit, always keeping the
+	// most recently used one. Returns the keys of the discarded chunks.
+	std::vector<int> Evict();
+
+	bool IsCached(int key) const;
+	std::size_t GetCount() const;
+	std::size_t GetBytes() const;
+private:
+	struct Chunk
+	{
+		std::size_t bytes;
+		std::set<int> dirty;
+		std::list<int>::iterator lru;
+	};
+
+	int m_chunk_size;
+	std::size_t m_max_bytes;
+	int m_width;
+	int m_height;
+	std::map<int, Chunk> m_chunks;
+	// Most recently used first
+	std::list<int> m_lru;
+	std::size_t m_bytes;
+};
+
+#endif // _MAP_CHUNK_CACHE_H_
@@ -0,0 +1,165 @@
+#include <blockset/BlockSummaryIndex.h>
+
+std::map<const Landstalker::Blockset*, std::shared_ptr<BlockSummaryIndex>> BlockSummaryIndex::s_indexes;
+
+BlockSummaryIndex::BlockSummaryIndex(const std::shared_ptr<Landstalker::Blockset>& blockset)
+	: m_blockset(blockset),
+	  m_valid(false)
+{
+}
+
+std::shared_ptr<BlockSummaryIndex> BlockSummaryIndex::Get(const std::shared_ptr<Landstalker::Blockset>& blockset)
+{
+	if (!blockset)
+	{
+		return nullptr;
+	}
+	for (auto it = s_indexes.begin(); it != s_indexes.end();)
+	{
+		if (it->second->m_blockset.expired())
+		{
+			it = s_indexes.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+	auto it = s_indexes.find(blockset.get());
+	if (it == s_indexes.end() || it->second->m_blockset.lock() != blockset)
+	{
+		// A different blockset may have been allocated at the same address
+		it = s_indexes.insert_or_assign(blockset.get(),
+			std::shared_ptr<BlockSummaryIndex>(new BlockSummaryIndex(blockset))).first;
+	}
+	return it->second;
+}
+
+void BlockSummaryIndex::Invalidate(const Landstalker::Blockset* blockset)
+{
+	auto it = s_indexes.find(blockset);
+	if (it != s_indexes.end())
+	{
+		it->second->m_valid = false;
+	}
+}
+
+void BlockSummaryIndex::Rebuild()
+{
+	m_valid = false;
+	Validate();
+}
+
+void BlockSummaryIndex::Update(int block)
+{
+	auto blockset = m_blockset.lock();
+	if (!m_valid || !blockset || block < 0 || block >= static_cast<int>(m_summaries.size()))
+	{
+		m_valid = false;
+		return;
+	}
+	m_summaries[block] = Summarise(blockset->at(block));
+}
+
+void BlockSummaryIndex::Insert(int block)
+{
+	auto blockset = m_blockset.lock();
+	if (!m_valid || !blockset || block < 0 || block > static_cast<int>(m_summaries.size()) ||
+		blockset->size() != m_summaries.size() + 1)
+	{
+		m_valid = false;
+		return;
+	}
+	m_summaries.insert(m_summaries.cbegin() + block, Summarise(blockset->at(block)));
+}
+
+void BlockSummaryIndex::Erase(int block)
+{
+	auto blockset = m_blockset.lock();
+	if (!m_valid || !blockset || block < 0 || block >= static_cast<int>(m_summaries.size()) ||
+		blockset->size() + 1 != m_summaries.size())
+	{
+		m_valid = false;
+		return;
+	}
+	m_summaries.erase(m_summaries.cbegin() + block);
+}
+
+const BlockSummaryIndex::Summary& BlockSummaryIndex::GetSummary(int block) const
+{
+	static const Summary EMPTY;
+	Validate();
+	if (block < 0 || block >= static_cast<int>(m_summaries.size()))
+	{
+		return EMPTY;
+	}
+	return m_summaries[block];
+}
+
+uint8_t BlockSummaryIndex::GetPriorityMask(int block) const
+{
+	return GetSummary(block).priority;
+}
+
+bool BlockSummaryIndex::HasPriority(int block) const
+{
+	return GetSummary(block).priority != 0;
+}
+
+bool BlockSummaryIndex::HasFlip(int block) const
+{
+	const auto& summary = GetSummary(block);
+	return (summary.hflip | summary.vflip) != 0;
+}
+
+bool BlockSummaryIndex::IsBlank(int block) const
+{
+	return GetSummary(block).blank;
+}
+
+BlockSummaryIndex::Summary BlockSummaryIndex::Summarise(const Landstalker::MapBlock& block)
+{
+	Summary summary;
+	for (std::size_t i = 0; i < Landstalker::MapBlock::GetBlockSize(); ++i)
+	{
+		const auto& tile = block.GetTile(i);
+		const uint8_t bit = 1 << i;
+		if (tile.Attributes().getAttribute(Landstalker::TileAttributes::Attribute::ATTR_PRIORITY))
+		{
+			summary.priority |= bit;
+		}
+		if (tile.Attributes().getAttribute(Landstalker::TileAttributes::Attribute::ATTR_HFLIP))
+		{
+			summary.hflip |= bit;
+		}
+		if (tile.Attributes().getAttribute(Landstalker::TileAttributes::Attribute::ATTR_VFLIP))
+		{
+			summary.vflip |= bit;
+		}
+		if (tile.GetIndex() != 0)
+		{
+			summary.blank = false;
+		}
+	}
+	return summary;
+}
+
+void BlockSummaryIndex::Validate() const
+{
+	auto blockset = m_blockset.lock();
+	// A size mismatch means the blockset was resized behind our back
+	if (m_valid && (!blockset || blockset->size() == m_summaries.size()))
+	{
+		return;
+	}
+	m_summaries.clear();
+	if (blockset)
+	{
+		m_summaries.reserve(blockset->size());
+		for (const auto& block : *blockset)
+		{
+			m_summaries.push_back(Summarise(block));
+		}
+	}
+	m_valid = true;
+}
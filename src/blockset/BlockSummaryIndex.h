@@ -0,0 +1,54 @@
+#ifndef _BLOCK_SUMMARY_INDEX_H_
+#define _BLOCK_SUMMARY_INDEX_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include <landstalker/blockset/Block.h>
+
+// Per-block summary of tile attributes, so that editors can ask whether a block has any
+// priority or flipped tiles without walking its tiles every frame. Each mask holds one bit
+// per tile, in MapBlock tile order.
+class BlockSummaryIndex
+{
+public:
+	struct Summary
+	{
+		uint8_t priority = 0;
+		uint8_t hflip = 0;
+		uint8_t vflip = 0;
+		// Set when every tile in the block is tile 0
+		bool blank = true;
+	};
+
+	// Returns the index shared by every editor looking at this blockset, building it if
+	// needed. Indexes for blocksets that have since been destroyed are discarded.
+	static std::shared_ptr<BlockSummaryIndex> Get(const std::shared_ptr<Landstalker::Blockset>& blockset);
+	// Marks the shared index as stale after the blockset was changed by other means
+	static void Invalidate(const Landstalker::Blockset* blockset);
+
+	void Rebuild();
+	void Update(int block);
+	void Insert(int block);
+	void Erase(int block);
+
+	const Summary& GetSummary(int block) const;
+	uint8_t GetPriorityMask(int block) const;
+	bool HasPriority(int block) const;
+	bool HasFlip(int block) const;
+	bool IsBlank(int block) const;
+private:
+	explicit BlockSummaryIndex(const std::shared_ptr<Landstalker::Blockset>& blockset);
+
+	static Summary Summarise(const Landstalker::MapBlock& block);
+	void Validate() const;
+
+	std::weak_ptr<Landstalker::Blockset> m_blockset;
+	mutable std::vector<Summary> m_summaries;
+	mutable bool m_valid;
+
+	static std::map<const Landstalker::Blockset*, std::shared_ptr<BlockSummaryIndex>> s_indexes;
+};
+
+#endif // _BLOCK_SUMMARY_INDEX_H_
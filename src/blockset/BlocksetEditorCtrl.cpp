@@ -5,6 +5,8 @@
 #include <wx/dcmemory.h>
 #include <wx/dcbuffer.h>
 #include <main/EditorFrame.h>
+#include <main/TileAtlas.h>
+#include <main/UndoJournal.h>
 
 wxBEGIN_EVENT_TABLE(BlocksetEditorCtrl, wxVScrolledWindow)
 EVT_PAINT(BlocksetEditorCtrl::OnPaint)
@@ -26,6 +28,7 @@ wxDEFINE_EVENT(EVT_TILE_SELECT, wxCommandEvent);
 BlocksetEditorCtrl::BlocksetEditorCtrl(EditorFrame* parent)
 	: wxVScrolledWindow(parent, wxID_ANY),
 	  m_blocks(std::make_shared<Landstalker::Blockset>()),
+	  m_summary(BlockSummaryIndex::Get(m_blocks)),
 	  m_mode(Mode::BLOCK_SELECT),
 	  m_columns(0),
 	  m_rows(0),
@@ -83,6 +86,7 @@ bool BlocksetEditorCtrl::Open(const std::string& name)
 	}
 	m_blockset_entry = m_gd->GetRoomData()->GetBlockset(name);
 	m_blocks = m_blockset_entry->GetData();
+	m_summary = BlockSummaryIndex::Get(m_blocks);
 	auto tse = m_gd->GetRoomData()->GetTileset(m_blockset_entry->GetTileset());
 	m_tileset = tse->GetData();
 	m_pal_name = tse->GetDefaultPalette();
@@ -111,6 +115,7 @@ bool BlocksetEditorCtrl::OpenRoom(uint16_t roomnum)
 	m_mode = Mode::BLOCK_SELECT;
 	m_drawtile = Landstalker::Tile();
 	m_blocks = m_gd->GetRoomData()->GetCombinedBlocksetForRoom(roomnum);
+	m_summary = BlockSummaryIndex::Get(m_blocks);
 	auto tse = m_gd->GetRoomData()->GetTilesetForRoom(roomnum);
 	m_tileset = tse->GetData();
 	m_pal_name = m_gd->GetRoomData()->GetPaletteForRoom(roomnum)->GetName();
@@ -442,12 +447,11 @@ bool BlocksetEditorCtrl::InsertBlock(int row)
 {
 	if (m_blocks && row >= 0 && row <= static_cast<int>(m_blocks->size()))
 	{
-		m_blocks->insert(m_blocks->cbegin() + row, Landstalker::MapBlock());
-		for (int i = row; i < static_cast<int>(m_blocks->size()); ++i)
-		{
-			m_redraw_list.insert(i);
-			Refresh(true);
-		}
+		auto blocks = m_blocks;
+		InsertBlockAt(blocks, row, Landstalker::MapBlock());
+		m_frame->GetUndoJournal().Push("Insert Block", std::make_unique<ActionDelta>(
+			[this, blocks, row]() { EraseBlockAt(blocks, row); FireEvent(EVT_BLOCK_CHANGE, ""); },
+			[this, blocks, row]() { InsertBlockAt(blocks, row, Landstalker::MapBlock()); FireEvent(EVT_BLOCK_CHANGE, ""); }));
 		return true;
 	}
 	return false;
@@ -457,15 +461,44 @@ bool BlocksetEditorCtrl::DeleteBlock(int row)
 {
 	if (m_blocks && row >= 0 && row < static_cast<int>(m_blocks->size()))
 	{
-		m_blocks->erase(m_blocks->cbegin() + row);
+		auto blocks = m_blocks;
+		const auto block = m_blocks->at(row);
+		EraseBlockAt(blocks, row);
+		m_frame->GetUndoJournal().Push("Delete Block", std::make_unique<ActionDelta>(
+			[this, blocks, row, block]() { InsertBlockAt(blocks, row, block); FireEvent(EVT_BLOCK_CHANGE, ""); },
+			[this, blocks, row]() { EraseBlockAt(blocks, row); FireEvent(EVT_BLOCK_CHANGE, ""); },
+			sizeof(block)));
+		return true;
+	}
+	return false;
+}
+
+void BlocksetEditorCtrl::InsertBlockAt(std::shared_ptr<Landstalker::Blockset> blocks, int row, const Landstalker::MapBlock& block)
+{
+	blocks->insert(blocks->cbegin() + row, block);
+	BlockSummaryIndex::Get(blocks)->Insert(row);
+	if (blocks == m_blocks)
+	{
 		for (int i = row; i < static_cast<int>(m_blocks->size()); ++i)
 		{
 			m_redraw_list.insert(i);
-			Refresh(true);
 		}
-		return true;
+		Refresh(true);
+	}
+}
+
+void BlocksetEditorCtrl::EraseBlockAt(std::shared_ptr<Landstalker::Blockset> blocks, int row)
+{
+	blocks->erase(blocks->cbegin() + row);
+	BlockSummaryIndex::Get(blocks)->Erase(row);
+	if (blocks == m_blocks)
+	{
+		for (int i = row; i < static_cast<int>(m_blocks->size()); ++i)
+		{
+			m_redraw_list.insert(i);
+		}
+		Refresh(true);
 	}
-	return false;
 }
 
 bool BlocksetEditorCtrl::IsBlockSelectionValid() const
@@ -731,9 +764,12 @@ void BlocksetEditorCtrl::SetBlock(int block, const Landstalker::MapBlock& new_bl
 {
 	if (m_blocks && IsBlockIndexValid(block))
 	{
-		m_blocks->at(block) = new_block;
-		m_redraw_list.insert(block);
-		Refresh();
+		auto blocks = m_blocks;
+		auto delta = std::make_unique<CellDelta<int, Landstalker::MapBlock>>(blocks.get(),
+			[this, blocks](const int& b, const Landstalker::MapBlock& value) { WriteBlock(blocks, b, value); }, nullptr);
+		delta->Add(block, m_blocks->at(block), new_block);
+		WriteBlock(blocks, block, new_block);
+		m_frame->GetUndoJournal().Push("Edit Block", std::move(delta));
 	}
 }
 
@@ -741,7 +777,32 @@ void BlocksetEditorCtrl::SetTile(int block_idx, int tile_idx, const Landstalker:
 {
 	if (m_blocks && IsBlockIndexValid(block_idx) && IsTileIndexValid(tile_idx))
 	{
-		m_blocks->at(block_idx).SetTile(tile_idx, new_tile);
+		auto blocks = m_blocks;
+		auto delta = std::make_unique<CellDelta<std::pair<int, int>, Landstalker::Tile>>(blocks.get(),
+			[this, blocks](const std::pair<int, int>& t, const Landstalker::Tile& value) { WriteTile(blocks, t.first, t.second, value); }, nullptr);
+		delta->Add({ block_idx, tile_idx }, m_blocks->at(block_idx).GetTile(tile_idx), new_tile);
+		WriteTile(blocks, block_idx, tile_idx, new_tile);
+		m_frame->GetUndoJournal().Push("Edit Tile", std::move(delta));
+	}
+}
+
+void BlocksetEditorCtrl::WriteBlock(std::shared_ptr<Landstalker::Blockset> blocks, int block, const Landstalker::MapBlock& value)
+{
+	blocks->at(block) = value;
+	BlockSummaryIndex::Get(blocks)->Update(block);
+	if (blocks == m_blocks)
+	{
+		m_redraw_list.insert(block);
+		Refresh();
+	}
+}
+
+void BlocksetEditorCtrl::WriteTile(std::shared_ptr<Landstalker::Blockset> blocks, int block_idx, int tile_idx, const Landstalker::Tile& value)
+{
+	blocks->at(block_idx).SetTile(tile_idx, value);
+	BlockSummaryIndex::Get(blocks)->Update(block_idx);
+	if (blocks == m_blocks)
+	{
 		m_redraw_list.insert(block_idx);
 		Refresh();
 	}
@@ -845,72 +906,36 @@ bool BlocksetEditorCtrl::UpdateRowCount()
 	return false;
 }
 
-bool BlocksetEditorCtrl::DrawTile(wxDC& dc, int x, int y, const Landstalker::Tile& tile)
+bool BlocksetEditorCtrl::DrawBlock(wxDC& dc, int x, int y, int block_idx)
 {
-	bool retval = false;
-	int s = GetVisibleRowsBegin();
-	int e = GetVisibleRowsEnd();
-
-	const int tile_width = m_pixelsize * m_tileset->GetTileWidth();
-	const int tile_height = m_pixelsize * m_tileset->GetTileHeight();
-	const int xx = x * tile_width;
-	const int yy = y * tile_height;
-	const int ycell = y / Landstalker::MapBlock::GetBlockHeight();
-
-	dc.SetBrush(*wxTRANSPARENT_BRUSH);
-	if ((ycell >= s) && (ycell < e))
+	const auto& block = m_blocks->at(block_idx);
+	const bool retval = (y >= GetVisibleRowsBegin()) && (y < GetVisibleRowsEnd());
+	if (retval)
 	{
+		const int bx = x * m_cellwidth;
+		const int by = y * m_cellheight;
 		dc.SetPen(*wxTRANSPARENT_PEN);
 		dc.SetBrush(m_enablealpha ? *m_alpha_brush : *wxBLACK_BRUSH);
-		dc.DrawRectangle({ xx, yy, tile_width, tile_height });
-		DrawTilePixels(dc, xx, yy, tile);
+		dc.DrawRectangle({ bx, by, m_cellwidth, m_cellheight });
+		// All tiles of the block are enlarged into one image, which is blitted once
+		m_blitter.Begin(bx, by, m_cellwidth, m_cellheight);
+		for (int i = 0; i < static_cast<int>(Landstalker::MapBlock::GetBlockSize()); ++i)
+		{
+			Position pos = {i % static_cast<int>(Landstalker::MapBlock::GetBlockWidth()), i / static_cast<int>(Landstalker::MapBlock::GetBlockWidth())};
+			const auto& tile_pixels = TileAtlas::GetTile(m_tileset, m_pal, block.GetTile(pos.x, pos.y));
+			m_blitter.Add(pos.x * m_tilewidth, pos.y * m_tileheight, tile_pixels.data(),
+				m_tileset->GetTileWidth(), m_tileset->GetTileHeight(), m_pixelsize);
+		}
+		m_blitter.End(dc);
 		if (m_enableborders)
 		{
 			dc.SetPen(*m_tile_border_pen);
 			dc.SetBrush(*wxTRANSPARENT_BRUSH);
-			dc.DrawRectangle({ xx, yy, tile_width + 1, tile_height + 1 });
-		}
-		retval = true;
-	}
-	return retval;
-}
-
-void BlocksetEditorCtrl::DrawTilePixels(wxDC& dc, int x, int y, const Landstalker::Tile& tile)
-{
-	wxPen pen = dc.GetPen();
-	wxBrush brush = dc.GetBrush();
-
-	pen.SetStyle(wxPENSTYLE_TRANSPARENT);
-	brush.SetStyle(wxBRUSHSTYLE_SOLID);
-	dc.SetPen(pen);
-
-	auto tile_pixels = m_tileset->GetTileBGRA(tile, GetSelectedPalette());
-
-	for (std::size_t i = 0; i < tile_pixels.size(); ++i)
-	{
-		int xx = x + (i % m_tileset->GetTileWidth()) * m_pixelsize;
-		int yy = y + (i / m_tileset->GetTileWidth()) * m_pixelsize;
-		brush.SetColour(wxColour(tile_pixels[i]));
-		dc.SetBrush(brush);
-		// Has alpha
-		if ((tile_pixels[i] & 0xFF000000) > 0)
-		{
-			dc.DrawRectangle({ xx, yy, m_pixelsize, m_pixelsize });
-		}
-	}
-}
-
-bool BlocksetEditorCtrl::DrawBlock(wxDC& dc, int x, int y, const Landstalker::MapBlock& block)
-{
-	bool retval = true;
-	for (int i = 0; i < static_cast<int>(Landstalker::MapBlock::GetBlockSize()); ++i)
-	{
-		Position pos = {i % static_cast<int>(Landstalker::MapBlock::GetBlockWidth()), i / static_cast<int>(Landstalker::MapBlock::GetBlockWidth())};
-		const int xx = x * Landstalker::MapBlock::GetBlockWidth() + pos.x;
-		const int yy = y * Landstalker::MapBlock::GetBlockHeight() + pos.y;
-		if (!DrawTile(dc, xx, yy, block.GetTile(pos.x, pos.y)))
-		{
-			retval = false;
+			for (int i = 0; i < static_cast<int>(Landstalker::MapBlock::GetBlockSize()); ++i)
+			{
+				Position pos = {i % static_cast<int>(Landstalker::MapBlock::GetBlockWidth()), i / static_cast<int>(Landstalker::MapBlock::GetBlockWidth())};
+				dc.DrawRectangle({ bx + pos.x * m_tilewidth, by + pos.y * m_tileheight, m_tilewidth + 1, m_tileheight + 1 });
+			}
 		}
 	}
 	if (m_enableborders)
@@ -918,7 +943,7 @@ bool BlocksetEditorCtrl::DrawBlock(wxDC& dc, int x, int y, const Landstalker::Ma
 		dc.SetPen(*m_border_pen);
 		dc.SetBrush(*wxTRANSPARENT_BRUSH);
 		dc.DrawRectangle({ x * m_cellwidth, y * m_cellheight, m_cellwidth + 1, m_cellheight + 1 });
-		DrawBlockPriority(dc, x, y, block);
+		DrawBlockPriority(dc, x, y, m_summary->GetPriorityMask(block_idx));
 	}
 	if (m_enableblocknumbers)
 	{
@@ -942,16 +967,16 @@ bool BlocksetEditorCtrl::DrawBlock(wxDC& dc, int x, int y, const Landstalker::Ma
 	return retval;
 }
 
-bool BlocksetEditorCtrl::DrawBlockPriority(wxDC& dc, int x, int y, const Landstalker::MapBlock& block)
+bool BlocksetEditorCtrl::DrawBlockPriority(wxDC& dc, int x, int y, uint8_t priority_mask)
 {
 	dc.SetBrush(*wxTRANSPARENT_BRUSH);
 	dc.SetPen(*m_priority_pen);
 
 	int pri_tile_count = 0;
 	std::array<bool, Landstalker::MapBlock::GetBlockSize()> tile_priorities = {false, false, false, false};
-	for (int i = 0; i < static_cast<int>(block.GetBlockSize()); ++i)
+	for (int i = 0; i < static_cast<int>(Landstalker::MapBlock::GetBlockSize()); ++i)
 	{
-		if (block.GetTile(i).Attributes().getAttribute(Landstalker::TileAttributes::Attribute::ATTR_PRIORITY))
+		if ((priority_mask >> i) & 1)
 		{
 			++pri_tile_count;
 			tile_priorities[i] = true;
@@ -1014,7 +1039,7 @@ bool BlocksetEditorCtrl::DrawBlockPriority(wxDC& dc, int x, int y, const Landsta
 	}
 	else if (pri_tile_count > 0)
 	{
-		for (int i = 0; i < static_cast<int>(block.GetBlockSize()); ++i)
+		for (int i = 0; i < static_cast<int>(Landstalker::MapBlock::GetBlockSize()); ++i)
 		{
 			if (tile_priorities.at(i))
 			{
@@ -1266,7 +1291,7 @@ void BlocksetEditorCtrl::OnDraw(wxDC& dc)
 		for (std::size_t i = 0; i < m_blocks->size(); ++i)
 		{
 			const auto pos = ToBlockPosition(i);
-			if (!DrawBlock(m_memdc, pos.x, pos.y, m_blocks->at(i)))
+			if (!DrawBlock(m_memdc, pos.x, pos.y, i))
 			{
 				m_redraw_list.insert(i);
 			}
@@ -1281,7 +1306,7 @@ void BlocksetEditorCtrl::OnDraw(wxDC& dc)
 			if ((*it >= 0) && (*it < static_cast<int>(m_blocks->size())))
 			{
 				auto pos = ToBlockPosition(*it);
-				if (DrawBlock(m_memdc, pos.x, pos.y, m_blocks->at(*it)))
+				if (DrawBlock(m_memdc, pos.x, pos.y, *it))
 				{
 					it = m_redraw_list.erase(it);
 				}
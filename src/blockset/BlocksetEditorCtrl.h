@@ -15,6 +15,8 @@
 #include <landstalker/blockset/Block.h>
 #include <landstalker/blockset/BlocksetCmp.h>
 #include <landstalker/main/GameData.h>
+#include <blockset/BlockSummaryIndex.h>
+#include <main/TileBlitter.h>
 
 class EditorFrame;
 
@@ -119,10 +121,8 @@ private:
 	virtual wxCoord OnGetRowHeight(size_t row) const override;
 
 	bool UpdateRowCount();
-	bool DrawTile(wxDC& dc, int x, int y, const Landstalker::Tile& tile);
-	void DrawTilePixels(wxDC& dc, int x, int y, const Landstalker::Tile& tile);
-	bool DrawBlock(wxDC& dc, int x, int y, const Landstalker::MapBlock& block);
-	bool DrawBlockPriority(wxDC& dc, int x, int y, const Landstalker::MapBlock& block);
+	bool DrawBlock(wxDC& dc, int x, int y, int block_idx);
+	bool DrawBlockPriority(wxDC& dc, int x, int y, uint8_t priority_mask);
 	void DrawSelectionBorders(wxDC& dc);
 	void PaintBitmap(wxDC& dc);
 	void InitialiseBrushesAndPens();
@@ -141,6 +141,12 @@ private:
 	void OnMouseLeave(wxMouseEvent& evt);
 	void OnMouseDown(wxMouseEvent& evt);
 
+	// Edit a blockset without recording undo history. Only the open blockset is redrawn.
+	void WriteBlock(std::shared_ptr<Landstalker::Blockset> blocks, int block, const Landstalker::MapBlock& value);
+	void WriteTile(std::shared_ptr<Landstalker::Blockset> blocks, int block_idx, int tile_idx, const Landstalker::Tile& value);
+	void InsertBlockAt(std::shared_ptr<Landstalker::Blockset> blocks, int row, const Landstalker::MapBlock& block);
+	void EraseBlockAt(std::shared_ptr<Landstalker::Blockset> blocks, int row);
+
 	void FireUpdateStatusEvent(const std::string& data, int pane = 0);
 	void FireEvent(const wxEventType& e, const std::string& data);
 	void FireTilesetEvent(const wxEventType& e, const std::string& data);
@@ -148,6 +154,7 @@ private:
 
 	std::shared_ptr<Landstalker::BlocksetEntry> m_blockset_entry;
 	std::shared_ptr<Landstalker::Blockset> m_blocks;
+	std::shared_ptr<BlockSummaryIndex> m_summary;
 	std::shared_ptr<Landstalker::Tileset> m_tileset;
 	std::shared_ptr<Landstalker::Palette> m_pal;
 	std::string m_pal_name;
@@ -193,6 +200,7 @@ private:
 	std::unique_ptr<wxPen> m_highlighted_border_pen;
 	std::unique_ptr<wxBrush> m_highlighted_brush;
 	std::unique_ptr<wxBitmap> m_stipple;
+	TileBlitter m_blitter;
 	EditorFrame* m_frame;
 
 	wxMemoryDC m_memdc;
@@ -62,6 +62,7 @@ EVT_SLIDER(wxID_ANY, BlocksetEditorFrame::OnZoomChange)
 EVT_TOOL(wxID_ANY, BlocksetEditorFrame::OnButtonClicked)
 EVT_COMBOBOX(ID_PALETTE_SELECT, BlocksetEditorFrame::OnPaletteSelect)
 EVT_COMMAND(wxID_ANY, EVT_BLOCK_SELECT, BlocksetEditorFrame::OnBlockSelect)
+EVT_COMMAND(wxID_ANY, EVT_BLOCK_CHANGE, BlocksetEditorFrame::OnBlockChange)
 EVT_COMMAND(wxID_ANY, EVT_TILESET_SELECT, BlocksetEditorFrame::OnTileSelect)
 EVT_COMMAND(wxID_ANY, EVT_TILE_SELECT, BlocksetEditorFrame::OnTileSelect)
 wxEND_EVENT_TABLE()
@@ -101,6 +102,7 @@ void BlocksetEditorFrame::Open(const std::string& blockset_name)
 	m_blocks = m_gd->GetRoomData()->GetBlockset(blockset_name);
 	m_tiles = m_gd->GetRoomData()->GetTileset(m_blocks->GetTileset());
 	m_editor->Open(blockset_name);
+	m_journal.Clear();
 	m_tileset->Open(m_tiles->GetData());
 	m_tileset->SetActivePalette(m_tiles->GetDefaultPalette());
 	m_palette = m_gd->GetRoomData()->GetRoomPalette(m_tileset->GetActivePalette());
@@ -111,6 +113,7 @@ void BlocksetEditorFrame::SetGameData(std::shared_ptr<Landstalker::GameData> gd)
 	m_editor->SetGameData(gd);
 	m_tileset->SetGameData(gd);
 	m_gd = gd;
+	m_journal.Clear();
 	UpdateUI();
 	FireEvent(EVT_PROPERTIES_UPDATE);
 }
@@ -118,6 +121,7 @@ void BlocksetEditorFrame::SetGameData(std::shared_ptr<Landstalker::GameData> gd)
 void BlocksetEditorFrame::ClearGameData()
 {
 	m_gd = nullptr;
+	m_journal.Clear();
 }
 
 void BlocksetEditorFrame::SetActivePalette(const std::string& name)
@@ -138,6 +142,17 @@ void BlocksetEditorFrame::Redraw()
 	m_editor->RedrawTiles();
 }
 
+void BlocksetEditorFrame::RecolourPalette(const Landstalker::Palette* palette)
+{
+	if (m_palette == nullptr || (palette != nullptr && palette != m_palette->GetData().get()))
+	{
+		return;
+	}
+	// The tile atlas has already dropped the tiles decoded with the old colours
+	m_editor->RedrawTiles();
+	m_tileset->RecolourTiles();
+}
+
 void BlocksetEditorFrame::RedrawTiles(int index) const
 {
 	m_editor->RedrawTiles(index);
@@ -155,11 +170,12 @@ void BlocksetEditorFrame::InitMenu(wxMenuBar& menu, ImageList& ilist) const
 	AddMenuItem(fileMenu, 3, ID_FILE_IMPORT_CBS, "Import Blockset from Binary...");
 	AddMenuItem(fileMenu, 4, ID_FILE_IMPORT_CSV, "Import Blockset from CSV...");
 	auto& editMenu = AddMenu(menu, 1, ID_EDIT, "Edit");
-	AddMenuItem(editMenu, 0, ID_EDIT_CUT, "Cut");
-	AddMenuItem(editMenu, 1, ID_EDIT_COPY, "Copy");
-	AddMenuItem(editMenu, 2, ID_EDIT_PASTE, "Paste");
-	AddMenuItem(editMenu, 3, ID_EDIT_SWAP, "Swap");
-	AddMenuItem(editMenu, 4, ID_EDIT_CLEAR, "Clear");
+	AddUndoMenuItems(editMenu, 0);
+	AddMenuItem(editMenu, 3, ID_EDIT_CUT, "Cut");
+	AddMenuItem(editMenu, 4, ID_EDIT_COPY, "Copy");
+	AddMenuItem(editMenu, 5, ID_EDIT_PASTE, "Paste");
+	AddMenuItem(editMenu, 6, ID_EDIT_SWAP, "Swap");
+	AddMenuItem(editMenu, 7, ID_EDIT_CLEAR, "Clear");
 	auto& viewMenu = AddMenu(menu, 2, ID_VIEW, "View");
 	AddMenuItem(viewMenu, 0, ID_VIEW_TOGGLE_GRIDLINES, "Gridlines", wxITEM_CHECK);
 	AddMenuItem(viewMenu, 1, ID_VIEW_TOGGLE_TILE_NOS, "Tile Numbers", wxITEM_CHECK);
@@ -174,6 +190,7 @@ void BlocksetEditorFrame::InitMenu(wxMenuBar& menu, ImageList& ilist) const
 
 	wxAuiToolBar* toolbar = new wxAuiToolBar(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxAUI_TB_DEFAULT_STYLE | wxAUI_TB_HORIZONTAL);
 
+	AddUndoTools(*toolbar, "Blockset", ilist);
 	toolbar->AddTool(ID_TOGGLE_GRIDLINES, "Toggle Gridlines", ilist.GetImage("gridlines"), "Toggle Gridlines", wxITEM_CHECK);
 	toolbar->AddTool(ID_TOGGLE_TILE_NUMBERS, "Toggle Tile Numbers", ilist.GetImage("tile_nums"), "Toggle Tile Numbers", wxITEM_CHECK);
 	toolbar->AddTool(ID_TOGGLE_ALPHA, "Toggle Alpha", ilist.GetImage("alpha"), "Toggle Alpha", wxITEM_CHECK);
@@ -217,11 +234,16 @@ void BlocksetEditorFrame::InitMenu(wxMenuBar& menu, ImageList& ilist) const
 		m_palette_select->SetStringSelection(m_palette->GetName());
 	}
 	UpdateUI();
+	UpdateUndoUI();
 	m_mgr.Update();
 }
 
 void BlocksetEditorFrame::OnMenuClick(wxMenuEvent& evt)
 {
+	if (HandleUndoMenuClick(evt.GetId()))
+	{
+		return;
+	}
 	ProcessEvent(evt.GetId());
 	evt.Skip();
 }
@@ -292,6 +314,7 @@ void BlocksetEditorFrame::ImportBin(const std::string& filename)
 	Landstalker::ByteVector bytes = Landstalker::ReadBytes(filename);
 	m_blocks->GetData()->clear();
 	Landstalker::BlocksetCmp::Decode(bytes.data(), bytes.size(), *m_blocks->GetData());
+	BlockSummaryIndex::Invalidate(m_blocks->GetData().get());
 	m_editor->RedrawTiles();
 }
 
@@ -316,6 +339,7 @@ void BlocksetEditorFrame::ImportCsv(const std::string& filename)
 		blocks.push_back(Landstalker::MapBlock(tiles.cbegin(), tiles.cend()));
 	}
 	*m_blocks->GetData() = blocks;
+	BlockSummaryIndex::Invalidate(m_blocks->GetData().get());
 	m_editor->RedrawTiles();
 	UpdateUI();
 }
@@ -439,6 +463,13 @@ void BlocksetEditorFrame::OnBlockSelect(wxCommandEvent& evt)
 	evt.Skip();
 }
 
+void BlocksetEditorFrame::OnBlockChange(wxCommandEvent& evt)
+{
+	UpdateUI();
+	FireEvent(EVT_PROPERTIES_UPDATE);
+	evt.Skip();
+}
+
 void BlocksetEditorFrame::OnTileSelect(wxCommandEvent& evt)
 {
 	int tile_id = std::stoi(evt.GetString().ToStdString());
@@ -725,6 +756,7 @@ void BlocksetEditorFrame::ProcessEvent(int id)
 			}
 			else
 			{
+				StrokeGuard stroke(m_journal, "Swap Blocks");
 				auto temp = m_editor->GetBlock(m_blockswap);
 				m_editor->SetBlock(m_blockswap, m_editor->GetSelectedBlock());
 				m_editor->SetSelectedBlock(temp);
@@ -741,6 +773,7 @@ void BlocksetEditorFrame::ProcessEvent(int id)
 			}
 			else
 			{
+				StrokeGuard stroke(m_journal, "Swap Tiles");
 				auto temp = m_editor->GetTile(m_blockswap, m_tileswap);
 				m_editor->SetTile(m_blockswap, m_tileswap, m_editor->GetTile(b, t));
 				m_editor->SetTile(b, t, temp);
@@ -1134,6 +1167,7 @@ void BlocksetEditorFrame::OnImportBin()
 	{
 		std::string path = fd.GetPath().ToStdString();
 		ImportBin(path);
+		m_journal.Clear();
 	}
 	UpdateUI();
 	FireEvent(EVT_PROPERTIES_UPDATE);
@@ -1147,6 +1181,7 @@ void BlocksetEditorFrame::OnImportCsv()
 	{
 		std::string path = fd.GetPath().ToStdString();
 		ImportCsv(path);
+		m_journal.Clear();
 	}
 	UpdateUI();
 	FireEvent(EVT_PROPERTIES_UPDATE);
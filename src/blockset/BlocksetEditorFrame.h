@@ -22,6 +22,7 @@ public:
 	void Open(const std::string& blockset_name);
 	virtual void SetGameData(std::shared_ptr<Landstalker::GameData> gd);
 	virtual void ClearGameData();
+	virtual void RecolourPalette(const Landstalker::Palette* palette) override;
 
 	void SetActivePalette(const std::string& name);
 	void SetDrawTile(const Landstalker::Tile& tile);
@@ -44,6 +45,7 @@ private:
 	void OnButtonClicked(wxCommandEvent& evt);
 	void OnPaletteSelect(wxCommandEvent& evt);
 	void OnBlockSelect(wxCommandEvent& evt);
+	void OnBlockChange(wxCommandEvent& evt);
 	void OnTileSelect(wxCommandEvent& evt);
 	void OnKeyPress(wxKeyEvent& evt);
 	void ProcessEvent(int id);
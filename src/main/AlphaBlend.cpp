@@ -0,0 +1,272 @@
+#include <main/AlphaBlend.h>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ALPHA_BLEND_SSE2
+#endif
+#if defined(__SSSE3__) || defined(__AVX2__)
+#include <tmmintrin.h>
+#define ALPHA_BLEND_SSSE3
+#endif
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define ALPHA_BLEND_AVX2
+#endif
+
+namespace
+{
+	// Rounded x / 255 for x in [0, 65025]. The SIMD paths use the same arithmetic so
+	// that all implementations produce identical results.
+	inline uint8_t Div255(unsigned int x)
+	{
+		x += 128;
+		return static_cast<uint8_t>((x + (x >> 8)) >> 8);
+	}
+
+#ifdef ALPHA_BLEND_SSE2
+	inline __m128i Div255Epu16(__m128i x)
+	{
+		x = _mm_add_epi16(x, _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+	}
+
+	inline __m128i ScaleAlpha(__m128i alpha, __m128i opacity)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i lo = Div255Epu16(_mm_mullo_epi16(_mm_unpacklo_epi8(alpha, zero), opacity));
+		const __m128i hi = Div255Epu16(_mm_mullo_epi16(_mm_unpackhi_epi8(alpha, zero), opacity));
+		return _mm_packus_epi16(lo, hi);
+	}
+
+	// Blends 16 bytes of src over dst, each byte using the matching byte of alpha
+	inline __m128i BlendBytes(__m128i dst, __m128i src, __m128i alpha)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		const __m128i inv = _mm_xor_si128(alpha, _mm_set1_epi8(-1));
+		const __m128i lo = _mm_add_epi16(
+			_mm_mullo_epi16(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(alpha, zero)),
+			_mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), _mm_unpacklo_epi8(inv, zero)));
+		const __m128i hi = _mm_add_epi16(
+			_mm_mullo_epi16(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(alpha, zero)),
+			_mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), _mm_unpackhi_epi8(inv, zero)));
+		return _mm_packus_epi16(Div255Epu16(lo), Div255Epu16(hi));
+	}
+
+	// Expands 16 alpha values to one value per RGB byte
+	inline void ExpandAlpha(__m128i alpha, __m128i& a0, __m128i& a1, __m128i& a2)
+	{
+#ifdef ALPHA_BLEND_SSSE3
+		a0 = _mm_shuffle_epi8(alpha, _mm_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5));
+		a1 = _mm_shuffle_epi8(alpha, _mm_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10));
+		a2 = _mm_shuffle_epi8(alpha, _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15));
+#else
+		alignas(16) uint8_t in[16];
+		alignas(16) uint8_t out[48];
+		_mm_store_si128(reinterpret_cast<__m128i*>(in), alpha);
+		for (int i = 0; i < 48; ++i)
+		{
+			out[i] = in[i / 3];
+		}
+		a0 = _mm_load_si128(reinterpret_cast<const __m128i*>(out));
+		a1 = _mm_load_si128(reinterpret_cast<const __m128i*>(out + 16));
+		a2 = _mm_load_si128(reinterpret_cast<const __m128i*>(out + 32));
+#endif
+	}
+#endif
+}
+
+void AlphaBlend::ClampAlpha(uint8_t* alpha, std::size_t count, uint8_t opacity)
+{
+	std::size_t i = 0;
+#if defined(ALPHA_BLEND_AVX2)
+	const __m256i op = _mm256_set1_epi8(static_cast<char>(opacity));
+	for (; i + 32 <= count; i += 32)
+	{
+		__m256i* p = reinterpret_cast<__m256i*>(alpha + i);
+		_mm256_storeu_si256(p, _mm256_min_epu8(_mm256_loadu_si256(p), op));
+	}
+#elif defined(ALPHA_BLEND_SSE2)
+	const __m128i op = _mm_set1_epi8(static_cast<char>(opacity));
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i* p = reinterpret_cast<__m128i*>(alpha + i);
+		_mm_storeu_si128(p, _mm_min_epu8(_mm_loadu_si128(p), op));
+	}
+#endif
+	ClampAlphaScalar(alpha + i, count - i, opacity);
+}
+
+void AlphaBlend::ClampAlpha(uint8_t* alpha, const uint8_t* priority_alpha, std::size_t count, uint8_t opacity)
+{
+	std::size_t i = 0;
+#if defined(ALPHA_BLEND_AVX2)
+	const __m256i op = _mm256_set1_epi8(static_cast<char>(opacity));
+	for (; i + 32 <= count; i += 32)
+	{
+		__m256i* p = reinterpret_cast<__m256i*>(alpha + i);
+		const __m256i pri = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(priority_alpha + i));
+		_mm256_storeu_si256(p, _mm256_max_epu8(pri, _mm256_min_epu8(_mm256_loadu_si256(p), op)));
+	}
+#elif defined(ALPHA_BLEND_SSE2)
+	const __m128i op = _mm_set1_epi8(static_cast<char>(opacity));
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i* p = reinterpret_cast<__m128i*>(alpha + i);
+		const __m128i pri = _mm_loadu_si128(reinterpret_cast<const __m128i*>(priority_alpha + i));
+		_mm_storeu_si128(p, _mm_max_epu8(pri, _mm_min_epu8(_mm_loadu_si128(p), op)));
+	}
+#endif
+	ClampAlphaScalar(alpha + i, priority_alpha + i, count - i, opacity);
+}
+
+void AlphaBlend::BlendOver(uint8_t* dst_rgb, const uint8_t* src_rgb, const uint8_t* src_alpha, std::size_t count, uint8_t opacity)
+{
+	std::size_t i = 0;
+#ifdef ALPHA_BLEND_SSE2
+	const __m128i op = _mm_set1_epi16(opacity);
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_alpha + i));
+		if (opacity != 0xFF)
+		{
+			a = ScaleAlpha(a, op);
+		}
+		const int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(a, _mm_setzero_si128()));
+		if (mask == 0xFFFF)
+		{
+			// Fully transparent run - destination is unchanged
+			continue;
+		}
+		__m128i a0, a1, a2;
+		ExpandAlpha(a, a0, a1, a2);
+		__m128i* d = reinterpret_cast<__m128i*>(dst_rgb + i * 3);
+		const __m128i* s = reinterpret_cast<const __m128i*>(src_rgb + i * 3);
+		_mm_storeu_si128(d, BlendBytes(_mm_loadu_si128(d), _mm_loadu_si128(s), a0));
+		_mm_storeu_si128(d + 1, BlendBytes(_mm_loadu_si128(d + 1), _mm_loadu_si128(s + 1), a1));
+		_mm_storeu_si128(d + 2, BlendBytes(_mm_loadu_si128(d + 2), _mm_loadu_si128(s + 2), a2));
+	}
+#endif
+	BlendOverScalar(dst_rgb + i * 3, src_rgb + i * 3, src_alpha + i, count - i, opacity);
+}
+
+void AlphaBlend::BlendOver(wxImage& dst, const wxImage& src, uint8_t opacity)
+{
+	wxASSERT(dst.GetWidth() == src.GetWidth() && dst.GetHeight() == src.GetHeight());
+	const std::size_t count = static_cast<std::size_t>(dst.GetWidth()) * dst.GetHeight();
+	if (src.HasAlpha())
+	{
+		BlendOver(dst.GetData(), src.GetData(), src.GetAlpha(), count, opacity);
+	}
+	else if (opacity == 0xFF)
+	{
+		std::memcpy(dst.GetData(), src.GetData(), count * 3);
+	}
+	else
+	{
+		std::vector<uint8_t> alpha(count, 0xFF);
+		BlendOver(dst.GetData(), src.GetData(), alpha.data(), count, opacity);
+	}
+}
+
+void AlphaBlend::BlendOverAlpha(uint8_t* dst_rgb, uint8_t* dst_alpha, const uint8_t* src_rgb, const uint8_t* src_alpha, std::size_t count)
+{
+	std::size_t i = 0;
+#ifdef ALPHA_BLEND_SSE2
+	// Sprite sources are mostly fully transparent or fully opaque. Handle those runs
+	// directly and leave the partially covered runs to the scalar path.
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ones = _mm_set1_epi8(-1);
+	for (; i + 16 <= count; i += 16)
+	{
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src_alpha + i));
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, zero)) == 0xFFFF)
+		{
+			continue;
+		}
+		if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, ones)) == 0xFFFF)
+		{
+			std::memcpy(dst_rgb + i * 3, src_rgb + i * 3, 48);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst_alpha + i), a);
+			continue;
+		}
+		BlendOverAlphaScalar(dst_rgb + i * 3, dst_alpha + i, src_rgb + i * 3, src_alpha + i, 16);
+	}
+#endif
+	BlendOverAlphaScalar(dst_rgb + i * 3, dst_alpha + i, src_rgb + i * 3, src_alpha + i, count - i);
+}
+
+void AlphaBlend::ClampAlphaScalar(uint8_t* alpha, std::size_t count, uint8_t opacity)
+{
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		alpha[i] = std::min(alpha[i], opacity);
+	}
+}
+
+void AlphaBlend::ClampAlphaScalar(uint8_t* alpha, const uint8_t* priority_alpha, std::size_t count, uint8_t opacity)
+{
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		alpha[i] = std::max(priority_alpha[i], std::min(alpha[i], opacity));
+	}
+}
+
+void AlphaBlend::BlendOverScalar(uint8_t* dst_rgb, const uint8_t* src_rgb, const uint8_t* src_alpha, std::size_t count, uint8_t opacity)
+{
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const unsigned int a = (opacity == 0xFF) ? src_alpha[i] : Div255(src_alpha[i] * opacity);
+		if (a == 0)
+		{
+			continue;
+		}
+		uint8_t* d = dst_rgb + i * 3;
+		const uint8_t* s = src_rgb + i * 3;
+		if (a == 0xFF)
+		{
+			d[0] = s[0];
+			d[1] = s[1];
+			d[2] = s[2];
+		}
+		else
+		{
+			d[0] = Div255(s[0] * a + d[0] * (0xFF - a));
+			d[1] = Div255(s[1] * a + d[1] * (0xFF - a));
+			d[2] = Div255(s[2] * a + d[2] * (0xFF - a));
+		}
+	}
+}
+
+void AlphaBlend::BlendOverAlphaScalar(uint8_t* dst_rgb, uint8_t* dst_alpha, const uint8_t* src_rgb, const uint8_t* src_alpha, std::size_t count)
+{
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const unsigned int sa = src_alpha[i];
+		if (sa == 0)
+		{
+			continue;
+		}
+		uint8_t* d = dst_rgb + i * 3;
+		const uint8_t* s = src_rgb + i * 3;
+		if (sa == 0xFF || dst_alpha[i] == 0)
+		{
+			d[0] = s[0];
+			d[1] = s[1];
+			d[2] = s[2];
+			dst_alpha[i] = static_cast<uint8_t>(sa);
+			continue;
+		}
+		// Both weights and the resulting alpha are scaled by 255
+		const unsigned int sw = sa * 0xFF;
+		const unsigned int dw = dst_alpha[i] * (0xFF - sa);
+		const unsigned int out = sw + dw;
+		d[0] = static_cast<uint8_t>((s[0] * sw + d[0] * dw + out / 2) / out);
+		d[1] = static_cast<uint8_t>((s[1] * sw + d[1] * dw + out / 2) / out);
+		d[2] = static_cast<uint8_t>((s[2] * sw + d[2] * dw + out / 2) / out);
+		dst_alpha[i] = Div255(out);
+	}
+}
@@ -0,0 +1,29 @@
+#ifndef _ALPHA_BLEND_H_
+#define _ALPHA_BLEND_H_
+
+#include <wx/image.h>
+#include <cstdint>
+#include <cstddef>
+
+class AlphaBlend
+{
+public:
+	// Limits every alpha value to at most opacity
+	static void ClampAlpha(uint8_t* alpha, std::size_t count, uint8_t opacity);
+	// As above, but pixels set in priority_alpha keep their priority alpha value
+	static void ClampAlpha(uint8_t* alpha, const uint8_t* priority_alpha, std::size_t count, uint8_t opacity);
+	// Blends straight-alpha RGB source pixels over an opaque RGB destination. Source alpha is
+	// scaled by opacity and premultiplied on the fly.
+	static void BlendOver(uint8_t* dst_rgb, const uint8_t* src_rgb, const uint8_t* src_alpha, std::size_t count, uint8_t opacity = 0xFF);
+	// Blends an image of the same size over dst. Sources without alpha are treated as opaque.
+	static void BlendOver(wxImage& dst, const wxImage& src, uint8_t opacity = 0xFF);
+	// Blends straight-alpha RGB source pixels over a destination that has its own alpha channel
+	static void BlendOverAlpha(uint8_t* dst_rgb, uint8_t* dst_alpha, const uint8_t* src_rgb, const uint8_t* src_alpha, std::size_t count);
+
+	static void ClampAlphaScalar(uint8_t* alpha, std::size_t count, uint8_t opacity);
+	static void ClampAlphaScalar(uint8_t* alpha, const uint8_t* priority_alpha, std::size_t count, uint8_t opacity);
+	static void BlendOverScalar(uint8_t* dst_rgb, const uint8_t* src_rgb, const uint8_t* src_alpha, std::size_t count, uint8_t opacity = 0xFF);
+	static void BlendOverAlphaScalar(uint8_t* dst_rgb, uint8_t* dst_alpha, const uint8_t* src_rgb, const uint8_t* src_alpha, std::size_t count);
+};
+
+#endif // _ALPHA_BLEND_H_
@@ -23,6 +23,7 @@ EditorFrame::EditorFrame(wxWindow* parent, wxWindowID id, ImageList* imglst)
 	  m_props_init(false)
 {
 	this->Connect(wxEVT_AUI_PANE_CLOSE, wxAuiManagerEventHandler(EditorFrame::OnPaneClose), nullptr, this);
+	m_journal.SetChangeHandler([this]() { UpdateUndoUI(); });
 }
 
 EditorFrame::~EditorFrame()
@@ -106,6 +107,7 @@ void EditorFrame::ClearMenu(wxMenuBar& /*menu*/) const
 		tb.second->Destroy();
 	}
 	m_toolbars.clear();
+	m_undo_toolbar.clear();
 	for(auto* mgr : mgrs)
 	{
 		mgr->Update();
@@ -355,6 +357,69 @@ ImageList* EditorFrame::GetImageList()
 	return m_imglst;
 }
 
+UndoJournal& EditorFrame::GetUndoJournal()
+{
+	return m_journal;
+}
+
+void EditorFrame::AddUndoMenuItems(wxMenu& parent, int position) const
+{
+	AddMenuItem(parent, position, wxID_UNDO, "Undo\tCtrl+Z");
+	AddMenuItem(parent, position + 1, wxID_REDO, "Redo\tCtrl+Y");
+	AddMenuItem(parent, position + 2, wxID_SEPARATOR, "", wxITEM_SEPARATOR);
+}
+
+void EditorFrame::AddUndoTools(wxAuiToolBar& tb, const std::string& toolbar, ImageList& ilist) const
+{
+	tb.AddTool(wxID_UNDO, "Undo", ilist.GetImage("undo"), "Undo");
+	tb.AddTool(wxID_REDO, "Redo", ilist.GetImage("redo"), "Redo");
+	tb.AddSeparator();
+	m_undo_toolbar = toolbar;
+}
+
+bool EditorFrame::HandleUndoMenuClick(int id)
+{
+	switch (id)
+	{
+	case wxID_UNDO:
+		m_journal.Undo();
+		return true;
+	case wxID_REDO:
+		m_journal.Redo();
+		return true;
+	default:
+		return false;
+	}
+}
+
+void EditorFrame::UpdateUndoUI() const
+{
+	// Menu items are shared between editors, so only the visible editor may touch them
+	if (!IsShown())
+	{
+		return;
+	}
+	auto* undo = GetMenuItem(wxID_UNDO);
+	if (undo != nullptr)
+	{
+		const std::string desc = m_journal.GetUndoDescription();
+		undo->SetItemLabel(desc.empty() ? "Undo\tCtrl+Z" : "Undo " + desc + "\tCtrl+Z");
+		undo->Enable(m_journal.CanUndo());
+	}
+	auto* redo = GetMenuItem(wxID_REDO);
+	if (redo != nullptr)
+	{
+		const std::string desc = m_journal.GetRedoDescription();
+		redo->SetItemLabel(desc.empty() ? "Redo\tCtrl+Y" : "Redo " + desc + "\tCtrl+Y");
+		redo->Enable(m_journal.CanRedo());
+	}
+	if (!m_undo_toolbar.empty())
+	{
+		EnableToolbarItem(m_undo_toolbar, wxID_UNDO, m_journal.CanUndo());
+		EnableToolbarItem(m_undo_toolbar, wxID_REDO, m_journal.CanRedo());
+	}
+}
+
 void EditorFrame::OnPaneClose(wxAuiManagerEvent& event)
 {
 	auto* pane = event.GetPane();
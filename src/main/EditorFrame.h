@@ -9,6 +9,7 @@
 #include <unordered_map>
 
 #include <main/ImageList.h>
+#include <main/UndoJournal.h>
 #include <landstalker/main/GameData.h>
 
 class EditorFrame : public wxWindow
@@ -30,7 +31,11 @@ public:
 	virtual void UpdateUI() const;
 	virtual void SetGameData(std::shared_ptr<Landstalker::GameData> gd) { m_gd = gd; }
 	virtual void ClearGameData() { m_gd = nullptr; }
+	// Called after a palette's colours were edited (or any palette, if null). The indexed
+	// pixels are unchanged, so editors only need to convert them again.
+	virtual void RecolourPalette(const Landstalker::Palette* /*palette*/) {}
 	virtual void SetImageList(ImageList* imglst);
+	UndoJournal& GetUndoJournal();
 protected:
 	void CheckMenuItem(int id, bool checked) const;
 	void CheckToolbarItem(const std::string& name, int id, bool checked) const;
@@ -52,11 +57,16 @@ protected:
 	wxMenuItem* GetMenuItem(int id) const;
 	wxAuiToolBar* GetToolbar(const std::string name) const;
 	ImageList* GetImageList();
+	void AddUndoMenuItems(wxMenu& parent, int position) const;
+	void AddUndoTools(wxAuiToolBar& tb, const std::string& toolbar, ImageList& ilist) const;
+	bool HandleUndoMenuClick(int id);
+	void UpdateUndoUI() const;
 
 	void OnPaneClose(wxAuiManagerEvent& event);
 
 	std::shared_ptr<Landstalker::GameData> m_gd;
 	ImageList* m_imglst;
+	UndoJournal m_journal;
 
 private:
 	mutable bool m_props_init;
@@ -64,6 +74,7 @@ private:
 	static std::unordered_map<int, std::pair<wxMenuBar*, wxMenu*>> m_menus;
 	static std::unordered_map<int, std::pair<wxMenu*, wxMenuItem*>> m_menuitems;
 	mutable std::unordered_map<std::string, wxAuiToolBar*> m_toolbars;
+	mutable std::string m_undo_toolbar;
 
 };
 
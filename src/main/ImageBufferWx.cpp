@@ -1,5 +1,7 @@
 #include <main/ImageBufferWx.h>
 
+#include <wx/rawbmp.h>
+
 std::shared_ptr<wxBitmap> ImageBufferWx::MakeBitmap(const std::vector<std::shared_ptr<Landstalker::Palette>>& pals, bool use_alpha, uint8_t low_pri_max_opacity, uint8_t high_pri_max_opacity) const
 {
     wxImage img = MakeImage(pals, use_alpha, low_pri_max_opacity, high_pri_max_opacity);
@@ -8,11 +10,127 @@ std::shared_ptr<wxBitmap> ImageBufferWx::MakeBitmap(const std::vector<std::share
 
 wxImage ImageBufferWx::MakeImage(const std::vector<std::shared_ptr<Landstalker::Palette>>& pals, bool use_alpha, uint8_t low_pri_max_opacity, uint8_t high_pri_max_opacity) const
 {
-    GetRGB(pals);
-    wxImage img(GetWidth(), GetHeight(), const_cast<uint8_t*>(GetRGB(pals).data()), true);
+    // Redraws frequently convert a buffer that has not changed since the last call, so
+    // the previous conversion is reused unless the pixels or palette colours differ
+    const auto palette_key = MakePaletteKey(pals);
+    if (!m_memo.rgb_valid || m_memo.rgb_version != m_version || m_memo.rgb_palette != palette_key)
+    {
+        const auto& rgb = GetRGB(pals);
+        m_memo.rgb.assign(rgb.cbegin(), rgb.cend());
+        m_memo.rgb_valid = true;
+        m_memo.rgb_version = m_version;
+        m_memo.rgb_palette = palette_key;
+    }
+    wxImage img(GetWidth(), GetHeight(), m_memo.rgb.data(), true);
     if (use_alpha)
     {
-        img.SetAlpha(const_cast<uint8_t*>(GetAlpha(pals, low_pri_max_opacity, high_pri_max_opacity).data()), true);
+        if (!m_memo.alpha_valid || m_memo.alpha_version != m_version || m_memo.alpha_palette != palette_key
+            || m_memo.alpha_opacity[0] != low_pri_max_opacity || m_memo.alpha_opacity[1] != high_pri_max_opacity)
+        {
+            const auto& alpha = GetAlpha(pals, low_pri_max_opacity, high_pri_max_opacity);
+            m_memo.alpha.assign(alpha.cbegin(), alpha.cend());
+            m_memo.alpha_valid = true;
+            m_memo.alpha_version = m_version;
+            m_memo.alpha_palette = palette_key;
+            m_memo.alpha_opacity[0] = low_pri_max_opacity;
+            m_memo.alpha_opacity[1] = high_pri_max_opacity;
+        }
+        img.SetAlpha(m_memo.alpha.data(), true);
     }
     return img;
-}
\ No newline at end of file
+}
+
+std::size_t ImageBufferWx::GetMemoSize() const
+{
+    return m_memo.rgb.capacity() + m_memo.alpha.capacity()
+        + (m_memo.rgb_palette.capacity() + m_memo.alpha_palette.capacity()) * sizeof(uint32_t);
+}
+
+std::vector<uint32_t> ImageBufferWx::MakePaletteKey(const std::vector<std::shared_ptr<Landstalker::Palette>>& pals)
+{
+    std::vector<uint32_t> key;
+    key.reserve(pals.size() * 16);
+    for (const auto& pal : pals)
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            key.push_back(pal != nullptr ? pal->getBGRA(i) : 0);
+        }
+    }
+    return key;
+}
+
+bool ImageBufferWx::UpdateBitmap(wxBitmap& bmp, const wxPoint& dest, const std::vector<std::shared_ptr<Landstalker::Palette>>& pals, bool use_alpha, uint8_t low_pri_max_opacity, uint8_t high_pri_max_opacity) const
+{
+    return UpdateBitmap(bmp, dest, MakeImage(pals, use_alpha, low_pri_max_opacity, high_pri_max_opacity));
+}
+
+bool ImageBufferWx::UpdateBitmap(wxBitmap& bmp, const wxPoint& dest, const wxImage& img)
+{
+    if (!bmp.IsOk() || !img.IsOk())
+    {
+        return false;
+    }
+    const wxRect rect = wxRect(dest, img.GetSize()).Intersect(wxRect(bmp.GetSize()));
+    if (rect.IsEmpty())
+    {
+        return false;
+    }
+    const int src_x = rect.x - dest.x;
+    const int src_y = rect.y - dest.y;
+    const uint8_t* rgb = img.GetData();
+    const uint8_t* alpha = img.HasAlpha() ? img.GetAlpha() : nullptr;
+    if (bmp.HasAlpha())
+    {
+        wxAlphaPixelData data(bmp, rect.GetPosition(), rect.GetSize());
+        if (!data)
+        {
+            return false;
+        }
+        wxAlphaPixelData::Iterator row(data);
+        for (int y = 0; y < rect.height; ++y)
+        {
+            wxAlphaPixelData::Iterator px = row;
+            const std::size_t offset = static_cast<std::size_t>(src_y + y) * img.GetWidth() + src_x;
+            const uint8_t* src = rgb + offset * 3;
+            for (int x = 0; x < rect.width; ++x, ++px, src += 3)
+            {
+                const uint8_t a = alpha != nullptr ? alpha[offset + x] : 0xFF;
+#if defined(__WXMSW__) || defined(__WXOSX__)
+                // Native bitmaps on these platforms hold premultiplied alpha
+                px.Red() = static_cast<uint8_t>(src[0] * a / 0xFF);
+                px.Green() = static_cast<uint8_t>(src[1] * a / 0xFF);
+                px.Blue() = static_cast<uint8_t>(src[2] * a / 0xFF);
+#else
+                px.Red() = src[0];
+                px.Green() = src[1];
+                px.Blue() = src[2];
+#endif
+                px.Alpha() = a;
+            }
+            row.OffsetY(data, 1);
+        }
+    }
+    else
+    {
+        wxNativePixelData data(bmp, rect.GetPosition(), rect.GetSize());
+        if (!data)
+        {
+            return false;
+        }
+        wxNativePixelData::Iterator row(data);
+        for (int y = 0; y < rect.height; ++y)
+        {
+            wxNativePixelData::Iterator px = row;
+            const uint8_t* src = rgb + (static_cast<std::size_t>(src_y + y) * img.GetWidth() + src_x) * 3;
+            for (int x = 0; x < rect.width; ++x, ++px, src += 3)
+            {
+                px.Red() = src[0];
+                px.Green() = src[1];
+                px.Blue() = src[2];
+            }
+            row.OffsetY(data, 1);
+        }
+    }
+    return true;
+}
@@ -3,6 +3,10 @@
 
 #include <landstalker/main/ImageBuffer.h>
 #include <wx/wx.h>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 class ImageBufferWx : public Landstalker::ImageBuffer
 {
@@ -11,10 +15,54 @@ public:
 	ImageBufferWx(int width, int height) : Landstalker::ImageBuffer(width, height) {}
 	virtual ~ImageBufferWx() = default;
 	const ImageBuffer& Get() const { return *this; }
-	ImageBuffer& Get() { return *this; }
+	ImageBuffer& Get() { Touch(); return *this; }
+
+	// Writes to the buffer go through these so that the version is bumped, which tells
+	// MakeImage when its previous conversion can be reused
+	template <typename... Args> decltype(auto) Clear(Args&&... args) { Touch(); return ImageBuffer::Clear(std::forward<Args>(args)...); }
+	template <typename... Args> decltype(auto) Resize(Args&&... args) { Touch(); return ImageBuffer::Resize(std::forward<Args>(args)...); }
+	template <typename... Args> decltype(auto) InsertTile(Args&&... args) { Touch(); return ImageBuffer::InsertTile(std::forward<Args>(args)...); }
+	template <typename... Args> decltype(auto) InsertBlock(Args&&... args) { Touch(); return ImageBuffer::InsertBlock(std::forward<Args>(args)...); }
+	template <typename... Args> decltype(auto) InsertMap(Args&&... args) { Touch(); return ImageBuffer::InsertMap(std::forward<Args>(args)...); }
+	template <typename... Args> decltype(auto) Insert3DMapLayer(Args&&... args) { Touch(); return ImageBuffer::Insert3DMapLayer(std::forward<Args>(args)...); }
+	template <typename... Args> decltype(auto) InsertSprite(Args&&... args) { Touch(); return ImageBuffer::InsertSprite(std::forward<Args>(args)...); }
+	uint64_t GetVersion() const { return m_version; }
+	// Bytes held by the memoised RGB and alpha conversions, on top of the base class's storage
+	std::size_t GetMemoSize() const;
 
 	std::shared_ptr<wxBitmap> MakeBitmap(const std::vector<std::shared_ptr<Landstalker::Palette>>& pals, bool use_alpha = false, uint8_t low_pri_max_opacity = 0xFF, uint8_t high_pri_max_opacity = 0xFF) const;
 	wxImage MakeImage(const std::vector<std::shared_ptr<Landstalker::Palette>>& pals, bool use_alpha = false, uint8_t low_pri_max_opacity = 0xFF, uint8_t high_pri_max_opacity = 0xFF) const;
+	// Converts this buffer and writes it over the region of an existing bitmap starting at dest,
+	// so that a small buffer (e.g. one tile) can refresh part of a large bitmap in place.
+	bool UpdateBitmap(wxBitmap& bmp, const wxPoint& dest, const std::vector<std::shared_ptr<Landstalker::Palette>>& pals, bool use_alpha = false, uint8_t low_pri_max_opacity = 0xFF, uint8_t high_pri_max_opacity = 0xFF) const;
+	static bool UpdateBitmap(wxBitmap& bmp, const wxPoint& dest, const wxImage& img);
+private:
+	// The last RGB and alpha conversions, valid while the buffer version and palette colours
+	// are unchanged. The planes are copied out of the base class, whose conversion storage is
+	// overwritten by any later GetRGB or GetAlpha call. A copied buffer starts with an empty memo.
+	struct Memo
+	{
+		Memo() = default;
+		Memo(const Memo&) {}
+		Memo& operator=(const Memo&) { Reset(); return *this; }
+		void Reset() { rgb_valid = false; alpha_valid = false; }
+
+		std::vector<uint8_t> rgb;
+		bool rgb_valid = false;
+		uint64_t rgb_version = 0;
+		std::vector<uint32_t> rgb_palette;
+		std::vector<uint8_t> alpha;
+		bool alpha_valid = false;
+		uint64_t alpha_version = 0;
+		std::vector<uint32_t> alpha_palette;
+		uint8_t alpha_opacity[2] = { 0, 0 };
+	};
+
+	void Touch() { ++m_version; }
+	static std::vector<uint32_t> MakePaletteKey(const std::vector<std::shared_ptr<Landstalker::Palette>>& pals);
+
+	uint64_t m_version = 0;
+	mutable Memo m_memo;
 };
 
-#endif // _IMAGE_BUFFER_WX_H_
\ No newline at end of file
+#endif // _IMAGE_BUFFER_WX_H_
@@ -25,6 +25,8 @@
 #include <landstalker/main/Rom.h>
 #include <landstalker/2d_maps/Blockmap2D.h>
 #include <main/ImageBufferWx.h>
+#include <main/TileAtlas.h>
+#include <palettes/PaletteEditor.h>
 #include <misc/AssemblyBuilderDialog.h>
 #include <misc/PreferencesDialog.h>
 
@@ -86,6 +88,7 @@ MainFrame::MainFrame(wxWindow* parent, const std::string& filename)
     this->Connect(EVT_RENAME_NAV_ITEM, wxCommandEventHandler(MainFrame::OnRenameNavItem), nullptr, this);
     this->Connect(EVT_DELETE_NAV_ITEM, wxCommandEventHandler(MainFrame::OnDeleteNavItem), nullptr, this);
     this->Connect(EVT_ADD_NAV_ITEM, wxCommandEventHandler(MainFrame::OnAddNavItem), nullptr, this);
+    this->Connect(EVT_PALETTE_CHANGE, wxCommandEventHandler(MainFrame::OnPaletteChange), nullptr, this);
 }
 
 MainFrame::~MainFrame()
@@ -443,6 +446,12 @@ void MainFrame::InitUI()
 void MainFrame::InitConfig()
 {
     AssemblyBuilderDialog::InitConfig(m_config);
+    // Memory available to each editor's undo history, in kilobytes
+    const long undo_kb = m_config->ReadLong("/undo/max_kb", UndoJournal::DEFAULT_MAX_BYTES / 1024);
+    for (const auto& editor : m_editors)
+    {
+        editor.second->GetUndoJournal().SetMaxBytes(static_cast<std::size_t>(std::max(undo_kb, 0L)) * 1024);
+    }
 }
 
 MainFrame::ReturnCode MainFrame::Save()
@@ -698,6 +707,24 @@ void MainFrame::OnAddNavItem(wxCommandEvent& event)
     AddNavItem(event.GetString().ToStdWstring(), event.GetExtraLong(), static_cast<TreeNodeData::Node>(event.GetId()), event.GetInt(), false);
 }
 
+void MainFrame::OnPaletteChange(wxCommandEvent& event)
+{
+    // The client data identifies the edited palette, or is null if any palette may have changed
+    const auto* palette = static_cast<const Landstalker::Palette*>(event.GetClientData());
+    if (palette != nullptr)
+    {
+        TileAtlas::InvalidatePalette(palette);
+    }
+    else
+    {
+        TileAtlas::Clear();
+    }
+    for (const auto& editor : m_editors)
+    {
+        editor.second->RecolourPalette(palette);
+    }
+}
+
 std::optional<wxTreeItemId> MainFrame::FindNavItem(const std::wstring& path)
 {
     std::wistringstream ss(path);
@@ -121,6 +121,7 @@ private:
     void OnRenameNavItem(wxCommandEvent& event);
     void OnDeleteNavItem(wxCommandEvent& event);
     void OnAddNavItem(wxCommandEvent& event);
+    void OnPaletteChange(wxCommandEvent& event);
     std::optional<wxTreeItemId> FindNavItem(const std::wstring& path);
     std::optional<wxTreeItemId> InsertNavItem(const std::wstring& path, int img = -1, const TreeNodeData::Node& type = TreeNodeData::Node::BASE, int value = 0, bool no_delete = true);
     void SortNavItems(const wxTreeItemId& parent);
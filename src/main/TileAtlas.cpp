@@ -0,0 +1,156 @@
+#include <main/TileAtlas.h>
+
+#include <iterator>
+
+std::map<TileAtlas::PageKey, TileAtlas::Page> TileAtlas::s_pages;
+std::list<TileAtlas::Entry> TileAtlas::s_lru;
+std::size_t TileAtlas::s_bytes = 0;
+std::size_t TileAtlas::s_max_bytes = TileAtlas::DEFAULT_MAX_BYTES;
+
+namespace
+{
+	// Compares ownership rather than addresses, so that an object allocated where a
+	// destroyed one used to be is not mistaken for it
+	template <class T>
+	bool IsSameObject(const std::weak_ptr<T>& lhs, const std::shared_ptr<T>& rhs)
+	{
+		return !lhs.owner_before(rhs) && !rhs.owner_before(lhs);
+	}
+}
+
+const std::vector<uint32_t>& TileAtlas::GetTile(const std::shared_ptr<Landstalker::Tileset>& tileset,
+	const std::shared_ptr<Landstalker::Palette>& palette, const Landstalker::Tile& tile)
+{
+	auto page_it = s_pages.find({ tileset.get(), palette.get() });
+	if (page_it != s_pages.end() && (!IsSameObject(page_it->second.tileset, tileset) || !IsSameObject(page_it->second.palette, palette)))
+	{
+		ErasePage(page_it);
+		page_it = s_pages.end();
+	}
+	if (page_it == s_pages.end())
+	{
+		for (auto it = s_pages.begin(); it != s_pages.end();)
+		{
+			if (it->second.tileset.expired() || it->second.palette.expired())
+			{
+				ErasePage(it++);
+			}
+			else
+			{
+				++it;
+			}
+		}
+		page_it = s_pages.emplace(PageKey{ tileset.get(), palette.get() }, Page{ tileset, palette, {} }).first;
+	}
+	Page& page = page_it->second;
+	const int key = GetKey(tile);
+	auto tile_it = page.tiles.find(key);
+	if (tile_it != page.tiles.end())
+	{
+		s_lru.splice(s_lru.begin(), s_lru, tile_it->second);
+		return tile_it->second->pixels;
+	}
+	s_lru.push_front(Entry{ &page, key, tileset->GetTileBGRA(tile, *palette) });
+	page.tiles.emplace(key, s_lru.begin());
+	s_bytes += GetEntrySize(s_lru.front());
+	Evict();
+	return s_lru.front().pixels;
+}
+
+void TileAtlas::InvalidateTile(const Landstalker::Tileset* tileset, int tile)
+{
+	for (auto it = s_pages.lower_bound({ tileset, nullptr }); it != s_pages.end() && it->first.first == tileset; ++it)
+	{
+		// Each flip combination is decoded separately
+		for (int flip = 0; flip < 4; ++flip)
+		{
+			auto tile_it = it->second.tiles.find(tile * 4 + flip);
+			if (tile_it != it->second.tiles.end())
+			{
+				EraseEntry(tile_it->second);
+			}
+		}
+	}
+}
+
+void TileAtlas::InvalidateTileset(const Landstalker::Tileset* tileset)
+{
+	auto it = s_pages.lower_bound({ tileset, nullptr });
+	while (it != s_pages.end() && it->first.first == tileset)
+	{
+		ErasePage(it++);
+	}
+}
+
+void TileAtlas::InvalidatePalette(const Landstalker::Palette* palette)
+{
+	for (auto it = s_pages.begin(); it != s_pages.end();)
+	{
+		if (it->first.second == palette)
+		{
+			ErasePage(it++);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void TileAtlas::Clear()
+{
+	s_pages.clear();
+	s_lru.clear();
+	s_bytes = 0;
+}
+
+void TileAtlas::SetMaxBytes(std::size_t max_bytes)
+{
+	s_max_bytes = max_bytes;
+	Evict();
+}
+
+std::size_t TileAtlas::GetBytes()
+{
+	return s_bytes;
+}
+
+int TileAtlas::GetKey(const Landstalker::Tile& tile)
+{
+	const auto& attrs = tile.Attributes();
+	return tile.GetIndex() * 4 +
+		(attrs.getAttribute(Landstalker::TileAttributes::Attribute::ATTR_HFLIP) ? 1 : 0) +
+		(attrs.getAttribute(Landstalker::TileAttributes::Attribute::ATTR_VFLIP) ? 2 : 0);
+}
+
+std::size_t TileAtlas::GetEntrySize(const Entry& entry)
+{
+	// Approximate cost of the list and hash nodes on top of the pixels
+	return sizeof(Entry) + entry.pixels.size() * sizeof(uint32_t) + 8 * sizeof(void*);
+}
+
+void TileAtlas::ErasePage(std::map<PageKey, Page>::iterator it)
+{
+	for (const auto& tile : it->second.tiles)
+	{
+		s_bytes -= GetEntrySize(*tile.second);
+		s_lru.erase(tile.second);
+	}
+	s_pages.erase(it);
+}
+
+void TileAtlas::EraseEntry(std::list<Entry>::iterator it)
+{
+	s_bytes -= GetEntrySize(*it);
+	it->page->tiles.erase(it->key);
+	s_lru.erase(it);
+}
+
+void TileAtlas::Evict()
+{
+	// Always keep the most recently used tile, which the caller is about to draw
+	while (s_bytes > s_max_bytes && s_lru.size() > 1)
+	{
+		EraseEntry(std::prev(s_lru.end()));
+	}
+}
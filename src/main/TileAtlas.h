@@ -0,0 +1,68 @@
+#ifndef _TILE_ATLAS_H_
+#define _TILE_ATLAS_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <landstalker/tileset/Tileset.h>
+#include <landstalker/palettes/Palette.h>
+
+// Decoded tiles shared by every editor that draws tiles, keyed by tileset, palette, tile
+// index and flip flags. Editors looking at the same tileset and palette decode each tile
+// once between them. The least recently used tiles are discarded once the atlas holds
+// more than its memory limit. Only to be used from the UI thread.
+class TileAtlas
+{
+public:
+	// Returns the tile's pixels as 0xAABBGGRR words, as Tileset::GetTileBGRA would. The
+	// reference stays valid until the next call into the atlas.
+	static const std::vector<uint32_t>& GetTile(const std::shared_ptr<Landstalker::Tileset>& tileset,
+		const std::shared_ptr<Landstalker::Palette>& palette, const Landstalker::Tile& tile);
+
+	// Discards decoded copies of one tile after its pixels were edited
+	static void InvalidateTile(const Landstalker::Tileset* tileset, int tile);
+	// Discards every tile of a tileset, e.g. after tiles were inserted, deleted or imported
+	static void InvalidateTileset(const Landstalker::Tileset* tileset);
+	// Discards every tile decoded with a palette after its colours were edited
+	static void InvalidatePalette(const Landstalker::Palette* palette);
+	static void Clear();
+
+	static void SetMaxBytes(std::size_t max_bytes);
+	static std::size_t GetBytes();
+
+	static const std::size_t DEFAULT_MAX_BYTES = 32 * 1024 * 1024;
+private:
+	struct Page;
+	struct Entry
+	{
+		Page* page;
+		int key;
+		std::vector<uint32_t> pixels;
+	};
+	struct Page
+	{
+		std::weak_ptr<Landstalker::Tileset> tileset;
+		std::weak_ptr<Landstalker::Palette> palette;
+		std::unordered_map<int, std::list<Entry>::iterator> tiles;
+	};
+	using PageKey = std::pair<const Landstalker::Tileset*, const Landstalker::Palette*>;
+
+	static int GetKey(const Landstalker::Tile& tile);
+	static std::size_t GetEntrySize(const Entry& entry);
+	static void ErasePage(std::map<PageKey, Page>::iterator it);
+	static void EraseEntry(std::list<Entry>::iterator it);
+	static void Evict();
+
+	static std::map<PageKey, Page> s_pages;
+	// Most recently used first
+	static std::list<Entry> s_lru;
+	static std::size_t s_bytes;
+	static std::size_t s_max_bytes;
+};
+
+#endif // _TILE_ATLAS_H_
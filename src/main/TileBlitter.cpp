@@ -0,0 +1,104 @@
+#include <main/TileBlitter.h>
+
+#include <algorithm>
+#include <cstring>
+#include <wx/bitmap.h>
+
+void TileBlitter::Draw(wxDC& dc, int x, int y, const uint32_t* pixels, int width, int height, int scale)
+{
+	if (width <= 0 || height <= 0 || scale <= 0)
+	{
+		return;
+	}
+	Begin(x, y, width * scale, height * scale);
+	Add(0, 0, pixels, width, height, scale);
+	End(dc);
+}
+
+void TileBlitter::Begin(int x, int y, int width, int height)
+{
+	m_origin = wxPoint(x, y);
+	m_visible = false;
+	if (width <= 0 || height <= 0)
+	{
+		m_image = wxImage();
+		return;
+	}
+	// The scratch image is reused for as long as the region size stays the same
+	if (!m_image.IsOk() || m_image.GetWidth() != width || m_image.GetHeight() != height)
+	{
+		m_image.Create(width, height, false);
+		m_image.InitAlpha();
+	}
+	// Parts of the region not covered by a tile are left transparent
+	std::memset(m_image.GetAlpha(), 0x00, static_cast<std::size_t>(width) * height);
+}
+
+void TileBlitter::Add(int x, int y, const uint32_t* pixels, int width, int height, int scale)
+{
+	if (!m_image.IsOk() || width <= 0 || height <= 0 || scale <= 0 || x < 0 || y < 0 ||
+		x + width * scale > m_image.GetWidth() || y + height * scale > m_image.GetHeight())
+	{
+		return;
+	}
+	const std::size_t stride = m_image.GetWidth();
+	const std::size_t offset = y * stride + x;
+	if (Scale(pixels, width, height, scale, m_image.GetData() + offset * 3, m_image.GetAlpha() + offset, stride))
+	{
+		m_visible = true;
+	}
+}
+
+void TileBlitter::End(wxDC& dc)
+{
+	if (m_image.IsOk() && m_visible)
+	{
+		dc.DrawBitmap(wxBitmap(m_image), m_origin.x, m_origin.y, true);
+	}
+	m_visible = false;
+}
+
+bool TileBlitter::Scale(const uint32_t* pixels, int width, int height, int scale, uint8_t* rgb, uint8_t* alpha,
+	std::size_t stride)
+{
+	const std::size_t row_pixels = static_cast<std::size_t>(width) * scale;
+	const std::size_t run = static_cast<std::size_t>(scale) * 3;
+	if (stride == 0)
+	{
+		stride = row_pixels;
+	}
+	bool visible = false;
+	for (int y = 0; y < height; ++y)
+	{
+		uint8_t* const rgb_row = rgb + y * scale * stride * 3;
+		uint8_t* const alpha_row = alpha + y * scale * stride;
+		uint8_t* rgb_out = rgb_row;
+		uint8_t* alpha_out = alpha_row;
+		for (int x = 0; x < width; ++x)
+		{
+			const uint32_t colour = *pixels++;
+			const uint8_t a = (colour & 0xFF000000) > 0 ? 0xFF : 0x00;
+			visible = visible || a != 0;
+			rgb_out[0] = colour & 0xFF;
+			rgb_out[1] = (colour >> 8) & 0xFF;
+			rgb_out[2] = (colour >> 16) & 0xFF;
+			// Widen the enlarged pixel by doubling what has been written so far, so that
+			// large scales take a handful of copies rather than one store per byte
+			for (std::size_t filled = 3; filled < run; filled *= 2)
+			{
+				std::memcpy(rgb_out + filled, rgb_out, std::min(filled, run - filled));
+			}
+			rgb_out += run;
+			std::memset(alpha_out, a, scale);
+			alpha_out += scale;
+		}
+		// The remaining rows of each enlarged pixel are copies of the first, which memcpy
+		// replicates with wide stores
+		for (int i = 1; i < scale; ++i)
+		{
+			std::memcpy(rgb_row + i * stride * 3, rgb_row, row_pixels * 3);
+			std::memcpy(alpha_row + i * stride, alpha_row, row_pixels);
+		}
+	}
+	return visible;
+}
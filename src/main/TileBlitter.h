@@ -0,0 +1,38 @@
+#ifndef _TILE_BLITTER_H_
+#define _TILE_BLITTER_H_
+
+#include <wx/dc.h>
+#include <wx/image.h>
+#include <cstddef>
+#include <cstdint>
+
+// Draws tiles enlarged by an integer scale with nearest-neighbour sampling. Source pixels are
+// 0xAABBGGRR words, as returned by Palette::getBGRA, and are treated as either fully opaque or
+// fully transparent. Tiles are enlarged into a region image, e.g. a whole block or row, which
+// is converted and blitted once rather than once per tile.
+class TileBlitter
+{
+public:
+	// Draws a width x height tile with its top left corner at (x, y). Nothing is drawn if every
+	// pixel is transparent.
+	void Draw(wxDC& dc, int x, int y, const uint32_t* pixels, int width, int height, int scale);
+
+	// Starts a region of width x height device pixels with its top left corner at (x, y)
+	void Begin(int x, int y, int width, int height);
+	// Enlarges a tile into the region, with its top left corner at (x, y) relative to the
+	// region. Tiles that don't fit inside the region are ignored.
+	void Add(int x, int y, const uint32_t* pixels, int width, int height, int scale);
+	// Draws the region with a single blit, unless every pixel in it is transparent
+	void End(wxDC& dc);
+
+	// Writes the enlarged tile into an RGB plane and an alpha plane with stride pixels per row,
+	// or width * scale if stride is 0. Returns false if every pixel is transparent.
+	static bool Scale(const uint32_t* pixels, int width, int height, int scale, uint8_t* rgb, uint8_t* alpha,
+		std::size_t stride = 0);
+private:
+	wxImage m_image;
+	wxPoint m_origin;
+	bool m_visible = false;
+};
+
+#endif // _TILE_BLITTER_H_
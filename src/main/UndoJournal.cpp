@@ -0,0 +1,225 @@
+#include <main/UndoJournal.h>
+
+UndoJournal::UndoJournal(std::size_t max_bytes)
+	: m_bytes(0),
+	  m_max_bytes(max_bytes),
+	  m_stroke_depth(0),
+	  m_stroke_step_open(false),
+	  m_coalescing(false),
+	  m_applying(false)
+{
+}
+
+void UndoJournal::Push(const std::string& description, std::unique_ptr<Delta> delta, bool coalesce)
+{
+	if (m_applying || !delta)
+	{
+		// Edits made while undoing or redoing are already described by the step being applied
+		return;
+	}
+	ClearRedo();
+	if (m_stroke_depth > 0 && m_stroke_step_open && !m_undo.empty())
+	{
+		Append(m_undo.back(), std::move(delta));
+		return;
+	}
+	if (m_stroke_depth == 0 && coalesce && m_coalescing && !m_undo.empty() && m_undo.back().description == description)
+	{
+		Append(m_undo.back(), std::move(delta));
+		Evict();
+		return;
+	}
+	m_undo.push_back(Step{ m_stroke_depth > 0 ? m_stroke_description : description, {}, 0 });
+	Append(m_undo.back(), std::move(delta));
+	m_stroke_step_open = m_stroke_depth > 0;
+	m_coalescing = coalesce && m_stroke_depth == 0;
+	if (m_stroke_depth == 0)
+	{
+		Evict();
+	}
+	Notify();
+}
+
+void UndoJournal::BeginStroke(const std::string& description)
+{
+	if (m_stroke_depth++ == 0)
+	{
+		m_stroke_description = description;
+		m_stroke_step_open = false;
+		m_coalescing = false;
+	}
+}
+
+void UndoJournal::EndStroke()
+{
+	if (m_stroke_depth > 0 && --m_stroke_depth == 0)
+	{
+		m_stroke_step_open = false;
+		Evict();
+	}
+}
+
+bool UndoJournal::IsStrokeOpen() const
+{
+	return m_stroke_depth > 0;
+}
+
+bool UndoJournal::CanUndo() const
+{
+	return !m_undo.empty();
+}
+
+bool UndoJournal::CanRedo() const
+{
+	return !m_redo.empty();
+}
+
+void UndoJournal::Undo()
+{
+	if (m_undo.empty() || m_applying)
+	{
+		return;
+	}
+	Step step = std::move(m_undo.back());
+	m_undo.pop_back();
+	m_applying = true;
+	for (auto it = step.deltas.rbegin(); it != step.deltas.rend(); ++it)
+	{
+		(*it)->Undo();
+	}
+	m_applying = false;
+	m_redo.push_back(std::move(step));
+	m_stroke_step_open = false;
+	m_coalescing = false;
+	Notify();
+}
+
+void UndoJournal::Redo()
+{
+	if (m_redo.empty() || m_applying)
+	{
+		return;
+	}
+	Step step = std::move(m_redo.back());
+	m_redo.pop_back();
+	m_applying = true;
+	for (auto& delta : step.deltas)
+	{
+		delta->Redo();
+	}
+	m_applying = false;
+	m_undo.push_back(std::move(step));
+	m_stroke_step_open = false;
+	m_coalescing = false;
+	Notify();
+}
+
+std::string UndoJournal::GetUndoDescription() const
+{
+	return m_undo.empty() ? std::string() : m_undo.back().description;
+}
+
+std::string UndoJournal::GetRedoDescription() const
+{
+	return m_redo.empty() ? std::string() : m_redo.back().description;
+}
+
+void UndoJournal::Clear()
+{
+	const bool changed = !m_undo.empty() || !m_redo.empty();
+	m_undo.clear();
+	m_redo.clear();
+	m_bytes = 0;
+	m_stroke_step_open = false;
+	m_coalescing = false;
+	if (changed)
+	{
+		Notify();
+	}
+}
+
+void UndoJournal::SetMaxBytes(std::size_t max_bytes)
+{
+	m_max_bytes = max_bytes;
+	Evict();
+}
+
+std::size_t UndoJournal::GetMaxBytes() const
+{
+	return m_max_bytes;
+}
+
+std::size_t UndoJournal::GetBytes() const
+{
+	return m_bytes;
+}
+
+void UndoJournal::SetChangeHandler(std::function<void()> handler)
+{
+	m_on_change = std::move(handler);
+}
+
+void UndoJournal::Append(Step& step, std::unique_ptr<Delta> delta)
+{
+	if (!step.deltas.empty())
+	{
+		auto& last = *step.deltas.back();
+		const std::size_t before = last.GetSize();
+		if (last.Merge(*delta))
+		{
+			const std::size_t after = last.GetSize();
+			step.bytes = step.bytes - before + after;
+			m_bytes = m_bytes - before + after;
+			return;
+		}
+	}
+	const std::size_t size = delta->GetSize();
+	step.deltas.push_back(std::move(delta));
+	step.bytes += size;
+	m_bytes += size;
+}
+
+void UndoJournal::ClearRedo()
+{
+	if (m_redo.empty())
+	{
+		return;
+	}
+	for (const auto& step : m_redo)
+	{
+		m_bytes -= step.bytes;
+	}
+	m_redo.clear();
+	Notify();
+}
+
+void UndoJournal::Evict()
+{
+	bool evicted = false;
+	// Redo steps are the least likely to be wanted, then the oldest undo steps. The most
+	// recent step is always kept, however large it is.
+	while (m_bytes > m_max_bytes && !m_redo.empty())
+	{
+		m_bytes -= m_redo.front().bytes;
+		m_redo.erase(m_redo.begin());
+		evicted = true;
+	}
+	while (m_bytes > m_max_bytes && m_undo.size() > 1)
+	{
+		m_bytes -= m_undo.front().bytes;
+		m_undo.pop_front();
+		evicted = true;
+	}
+	if (evicted)
+	{
+		Notify();
+	}
+}
+
+void UndoJournal::Notify()
+{
+	if (m_on_change)
+	{
+		m_on_change();
+	}
+}
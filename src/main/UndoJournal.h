@@ -0,0 +1,219 @@
+#ifndef _UNDO_JOURNAL_H_
+#define _UNDO_JOURNAL_H_
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Records edits as small reversible deltas rather than copies of the edited object, so that
+// undoing or redoing an edit costs time proportional to the size of the edit. The oldest
+// steps are discarded once the journal holds more than its memory limit.
+class UndoJournal
+{
+public:
+	class Delta
+	{
+	public:
+		virtual ~Delta() = default;
+		virtual void Undo() = 0;
+		virtual void Redo() = 0;
+		// Approximate memory held by the delta, used to enforce the journal's limit
+		virtual std::size_t GetSize() const = 0;
+		// Folds a later delta into this one so that both are undone in a single step.
+		// Returns false if the two cannot be combined.
+		virtual bool Merge(Delta& /*next*/) { return false; }
+	};
+
+	UndoJournal(std::size_t max_bytes = DEFAULT_MAX_BYTES);
+
+	// Records an edit that has already been applied. Edits pushed while a stroke is open become
+	// part of the stroke's step. Otherwise, if coalesce is set and the previous step was also a
+	// coalescing push with the same description, the edit is merged into that step.
+	void Push(const std::string& description, std::unique_ptr<Delta> delta, bool coalesce = false);
+	// Groups every edit pushed until the matching EndStroke into one step, e.g. a drag with
+	// the pencil. Strokes may be nested; only the outermost description is used.
+	void BeginStroke(const std::string& description);
+	void EndStroke();
+	bool IsStrokeOpen() const;
+
+	bool CanUndo() const;
+	bool CanRedo() const;
+	void Undo();
+	void Redo();
+	std::string GetUndoDescription() const;
+	std::string GetRedoDescription() const;
+	void Clear();
+
+	void SetMaxBytes(std::size_t max_bytes);
+	std::size_t GetMaxBytes() const;
+	std::size_t GetBytes() const;
+	// Called whenever the available undo or redo steps change
+	void SetChangeHandler(std::function<void()> handler);
+
+	static const std::size_t DEFAULT_MAX_BYTES = 16 * 1024 * 1024;
+private:
+	struct Step
+	{
+		std::string description;
+		std::vector<std::unique_ptr<Delta>> deltas;
+		std::size_t bytes;
+	};
+
+	void Append(Step& step, std::unique_ptr<Delta> delta);
+	void ClearRedo();
+	void Evict();
+	void Notify();
+
+	std::deque<Step> m_undo;
+	std::vector<Step> m_redo;
+	std::size_t m_bytes;
+	std::size_t m_max_bytes;
+	int m_stroke_depth;
+	std::string m_stroke_description;
+	bool m_stroke_step_open;
+	bool m_coalescing;
+	bool m_applying;
+	std::function<void()> m_on_change;
+};
+
+// Keeps a stroke open for the lifetime of the guard
+class StrokeGuard
+{
+public:
+	StrokeGuard(UndoJournal& journal, const std::string& description)
+		: m_journal(journal)
+	{
+		m_journal.BeginStroke(description);
+	}
+
+	~StrokeGuard()
+	{
+		m_journal.EndStroke();
+	}
+
+	StrokeGuard(const StrokeGuard&) = delete;
+	StrokeGuard& operator=(const StrokeGuard&) = delete;
+private:
+	UndoJournal& m_journal;
+};
+
+// Values changed at a set of keys, e.g. map cells or tile pixels. Only the first old value and
+// the last new value are kept for each key, so repeatedly painting over the same cell during a
+// stroke does not grow the delta.
+template <class Key, class Value>
+class CellDelta : public UndoJournal::Delta
+{
+public:
+	using Apply = std::function<void(const Key&, const Value&)>;
+
+	// target identifies the edited object; only deltas with the same target are merged.
+	// applied is called once after a batch of values has been written back.
+	CellDelta(const void* target, Apply apply, std::function<void()> applied)
+		: m_target(target), m_apply(std::move(apply)), m_applied(std::move(applied))
+	{}
+
+	void Add(const Key& key, const Value& before, const Value& after)
+	{
+		auto it = m_changes.find(key);
+		if (it == m_changes.end())
+		{
+			m_changes.emplace(key, std::make_pair(before, after));
+		}
+		else
+		{
+			it->second.second = after;
+		}
+	}
+
+	bool IsEmpty() const
+	{
+		return m_changes.empty();
+	}
+
+	virtual void Undo() override
+	{
+		for (const auto& change : m_changes)
+		{
+			m_apply(change.first, change.second.first);
+		}
+		if (m_applied)
+		{
+			m_applied();
+		}
+	}
+
+	virtual void Redo() override
+	{
+		for (const auto& change : m_changes)
+		{
+			m_apply(change.first, change.second.second);
+		}
+		if (m_applied)
+		{
+			m_applied();
+		}
+	}
+
+	virtual std::size_t GetSize() const override
+	{
+		// Approximate cost of a red-black tree node on top of the payload
+		return sizeof(*this) + m_changes.size() * (sizeof(typename decltype(m_changes)::value_type) + 4 * sizeof(void*));
+	}
+
+	virtual bool Merge(UndoJournal::Delta& next) override
+	{
+		auto* other = dynamic_cast<CellDelta*>(&next);
+		if (other == nullptr || other->m_target != m_target)
+		{
+			return false;
+		}
+		for (const auto& change : other->m_changes)
+		{
+			Add(change.first, change.second.first, change.second.second);
+		}
+		return true;
+	}
+
+private:
+	const void* m_target;
+	Apply m_apply;
+	std::function<void()> m_applied;
+	std::map<Key, std::pair<Value, Value>> m_changes;
+};
+
+// An edit described by a pair of inverse operations, for structural changes such as inserting
+// or deleting a row. size should account for any data captured by the operations.
+class ActionDelta : public UndoJournal::Delta
+{
+public:
+	ActionDelta(std::function<void()> undo, std::function<void()> redo, std::size_t size = 0)
+		: m_undo(std::move(undo)), m_redo(std::move(redo)), m_size(size)
+	{}
+
+	virtual void Undo() override
+	{
+		m_undo();
+	}
+
+	virtual void Redo() override
+	{
+		m_redo();
+	}
+
+	virtual std::size_t GetSize() const override
+	{
+		return sizeof(*this) + m_size;
+	}
+
+private:
+	std::function<void()> m_undo;
+	std::function<void()> m_redo;
+	std::size_t m_size;
+};
+
+#endif // _UNDO_JOURNAL_H_
@@ -2,6 +2,7 @@
 
 #include <wx/dc.h>
 #include <wx/wx.h>
+#include <palettes/PaletteEditor.h>
 
 DataViewCtrlPaletteRenderer::DataViewCtrlPaletteRenderer(wxWindow* owner, wxDataViewCellMode mode)
     : wxDataViewCustomRenderer("void*", mode, wxALIGN_LEFT),
@@ -227,7 +228,13 @@ bool DataViewCtrlPaletteRenderer::SetColour()
     {
         const auto& colour = dialog.GetColourData().GetColour();
         auto result = Landstalker::Palette::Colour::CreateFromBGRA(colour.GetRGBA());
-        palette->SetNthUnlockedGenesisColour(m_cursor, result.GetGenesis());
+        if (result.GetGenesis() != palette->GetNthUnlockedColour(m_cursor).GetGenesis())
+        {
+            palette->SetNthUnlockedGenesisColour(m_cursor, result.GetGenesis());
+            wxCommandEvent evt(EVT_PALETTE_CHANGE);
+            evt.SetClientData(palette.get());
+            wxPostEvent(m_owner, evt);
+        }
     }
     return true;
 }
@@ -443,7 +443,8 @@ void PaletteEditor::FireEvent(const wxEventType& e, const std::string& data)
 {
 	wxCommandEvent evt(e);
 	evt.SetString(data);
-	evt.SetClientData(this);
+	// Palette changes are passed on to every open editor, so they carry the palette itself
+	evt.SetClientData(e == EVT_PALETTE_CHANGE ? static_cast<void*>(m_selected_palette.get()) : this);
 	wxPostEvent(this->GetParent(), evt);
 }
 
@@ -1,4 +1,5 @@
 #include <palettes/PaletteListFrame.h>
+#include <palettes/PaletteEditor.h>
 #include <cstdint>
 
 enum MENU_IDS
@@ -141,6 +142,15 @@ void PaletteListFrame::ClearGameData()
     m_gd = nullptr;
 }
 
+void PaletteListFrame::RecolourPalette(const Landstalker::Palette* /*palette*/)
+{
+    // Colours may have been edited from another editor's palette pane
+    if (m_list != nullptr)
+    {
+        m_list->Refresh();
+    }
+}
+
 bool PaletteListFrame::ExportAllPalettes(const std::filesystem::path& filename)
 {
     bool retval = false;
@@ -368,6 +378,10 @@ void PaletteListFrame::OnMenuImport()
     {
         std::string path = fd.GetPath().ToStdString();
         ImportPalettes(path);
+        // Any number of palettes may have been replaced
+        wxCommandEvent change_evt(EVT_PALETTE_CHANGE);
+        change_evt.SetClientData(nullptr);
+        wxPostEvent(this, change_evt);
 
         Refresh();
     }
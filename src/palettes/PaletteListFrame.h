@@ -30,6 +30,7 @@ public:
 
 	virtual void SetGameData(std::shared_ptr<Landstalker::GameData> gd);
 	virtual void ClearGameData();
+	virtual void RecolourPalette(const Landstalker::Palette* palette) override;
 
 	bool ExportAllPalettes(const std::filesystem::path& filename);
 	bool ImportPalettes(const std::filesystem::path& filename);
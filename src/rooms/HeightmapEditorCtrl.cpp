@@ -2,7 +2,9 @@
 
 #include <wx/dcbuffer.h>
 #include <wx/graphics.h>
+#include <main/AlphaBlend.h>
 #include <main/EditorFrame.h>
+#include <main/UndoJournal.h>
 #include <rooms/RoomViewerFrame.h>
 
 wxDEFINE_EVENT(EVT_HEIGHTMAP_UPDATE, wxCommandEvent);
@@ -108,6 +110,10 @@ void HeightmapEditorCtrl::UpdateSwaps()
 {
     if (m_g)
     {
+        if (m_preview_swap)
+        {
+            m_redraw = true;
+        }
         auto old_swap_count = m_swaps.size();
         m_swaps = m_g->GetRoomData()->GetTileSwaps(m_roomnum);
         if (m_swaps.size() != old_swap_count)
@@ -138,6 +144,7 @@ void HeightmapEditorCtrl::UpdateEntities(const std::vector<Landstalker::Entity>&
     if (m_g)
     {
         m_entities = entities;
+        m_redraw = true;
     }
 }
 
@@ -164,6 +171,11 @@ void HeightmapEditorCtrl::SetSelectedSwap(int swap)
     {
         wxLogDebug("Selected tileswap = %d, was %d", new_region, m_selected_region);
         m_selected_region = new_region;
+        if (m_preview_swap)
+        {
+            // The previewed swap is drawn into the raster
+            m_redraw = true;
+        }
         Refresh();
     }
 }
@@ -217,6 +229,11 @@ void HeightmapEditorCtrl::SetSelectedDoor(int door)
     {
         wxLogDebug("Selected door = %d, was %d", new_region, m_selected_region);
         m_selected_region = new_region;
+        if (m_preview_swap)
+        {
+            // The previewed swap is drawn into the raster
+            m_redraw = true;
+        }
         Refresh();
     }
 }
@@ -256,7 +273,7 @@ bool HeightmapEditorCtrl::HandleKeyDown(unsigned int key, unsigned int modifiers
         FireEvent(EVT_DOOR_SELECT, -1);
         FireEvent(EVT_HEIGHTMAP_CELL_SELECTED);
         RefreshStatusbar();
-        ForceRedraw();
+        ForceRepaint();
         return true;
     }
     if (!HandleRegionKeyDown(key, modifiers))
@@ -549,6 +566,10 @@ bool HeightmapEditorCtrl::HandleRegionKeyDown(unsigned int key, unsigned int mod
                 FireEvent(EVT_TILESWAP_UPDATE, GetSelectedSwap());
             }
         }
+        if (m_preview_swap)
+        {
+            m_redraw = true;
+        }
         Refresh();
     }
 
@@ -678,16 +699,22 @@ bool HeightmapEditorCtrl::HandleDrawKeyDown(unsigned int key, unsigned int modif
         return false;
     case 'C':
     case 'c':
+    {
+        StrokeGuard stroke(m_frame->GetUndoJournal(), "Set Cell Type");
         for (size_t i = 0; i < m_selected.size(); ++i) {
             SetSelectedType(i, 0);
         }
         return false;
+    }
     case 'X':
     case 'x':
+    {
+        StrokeGuard stroke(m_frame->GetUndoJournal(), "Set Restrictions");
         for (size_t i = 0; i < m_selected.size(); ++i) {
             SetSelectedRestrictions(i, 0);
         }
         return false;
+    }
     case '0':
     case '1':
     case '2':
@@ -888,6 +915,7 @@ void HeightmapEditorCtrl::NudgeHeightmapUp()
     if (t > 0)
     {
         m_map->SetTop(t - 1);
+        JournalMove(t, m_map->GetLeft());
         FireEvent(EVT_HEIGHTMAP_MOVE);
         FireEvent(EVT_PROPERTIES_UPDATE);
     }
@@ -899,6 +927,7 @@ void HeightmapEditorCtrl::NudgeHeightmapDown()
     if (t < 63)
     {
         m_map->SetTop(t + 1);
+        JournalMove(t, m_map->GetLeft());
         FireEvent(EVT_HEIGHTMAP_MOVE);
         FireEvent(EVT_PROPERTIES_UPDATE);
     }
@@ -910,6 +939,7 @@ void HeightmapEditorCtrl::NudgeHeightmapLeft()
     if (l > 0)
     {
         m_map->SetLeft(l - 1);
+        JournalMove(m_map->GetTop(), l);
         FireEvent(EVT_HEIGHTMAP_MOVE);
         FireEvent(EVT_PROPERTIES_UPDATE);
     }
@@ -921,6 +951,7 @@ void HeightmapEditorCtrl::NudgeHeightmapRight()
     if (l < 63)
     {
         m_map->SetLeft(l + 1);
+        JournalMove(m_map->GetTop(), l);
         FireEvent(EVT_HEIGHTMAP_MOVE);
         FireEvent(EVT_PROPERTIES_UPDATE);
     }
@@ -930,12 +961,13 @@ void HeightmapEditorCtrl::InsertRowAbove()
 {
     if (m_selected.size() == 1 && m_selected[0].second != -1 && m_map->GetHeightmapWidth() < 64)
     {
-        m_map->InsertHeightmapRow(m_selected[0].first);
+        const int row = m_selected[0].first;
+        auto map = m_map;
+        m_map->InsertHeightmapRow(row);
         m_selected[0].first++;
-        RecreateBuffer();
-        FireEvent(EVT_HEIGHTMAP_CELL_SELECTED);
-        FireEvent(EVT_HEIGHTMAP_UPDATE);
-        FireEvent(EVT_PROPERTIES_UPDATE);
+        JournalResize("Insert Row", [map, row]() { map->DeleteHeightmapRow(row); },
+            [map, row]() { map->InsertHeightmapRow(row); });
+        OnHeightmapResized();
     }
 }
 
@@ -943,11 +975,12 @@ void HeightmapEditorCtrl::InsertRowBelow()
 {
     if (m_selected[0].first != -1 && m_map->GetHeightmapWidth() < 64)
     {
-        m_map->InsertHeightmapRow(m_selected[0].first);
-        RecreateBuffer();
-        FireEvent(EVT_HEIGHTMAP_CELL_SELECTED);
-        FireEvent(EVT_HEIGHTMAP_UPDATE);
-        FireEvent(EVT_PROPERTIES_UPDATE);
+        const int row = m_selected[0].first;
+        auto map = m_map;
+        m_map->InsertHeightmapRow(row);
+        JournalResize("Insert Row", [map, row]() { map->DeleteHeightmapRow(row); },
+            [map, row]() { map->InsertHeightmapRow(row); });
+        OnHeightmapResized();
     }
 }
 
@@ -955,15 +988,29 @@ void HeightmapEditorCtrl::DeleteRow()
 {
     if (m_selected.size() == 1 && m_selected[0].first != -1 && m_map->GetHeightmapWidth() > 1)
     {
-        m_map->DeleteHeightmapRow(m_selected[0].first);
+        // Keep the deleted cells so that undo can put them back
+        const int row = m_selected[0].first;
+        std::vector<CellState> cells;
+        for (int y = 0; y < m_map->GetHeightmapHeight(); ++y)
+        {
+            cells.push_back(GetCellState({ row, y }));
+        }
+        auto map = m_map;
+        m_map->DeleteHeightmapRow(row);
         if (m_selected[0].first >= m_map->GetHeightmapWidth())
         {
             m_selected[0].first = m_map->GetHeightmapWidth() - 1;
         }
-        RecreateBuffer();
-        FireEvent(EVT_HEIGHTMAP_CELL_SELECTED);
-        FireEvent(EVT_HEIGHTMAP_UPDATE);
-        FireEvent(EVT_PROPERTIES_UPDATE);
+        JournalResize("Delete Row", [this, map, row, cells]()
+            {
+                map->InsertHeightmapRow(row);
+                for (int y = 0; y < static_cast<int>(cells.size()); ++y)
+                {
+                    ApplyCellState(map, { row, y }, cells[y]);
+                }
+            },
+            [map, row]() { map->DeleteHeightmapRow(row); }, cells.size() * sizeof(CellState));
+        OnHeightmapResized();
     }
 }
 
@@ -971,11 +1018,12 @@ void HeightmapEditorCtrl::InsertColumnLeft()
 {
     if (m_selected.size() == 1 && m_selected[0].first != -1 && m_map->GetHeightmapHeight() < 64)
     {
-        m_map->InsertHeightmapColumn(m_selected[0].second);
-        RecreateBuffer();
-        FireEvent(EVT_HEIGHTMAP_CELL_SELECTED);
-        FireEvent(EVT_HEIGHTMAP_UPDATE);
-        FireEvent(EVT_PROPERTIES_UPDATE);
+        const int column = m_selected[0].second;
+        auto map = m_map;
+        m_map->InsertHeightmapColumn(column);
+        JournalResize("Insert Column", [map, column]() { map->DeleteHeightmapColumn(column); },
+            [map, column]() { map->InsertHeightmapColumn(column); });
+        OnHeightmapResized();
     }
 }
 
@@ -983,12 +1031,13 @@ void HeightmapEditorCtrl::InsertColumnRight()
 {
     if (m_selected.size() == 1 && m_selected[0].second != -1 && m_map->GetHeightmapHeight() < 64)
     {
-        m_map->InsertHeightmapColumn(m_selected[0].second);
+        const int column = m_selected[0].second;
+        auto map = m_map;
+        m_map->InsertHeightmapColumn(column);
         m_selected[0].second++;
-        RecreateBuffer();
-        FireEvent(EVT_HEIGHTMAP_CELL_SELECTED);
-        FireEvent(EVT_HEIGHTMAP_UPDATE);
-        FireEvent(EVT_PROPERTIES_UPDATE);
+        JournalResize("Insert Column", [map, column]() { map->DeleteHeightmapColumn(column); },
+            [map, column]() { map->InsertHeightmapColumn(column); });
+        OnHeightmapResized();
     }
 }
 
@@ -996,15 +1045,28 @@ void HeightmapEditorCtrl::DeleteColumn()
 {
     if (m_selected.size() == 1 && m_selected[0].first != -1 && m_map->GetHeightmapHeight() > 1)
     {
-        m_map->DeleteHeightmapColumn(m_selected[0].second);
+        const int column = m_selected[0].second;
+        std::vector<CellState> cells;
+        for (int x = 0; x < m_map->GetHeightmapWidth(); ++x)
+        {
+            cells.push_back(GetCellState({ x, column }));
+        }
+        auto map = m_map;
+        m_map->DeleteHeightmapColumn(column);
         if (m_selected[0].second >= m_map->GetHeightmapHeight())
         {
             m_selected[0].second = m_map->GetHeightmapHeight() - 1;
         }
-        RecreateBuffer();
-        FireEvent(EVT_HEIGHTMAP_CELL_SELECTED);
-        FireEvent(EVT_HEIGHTMAP_UPDATE);
-        FireEvent(EVT_PROPERTIES_UPDATE);
+        JournalResize("Delete Column", [this, map, column, cells]()
+            {
+                map->InsertHeightmapColumn(column);
+                for (int x = 0; x < static_cast<int>(cells.size()); ++x)
+                {
+                    ApplyCellState(map, { x, column }, cells[x]);
+                }
+            },
+            [map, column]() { map->DeleteHeightmapColumn(column); }, cells.size() * sizeof(CellState));
+        OnHeightmapResized();
     }
 }
 
@@ -1015,13 +1077,15 @@ uint8_t HeightmapEditorCtrl::GetSelectedHeight(int index) const
 
 void HeightmapEditorCtrl::SetSelectedHeight(int index, uint8_t height)
 {
-    m_map->SetHeight({ m_selected[index].first, m_selected[index].second }, height);
-    ForceRedraw();
+    auto state = GetCellState(m_selected[index]);
+    state.height = height;
+    EditCell("Set Height", m_selected[index], state);
     FireEvent(EVT_HEIGHTMAP_UPDATE);
 }
 
 void HeightmapEditorCtrl::IncreaseHeight()
 {
+    StrokeGuard stroke(m_frame->GetUndoJournal(), "Raise Height");
     for (size_t i = 0; i < m_selected.size(); ++i) {
         uint8_t height = GetSelectedHeight(i);
         if (height < 15)
@@ -1034,6 +1098,7 @@ void HeightmapEditorCtrl::IncreaseHeight()
 
 void HeightmapEditorCtrl::DecreaseSelectedHeight()
 {
+    StrokeGuard stroke(m_frame->GetUndoJournal(), "Lower Height");
     for (size_t i = 0; i < m_selected.size(); ++i) {
         uint8_t height = GetSelectedHeight(i);
         if (height > 0)
@@ -1046,12 +1111,10 @@ void HeightmapEditorCtrl::DecreaseSelectedHeight()
 
 void HeightmapEditorCtrl::ClearSelectedCell()
 {
+    StrokeGuard stroke(m_frame->GetUndoJournal(), "Clear Cells");
     for (size_t i = 0; i < m_selected.size(); ++i) {
-        m_map->SetHeight({ m_selected[i].first, m_selected[i].second }, 0);
-        m_map->SetCellProps({ m_selected[i].first, m_selected[i].second }, 4);
-        m_map->SetCellType({ m_selected[i].first, m_selected[i].second }, 0);
+        EditCell("Clear Cells", m_selected[i], { 0, 4, 0 });
     }
-    ForceRedraw();
     FireEvent(EVT_HEIGHTMAP_UPDATE);
 }
 
@@ -1062,8 +1125,9 @@ uint8_t HeightmapEditorCtrl::GetSelectedRestrictions(int index) const
 
 void HeightmapEditorCtrl::SetSelectedRestrictions(int index, uint8_t restrictions)
 {
-    m_map->SetCellProps({ m_selected[index].first, m_selected[index].second }, restrictions);
-    ForceRedraw();
+    auto state = GetCellState(m_selected[index]);
+    state.restrictions = restrictions;
+    EditCell("Set Restrictions", m_selected[index], state);
     FireEvent(EVT_HEIGHTMAP_UPDATE);
 }
 
@@ -1079,6 +1143,7 @@ bool HeightmapEditorCtrl::IsSelectedPlayerPassable() const
 
 void HeightmapEditorCtrl::ToggleSelectedPlayerPassable()
 {
+    StrokeGuard stroke(m_frame->GetUndoJournal(), "Toggle Player Passable");
     bool hasFlag = IsSelectedPlayerPassable();
     for (size_t i = 0; i < m_selected.size(); ++i) {
         if (hasFlag) {
@@ -1101,6 +1166,7 @@ bool HeightmapEditorCtrl::IsSelectedNPCPassable() const
 
 void HeightmapEditorCtrl::ToggleSelectedNPCPassable()
 {
+    StrokeGuard stroke(m_frame->GetUndoJournal(), "Toggle NPC Passable");
     bool hasFlag = IsSelectedNPCPassable();
     for (size_t i = 0; i < m_selected.size(); ++i) {
         if (hasFlag) {
@@ -1123,6 +1189,7 @@ bool HeightmapEditorCtrl::IsSelectedRaftTrack() const
 
 void HeightmapEditorCtrl::ToggleSelectedRaftTrack()
 {
+    StrokeGuard stroke(m_frame->GetUndoJournal(), "Toggle Raft Track");
     bool hasFlag = IsSelectedRaftTrack();
     for (size_t i = 0; i < m_selected.size(); ++i) {
         if (hasFlag) {
@@ -1135,6 +1202,7 @@ void HeightmapEditorCtrl::ToggleSelectedRaftTrack()
 
 void HeightmapEditorCtrl::IncrementSelectedRestrictions()
 {
+    StrokeGuard stroke(m_frame->GetUndoJournal(), "Set Restrictions");
     for (size_t i = 0; i < m_selected.size(); ++i) {
         SetSelectedRestrictions(i, (GetSelectedRestrictions(i) + 1) & 0x0F);
     }
@@ -1142,6 +1210,7 @@ void HeightmapEditorCtrl::IncrementSelectedRestrictions()
 
 void HeightmapEditorCtrl::DecrementSelectedRestrictions()
 {
+    StrokeGuard stroke(m_frame->GetUndoJournal(), "Set Restrictions");
     for (size_t i = 0; i < m_selected.size(); ++i) {
         SetSelectedRestrictions(i, (GetSelectedRestrictions(i) - 1) & 0x0F);
     }
@@ -1154,13 +1223,15 @@ uint8_t HeightmapEditorCtrl::GetSelectedType(int index) const
 
 void HeightmapEditorCtrl::SetSelectedType(int index, uint8_t type)
 {
-    m_map->SetCellType({ m_selected[index].first, m_selected[index].second }, type);
-    ForceRedraw();
+    auto state = GetCellState(m_selected[index]);
+    state.type = type;
+    EditCell("Set Cell Type", m_selected[index], state);
     FireEvent(EVT_HEIGHTMAP_UPDATE);
 }
 
 void HeightmapEditorCtrl::IncrementSelectedType()
 {
+    StrokeGuard stroke(m_frame->GetUndoJournal(), "Set Cell Type");
     for (size_t i = 0; i < m_selected.size(); ++i) {
         SetSelectedType(i, (GetSelectedType(i) + 1) & 0xFF);
     }
@@ -1168,6 +1239,7 @@ void HeightmapEditorCtrl::IncrementSelectedType()
 
 void HeightmapEditorCtrl::DecrementSelectedType()
 {
+    StrokeGuard stroke(m_frame->GetUndoJournal(), "Set Cell Type");
     for (size_t i = 0; i < m_selected.size(); ++i) {
         SetSelectedType(i, (GetSelectedType(i) - 1) & 0xFF);
     }
@@ -1256,7 +1328,7 @@ bool HeightmapEditorCtrl::HandleLeftDown(unsigned int modifiers)
             m_selected.push_back(m_hovered);
         }
         FireEvent(EVT_HEIGHTMAP_CELL_SELECTED);
-        ForceRedraw();
+        ForceRepaint();
     }
     else
     {
@@ -1269,9 +1341,7 @@ bool HeightmapEditorCtrl::HandleLeftDown(unsigned int modifiers)
             }
             else
             {
-                m_map->SetHeight({ m_hovered.first, m_hovered.second }, m_map->GetHeight({ m_cpysrc.first, m_cpysrc.second }));
-                m_map->SetCellProps({ m_hovered.first, m_hovered.second }, m_map->GetCellProps({ m_cpysrc.first, m_cpysrc.second }));
-                m_map->SetCellType({ m_hovered.first, m_hovered.second }, m_map->GetCellType({ m_cpysrc.first, m_cpysrc.second }));
+                EditCellFromCopySource(m_hovered);
                 FireEvent(EVT_HEIGHTMAP_UPDATE);
             }
         }
@@ -1280,7 +1350,7 @@ bool HeightmapEditorCtrl::HandleLeftDown(unsigned int modifiers)
             m_selected.push_back(m_hovered);
             FireEvent(EVT_HEIGHTMAP_CELL_SELECTED);
         }
-        ForceRedraw();
+        ForceRepaint();
     }
     return false;
 }
@@ -1296,11 +1366,10 @@ bool HeightmapEditorCtrl::HandleRightDown(unsigned int modifiers)
     {
         m_cpysrc = m_hovered;
 
+        StrokeGuard stroke(m_frame->GetUndoJournal(), "Paste Cells");
         for (const auto& element : m_selected)
         {
-            m_map->SetHeight({ element.first, element.second }, m_map->GetHeight({ m_cpysrc.first, m_cpysrc.second }));
-            m_map->SetCellProps({ element.first, element.second }, m_map->GetCellProps({ m_cpysrc.first, m_cpysrc.second }));
-            m_map->SetCellType({ element.first, element.second }, m_map->GetCellType({ m_cpysrc.first, m_cpysrc.second }));
+            EditCellFromCopySource(element);
         }
 
         FireEvent(EVT_HEIGHTMAP_UPDATE);
@@ -1412,59 +1481,123 @@ void HeightmapEditorCtrl::UpdateCursor(wxStockCursor cursor)
     }
 }
 
-void HeightmapEditorCtrl::DrawRoomHeightmapBackground(wxDC& dc)
+void HeightmapEditorCtrl::UpdateRaster()
+{
+    if (!m_map)
+    {
+        return;
+    }
+    int sx, sy;
+    GetViewStart(&sx, &sy);
+    int sw, sh;
+    GetClientSize(&sw, &sh);
+    const wxRect content(0, 0, m_width, m_height);
+    const wxRect visible = wxRect(sx * m_scroll_rate, sy * m_scroll_rate, sw, sh).Intersect(content);
+    if (m_redraw || !m_bmp->IsOk() || (!visible.IsEmpty() && !m_raster_rect.Contains(visible)))
+    {
+        m_raster_rect = visible;
+        m_raster_rect.Inflate(RASTER_MARGIN);
+        m_raster_rect.Intersect(content);
+        m_bmp->Create(std::max(m_raster_rect.width, 1), std::max(m_raster_rect.height, 1));
+        wxMemoryDC dc(*m_bmp);
+        dc.SetDeviceOrigin(-m_raster_rect.x, -m_raster_rect.y);
+        DrawRasterRegion(dc, m_raster_rect);
+        dc.SelectObject(wxNullBitmap);
+        m_dirty_cells.clear();
+        m_redraw = false;
+    }
+    else if (!m_dirty_cells.empty())
+    {
+        wxMemoryDC dc(*m_bmp);
+        dc.SetDeviceOrigin(-m_raster_rect.x, -m_raster_rect.y);
+        for (const auto& cell : m_dirty_cells)
+        {
+            if (!IsCoordValid(cell))
+            {
+                continue;
+            }
+            // Neighbouring cells overlap the bounding box, so they get redrawn too, clipped to it
+            const wxRect region = GetCellRect(cell.first, cell.second).Intersect(m_raster_rect);
+            if (!region.IsEmpty())
+            {
+                DrawRasterRegion(dc, region);
+            }
+        }
+        dc.SelectObject(wxNullBitmap);
+        m_dirty_cells.clear();
+    }
+}
+
+void HeightmapEditorCtrl::DrawRasterRegion(wxDC& dc, const wxRect& region)
+{
+    dc.SetClippingRegion(region);
+    dc.SetPen(*wxTRANSPARENT_PEN);
+    dc.SetBrush(*wxBLACK_BRUSH);
+    dc.DrawRectangle(region);
+    DrawRoomHeightmapBackground(dc, region);
+    DrawEntities(dc);
+    DrawRoomHeightmapForeground(dc, region);
+    dc.DestroyClippingRegion();
+}
+
+void HeightmapEditorCtrl::DrawRoomHeightmapBackground(wxDC& dc, const wxRect& region)
 {
     if (m_map)
     {
         dc.SetPen(*wxTRANSPARENT_PEN);
 
-        auto lines = GetTilePoly(0, 0);
+        auto lines = GetTilePoly(0, 0, 1.0f, 1.0f, 0, std::lround(TILE_WIDTH * m_zoom), std::lround(TILE_HEIGHT * m_zoom));
         for (int iy = 0; iy < m_map->GetHeightmapHeight(); ++iy)
         {
             for (int ix = 0; ix < m_map->GetHeightmapWidth(); ++ix)
             {
-                int x = (m_map->GetHeightmapHeight() + ix - iy - 1) * TILE_WIDTH / 2;
-                int y = (ix + iy) * TILE_HEIGHT / 2;
+                const wxRect cell = GetCellRect(ix, iy);
+                if (!cell.Intersects(region))
+                {
+                    continue;
+                }
                 auto [restrictions, z, type] = GetHeightmapCell(ix, iy);
                 dc.SetBrush(wxBrush(GetCellBackground(restrictions, type, z)));
-                dc.DrawPolygon(lines.size(), lines.data(), x, y);
+                dc.DrawPolygon(lines.size(), lines.data(), cell.x, cell.y);
             }
         }
     }
 }
 
-void HeightmapEditorCtrl::DrawRoomHeightmapForeground(wxDC& dc)
+void HeightmapEditorCtrl::DrawRoomHeightmapForeground(wxDC& dc, const wxRect& region)
 {
     if (m_map)
     {
-        auto lines = GetTilePoly(0, 0);
-        auto font = wxFont(wxSize(0, TILE_HEIGHT / 2), wxFONTFAMILY_TELETYPE, wxFONTSTYLE_NORMAL,
-            wxFONTWEIGHT_NORMAL, false);
-        dc.SetFont(font);
+        auto lines = GetTilePoly(0, 0, 1.0f, 1.0f, 0, std::lround(TILE_WIDTH * m_zoom), std::lround(TILE_HEIGHT * m_zoom));
+        const int width = std::lround(TILE_WIDTH * m_zoom);
+        const int height = std::lround(TILE_HEIGHT * m_zoom);
+        const int pad = std::lround(2 * m_zoom);
+        GetGlyph('0', *wxLIGHT_GREY);
+        const int th = m_glyph_size.GetHeight();
         dc.SetBrush(*wxTRANSPARENT_BRUSH);
         dc.SetPen(wxPen(wxColor(128, 128, 128)));
         for (int iy = 0; iy < m_map->GetHeightmapHeight(); ++iy)
         {
             for (int ix = 0; ix < m_map->GetHeightmapWidth(); ++ix)
             {
-                int x = (m_map->GetHeightmapHeight() + ix - iy - 1) * TILE_WIDTH / 2;
-                int y = (ix + iy) * TILE_HEIGHT / 2;
+                const wxRect cell = GetCellRect(ix, iy);
+                if (!cell.Intersects(region))
+                {
+                    continue;
+                }
                 auto [restrictions, z, type] = GetHeightmapCell(ix, iy);
                 if (!IsCellHidden(restrictions, type, z))
                 {
-                    std::string lbl1 = Landstalker::StrPrintf("%02X", type);
-                    std::string lbl2 = Landstalker::StrPrintf("%X", z);
-                    std::string lbl3 = Landstalker::StrPrintf("%X", restrictions);
-                    wxCoord tw, th;
-                    dc.SetTextForeground(type == 0 ? *wxLIGHT_GREY : wxColor(0xFF00FF));
-                    dc.GetTextExtent(lbl1, &tw, &th);
-                    dc.DrawText(lbl1, x + TILE_WIDTH / 2 - tw / 2, y + TILE_HEIGHT / 4 - th / 2 + 2);
-                    dc.SetTextForeground(*wxCYAN);
-                    dc.GetTextExtent(lbl2, &tw, &th);
-                    dc.DrawText(lbl2, x + TILE_WIDTH / 2 - 5 * tw / 4, y + 5 * TILE_HEIGHT / 8 - th / 2 + 2);
-                    dc.SetTextForeground(restrictions == 0 ? *wxLIGHT_GREY : *wxYELLOW);
-                    dc.GetTextExtent(lbl3, &tw, &th);
-                    dc.DrawText(lbl3, x + TILE_WIDTH / 2 + 1 * tw / 4, y + 5 * TILE_HEIGHT / 8 - th / 2 + 2);
+                    const int x = cell.x;
+                    const int y = cell.y;
+                    const int tw1 = m_glyph_size.GetWidth() * 2;
+                    const int tw = m_glyph_size.GetWidth();
+                    DrawCellLabel(dc, Landstalker::StrPrintf("%02X", type), type == 0 ? *wxLIGHT_GREY : wxColor(0xFF00FF),
+                        x + width / 2 - tw1 / 2, y + height / 4 - th / 2 + pad);
+                    DrawCellLabel(dc, Landstalker::StrPrintf("%X", z), *wxCYAN,
+                        x + width / 2 - 5 * tw / 4, y + 5 * height / 8 - th / 2 + pad);
+                    DrawCellLabel(dc, Landstalker::StrPrintf("%X", restrictions), restrictions == 0 ? *wxLIGHT_GREY : *wxYELLOW,
+                        x + width / 2 + 1 * tw / 4, y + 5 * height / 8 - th / 2 + pad);
                 }
             }
         }
@@ -1472,19 +1605,30 @@ void HeightmapEditorCtrl::DrawRoomHeightmapForeground(wxDC& dc)
         {
             for (int ix = 0; ix < m_map->GetHeightmapWidth(); ++ix)
             {
-                int x = (m_map->GetHeightmapHeight() + ix - iy - 1) * TILE_WIDTH / 2;
-                int y = (ix + iy) * TILE_HEIGHT / 2;
-                dc.DrawPolygon(lines.size(), lines.data(), x, y);
+                const wxRect cell = GetCellRect(ix, iy);
+                if (cell.Intersects(region))
+                {
+                    dc.DrawPolygon(lines.size(), lines.data(), cell.x, cell.y);
+                }
             }
         }
     }
 }
 
-void HeightmapEditorCtrl::DrawCellRange(wxDC& dc, float x, float y, float w, float h, int s)
+void HeightmapEditorCtrl::DrawCellLabel(wxDC& dc, const std::string& label, const wxColour& colour, int x, int y)
+{
+    for (char c : label)
+    {
+        dc.DrawBitmap(GetGlyph(c, colour), x, y, true);
+        x += m_glyph_size.GetWidth();
+    }
+}
+
+void HeightmapEditorCtrl::DrawCellRange(wxDC& dc, float x, float y, float w, float h, int s, double scale)
 {
-    int xx = (m_map->GetHeightmapHeight() + x - y - 1) * TILE_WIDTH / 2;
-    int yy = (x + y) * TILE_HEIGHT / 2;
-    auto lines = GetTilePoly(0, 0, w, h, s);
+    int xx = (m_map->GetHeightmapHeight() + x - y - 1) * TILE_WIDTH / 2 * scale;
+    int yy = (x + y) * TILE_HEIGHT / 2 * scale;
+    auto lines = GetTilePoly(0, 0, w, h, s, std::lround(TILE_WIDTH * scale), std::lround(TILE_HEIGHT * scale));
     dc.DrawPolygon(lines.size(), lines.data(), xx, yy);
 }
 
@@ -1576,7 +1720,7 @@ void HeightmapEditorCtrl::DrawEntities(wxDC& dc)
         dc.SetBrush(*m_entity_brush1);
         //DrawCellRange(dc, entity.GetXDbl() - 12.5, entity.GetYDbl() - 12.5, hitbox.first / 8.0, hitbox.first / 8.0, 2);
         dc.SetBrush(*m_entity_brush2);
-        DrawCellRange(dc, entity.GetXDbl() - 12.5, entity.GetYDbl() - 12.5, hitbox.base / 8.0, hitbox.base / 8.0, 2);
+        DrawCellRange(dc, entity.GetXDbl() - 12.5, entity.GetYDbl() - 12.5, hitbox.base / 8.0, hitbox.base / 8.0, 2, m_zoom);
     }
 }
 
@@ -1632,12 +1776,7 @@ void HeightmapEditorCtrl::DrawSelectionCursors(wxDC& dc)
 
 void HeightmapEditorCtrl::SetOpacity(wxImage& image, uint8_t opacity)
 {
-    uint8_t* alpha = image.GetAlpha();
-    for (int i = 0; i < (image.GetHeight() * image.GetWidth()); i++)
-    {
-        *alpha = (*alpha < opacity) ? *alpha : opacity;
-        alpha++;
-    }
+    AlphaBlend::ClampAlpha(image.GetAlpha(), image.GetWidth() * image.GetHeight(), opacity);
 }
 
 bool HeightmapEditorCtrl::IsCoordValid(std::pair<int, int> c)
@@ -1726,6 +1865,141 @@ void HeightmapEditorCtrl::ForceRedraw()
     Refresh(true);
 }
 
+void HeightmapEditorCtrl::RedrawCell(const Coord& cell)
+{
+    if (m_preview_swap)
+    {
+        // Edits to a swap's source region also show up in its destination
+        ForceRedraw();
+        return;
+    }
+    m_dirty_cells.insert(cell);
+    Refresh(false);
+}
+
+HeightmapEditorCtrl::CellState HeightmapEditorCtrl::GetCellState(const Coord& cell) const
+{
+    return { m_map->GetHeight({ cell.first, cell.second }), m_map->GetCellProps({ cell.first, cell.second }),
+        m_map->GetCellType({ cell.first, cell.second }) };
+}
+
+void HeightmapEditorCtrl::ApplyCellState(std::shared_ptr<Landstalker::Tilemap3D> map, const Coord& cell, const CellState& state)
+{
+    map->SetHeight({ cell.first, cell.second }, state.height);
+    map->SetCellProps({ cell.first, cell.second }, state.restrictions);
+    map->SetCellType({ cell.first, cell.second }, state.type);
+    if (map == m_map)
+    {
+        RedrawCell(cell);
+    }
+}
+
+void HeightmapEditorCtrl::EditCell(const std::string& description, const Coord& cell, const CellState& state)
+{
+    const CellState before = GetCellState(cell);
+    ApplyCellState(m_map, cell, state);
+    auto map = m_map;
+    auto delta = std::make_unique<CellDelta<Coord, CellState>>(map.get(),
+        [this, map](const Coord& c, const CellState& s) { ApplyCellState(map, c, s); },
+        [this]() { FireEvent(EVT_HEIGHTMAP_UPDATE); });
+    delta->Add(cell, before, state);
+    m_frame->GetUndoJournal().Push(description, std::move(delta));
+}
+
+void HeightmapEditorCtrl::EditCellFromCopySource(const Coord& cell)
+{
+    EditCell("Paste Cell", cell, GetCellState(m_cpysrc));
+}
+
+void HeightmapEditorCtrl::JournalResize(const std::string& description, std::function<void()> undo, std::function<void()> redo, std::size_t size)
+{
+    auto map = m_map;
+    auto refresh = [this, map]()
+    {
+        if (map == m_map)
+        {
+            OnHeightmapResized();
+        }
+    };
+    m_frame->GetUndoJournal().Push(description, std::make_unique<ActionDelta>(
+        [undo, refresh]() { undo(); refresh(); },
+        [redo, refresh]() { redo(); refresh(); }, size));
+}
+
+void HeightmapEditorCtrl::OnHeightmapResized()
+{
+    // Undoing an insertion can leave selected cells beyond the edge of the heightmap
+    m_selected.erase(std::remove_if(m_selected.begin(), m_selected.end(),
+        [this](const Coord& c) { return !IsCoordValid(c); }), m_selected.end());
+    RecreateBuffer();
+    FireEvent(EVT_HEIGHTMAP_CELL_SELECTED);
+    FireEvent(EVT_HEIGHTMAP_UPDATE);
+    FireEvent(EVT_PROPERTIES_UPDATE);
+}
+
+void HeightmapEditorCtrl::JournalMove(int top, int left)
+{
+    auto map = m_map;
+    const int new_top = map->GetTop();
+    const int new_left = map->GetLeft();
+    auto move = [this, map](int t, int l)
+    {
+        map->SetTop(t);
+        map->SetLeft(l);
+        FireEvent(EVT_HEIGHTMAP_MOVE);
+        FireEvent(EVT_PROPERTIES_UPDATE);
+    };
+    // Repeated nudges are undone as one move
+    m_frame->GetUndoJournal().Push("Move Heightmap", std::make_unique<ActionDelta>(
+        [move, top, left]() { move(top, left); },
+        [move, new_top, new_left]() { move(new_top, new_left); }), true);
+}
+
+wxRect HeightmapEditorCtrl::GetCellRect(int x, int y) const
+{
+    const int left = std::lround((m_map->GetHeightmapHeight() + x - y - 1) * static_cast<int>(TILE_WIDTH) / 2 * m_zoom);
+    const int top = std::lround((x + y) * static_cast<int>(TILE_HEIGHT) / 2 * m_zoom);
+    return wxRect(left, top, std::lround(TILE_WIDTH * m_zoom) + 1, std::lround(TILE_HEIGHT * m_zoom) + 1);
+}
+
+const wxBitmap& HeightmapEditorCtrl::GetGlyph(char c, const wxColour& colour)
+{
+    const auto key = std::make_pair(c, static_cast<uint32_t>(colour.GetRGB()));
+    auto it = m_glyphs.find(key);
+    if (it != m_glyphs.end())
+    {
+        return it->second;
+    }
+    // Render the glyph once in white on black and use the result as coverage, so that it keeps
+    // its antialiasing when blended over any cell colour
+    const wxFont font(wxSize(0, std::max<int>(1, std::lround(TILE_HEIGHT / 2 * m_zoom))), wxFONTFAMILY_TELETYPE,
+        wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL, false);
+    wxBitmap bmp(1, 1);
+    wxMemoryDC dc(bmp);
+    dc.SetFont(font);
+    m_glyph_size = dc.GetTextExtent("0");
+    dc.SelectObject(wxNullBitmap);
+    bmp.Create(std::max(m_glyph_size.GetWidth(), 1), std::max(m_glyph_size.GetHeight(), 1));
+    dc.SelectObject(bmp);
+    dc.SetFont(font);
+    dc.SetBackground(*wxBLACK_BRUSH);
+    dc.Clear();
+    dc.SetTextForeground(*wxWHITE);
+    dc.DrawText(wxString(c), 0, 0);
+    dc.SelectObject(wxNullBitmap);
+    const wxImage coverage = bmp.ConvertToImage();
+    wxImage glyph(coverage.GetWidth(), coverage.GetHeight());
+    glyph.SetRGB(wxRect(0, 0, glyph.GetWidth(), glyph.GetHeight()), colour.Red(), colour.Green(), colour.Blue());
+    glyph.InitAlpha();
+    const uint8_t* src = coverage.GetData();
+    uint8_t* alpha = glyph.GetAlpha();
+    for (int i = 0; i < glyph.GetWidth() * glyph.GetHeight(); ++i)
+    {
+        alpha[i] = std::max({ src[i * 3], src[i * 3 + 1], src[i * 3 + 2] });
+    }
+    return m_glyphs.emplace(key, wxBitmap(glyph)).first->second;
+}
+
 void HeightmapEditorCtrl::RecreateBuffer()
 {
     m_width = (m_map->GetHeightmapWidth() + m_map->GetHeightmapHeight()) * TILE_WIDTH / 2 + 1;
@@ -1741,6 +2015,8 @@ void HeightmapEditorCtrl::RecreateBuffer()
     //    m_selected[0] = { -1, -1 };
     //}
     m_cpysrc = {-1, -1};
+    m_dirty_cells.clear();
+    m_glyphs.clear();
     RefreshGraphics();
 }
 
@@ -1819,10 +2095,12 @@ void HeightmapEditorCtrl::OnDraw(wxDC& dc)
 {
     dc.SetBackground(*wxBLACK_BRUSH);
     dc.Clear();
+    UpdateRaster();
+    if (m_bmp->IsOk())
+    {
+        dc.DrawBitmap(*m_bmp, m_raster_rect.GetPosition(), false);
+    }
     dc.SetUserScale(m_zoom, m_zoom);
-    DrawRoomHeightmapBackground(dc);
-    DrawEntities(dc);
-    DrawRoomHeightmapForeground(dc);
     DrawWarps(dc);
     DrawDoors(dc);
     DrawTileSwaps(dc);
@@ -1931,10 +2209,7 @@ void HeightmapEditorCtrl::OnLeftClick(wxMouseEvent& evt)
     UpdateSelectedPosition(evt.GetX(), evt.GetY());
     if (m_cpysrc.first != -1 && m_selected[0].first != -1 && m_selected[0] != m_cpysrc)
     {
-        m_map->SetHeight({ m_selected[0].first, m_selected[0].second}, m_map->GetHeight({ m_cpysrc.first, m_cpysrc.second}));
-        m_map->SetCellProps({ m_selected[0].first, m_selected[0].second }, m_map->GetCellProps({ m_cpysrc.first, m_cpysrc.second }));
-        m_map->SetCellType({ m_selected[0].first, m_selected[0].second }, m_map->GetCellType({ m_cpysrc.first, m_cpysrc.second }));
-        ForceRedraw();
+        EditCellFromCopySource(m_selected[0]);
         FireEvent(EVT_HEIGHTMAP_UPDATE);
     }
 }
@@ -6,6 +6,10 @@
 #include <memory>
 #include <cstdint>
 #include <algorithm>
+#include <map>
+#include <set>
+#include <functional>
+#include <string>
 #include <main/ImageBufferWx.h>
 #include <landstalker/main/GameData.h>
 #include <landstalker/3d_maps/Tilemap3D.h>
@@ -123,12 +127,30 @@ public:
 
 
 private:
+	struct CellState
+	{
+		uint8_t height;
+		uint8_t restrictions;
+		uint8_t type;
+	};
+
+	CellState GetCellState(const Coord& cell) const;
+	void ApplyCellState(std::shared_ptr<Landstalker::Tilemap3D> map, const Coord& cell, const CellState& state);
+	void EditCell(const std::string& description, const Coord& cell, const CellState& state);
+	void EditCellFromCopySource(const Coord& cell);
+	void JournalResize(const std::string& description, std::function<void()> undo, std::function<void()> redo, std::size_t size = 0);
+	void OnHeightmapResized();
+	void JournalMove(int top, int left);
+
 	void RefreshStatusbar();
 	void RefreshCursor(bool ctrl_down);
 	void UpdateCursor(wxStockCursor cursor);
-	void DrawRoomHeightmapBackground(wxDC& dc);
-	void DrawRoomHeightmapForeground(wxDC& dc);
-	void DrawCellRange(wxDC& dc, float x, float y, float w = 1.0f, float h = 1.0f, int s = 1);
+	void UpdateRaster();
+	void DrawRasterRegion(wxDC& dc, const wxRect& region);
+	void DrawRoomHeightmapBackground(wxDC& dc, const wxRect& region);
+	void DrawRoomHeightmapForeground(wxDC& dc, const wxRect& region);
+	void DrawCellLabel(wxDC& dc, const std::string& label, const wxColour& colour, int x, int y);
+	void DrawCellRange(wxDC& dc, float x, float y, float w = 1.0f, float h = 1.0f, int s = 1, double scale = 1.0);
 	void DrawDoors(wxDC& dc);
 	void DrawTileSwaps(wxDC& dc);
 	void DrawWarps(wxDC& dc);
@@ -136,6 +158,9 @@ private:
 	void DrawSelectionCursors(wxDC& dc);
 	void ForceRepaint();
 	void ForceRedraw();
+	void RedrawCell(const Coord& cell);
+	wxRect GetCellRect(int x, int y) const;
+	const wxBitmap& GetGlyph(char c, const wxColour& colour);
 	void RecreateBuffer();
 	void UpdateScroll();
 	bool Pnpoly(const std::vector<wxPoint2DDouble>& poly, int x, int y);
@@ -205,7 +230,13 @@ private:
 	std::vector<Landstalker::Entity> m_entities;
 	std::vector<Landstalker::WarpList::Warp> m_warps;
 
+	// Cell backgrounds, entities, labels and outlines for the visible part of the
+	// heightmap plus a margin, in scaled coordinates
 	std::unique_ptr<wxBitmap> m_bmp;
+	wxRect m_raster_rect;
+	std::set<Coord> m_dirty_cells;
+	std::map<std::pair<char, uint32_t>, wxBitmap> m_glyphs;
+	wxSize m_glyph_size;
 	bool m_dragging;
 	int m_selected_region;
 	bool m_selected_is_src;
@@ -214,6 +245,7 @@ private:
 	static const std::size_t TILE_WIDTH = 64;
 	static const std::size_t TILE_HEIGHT = 32;
 	static const int SCROLL_RATE = 32;
+	static const int RASTER_MARGIN = 256;
 	int m_scroll_rate;
 	wxStockCursor m_cursorid;
 
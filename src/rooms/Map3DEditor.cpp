@@ -1,8 +1,11 @@
 #include <rooms/Map3DEditor.h>
+#include <algorithm>
 #include <wx/graphics.h>
 #include <wx/dcbuffer.h>
 #include <rooms/RoomViewerFrame.h>
+#include <main/AlphaBlend.h>
 #include <main/ImageBufferWx.h>
+#include <main/UndoJournal.h>
 
 wxDEFINE_EVENT(EVT_MAPLAYER_UPDATE, wxCommandEvent);
 wxDEFINE_EVENT(EVT_MAPLAYER_CELL_SELECT, wxCommandEvent);
@@ -29,6 +32,7 @@ Map3DEditor::Map3DEditor(wxWindow* parent, RoomViewerFrame* frame, Landstalker::
       m_map_disp(nullptr),
       m_layer_buf(std::make_unique<ImageBufferWx>()),
       m_bg_buf(std::make_unique<ImageBufferWx>()),
+      m_cell_buf(std::make_unique<ImageBufferWx>(TILE_WIDTH / PIXEL_SCALE, TILE_HEIGHT / PIXEL_SCALE)),
       m_tileset(nullptr),
       m_pal(nullptr),
       m_blockset(nullptr),
@@ -38,6 +42,9 @@ Map3DEditor::Map3DEditor(wxWindow* parent, RoomViewerFrame* frame, Landstalker::
       m_width(1),
       m_height(1),
       m_redraw(false),
+      m_redraw_all(true),
+      m_recolour(false),
+      m_indexed_current(false),
       m_repaint(false),
       m_zoom(1.0),
       m_selected_block(0),
@@ -46,10 +53,15 @@ Map3DEditor::Map3DEditor(wxWindow* parent, RoomViewerFrame* frame, Landstalker::
       m_dragged(-1, -1),
       m_dragged_orig_pos(-1, -1),
       m_dragging(false),
+      m_painting(false),
       m_selected_region(-1),
       m_selected_is_src(false),
       m_preview_swap(false),
+      m_regions_valid(false),
+      m_region_index_valid(false),
       m_bmp(std::make_unique<wxBitmap>()),
+      m_overlay_bmp(std::make_unique<wxBitmap>()),
+      m_overlay_blockset(nullptr),
       m_show_blocknums(false),
       m_show_borders(true),
       m_show_priority(true),
@@ -154,8 +166,9 @@ void Map3DEditor::SetHovered(Coord sel)
 {
     if (IsCoordValid(sel) && m_hovered != sel)
     {
+        const Coord prev_hovered = m_hovered;
         m_hovered = sel;
-        Refresh();
+        RefreshHover(prev_hovered);
     }
 }
 
@@ -264,6 +277,7 @@ int Map3DEditor::GetTotalTileswaps() const
 void Map3DEditor::AddTileswap()
 {
     m_swaps.push_back(Landstalker::TileSwap());
+    InvalidateRegions();
     SetSelectedSwap(m_swaps.size() - 1);
     Refresh();
 }
@@ -274,6 +288,7 @@ void Map3DEditor::DeleteTileswap()
     {
         auto prev = GetSelectedSwap();
         m_swaps.erase(m_swaps.cbegin() + prev);
+        InvalidateRegions();
         SetSelectedSwap(prev);
         Refresh();
     }
@@ -292,6 +307,7 @@ int Map3DEditor::GetTotalDoors() const
 void Map3DEditor::AddDoor()
 {
     m_doors.push_back(Landstalker::Door());
+    InvalidateRegions();
     SetSelectedDoor(m_doors.size() - 1);
     Refresh();
 }
@@ -302,6 +318,7 @@ void Map3DEditor::DeleteSelectedDoor()
     {
         auto prev = GetSelectedDoor();
         m_doors.erase(m_doors.cbegin() + prev);
+        InvalidateRegions();
         SetSelectedDoor(prev);
         Refresh();
     }
@@ -309,17 +326,30 @@ void Map3DEditor::DeleteSelectedDoor()
 
 void Map3DEditor::RefreshGraphics()
 {
+    // Door outlines follow the heightmap, which may have changed too
+    InvalidateRegions();
+    m_redraw_all = true;
     UpdateScroll();
     ForceRedraw();
 }
 
+void Map3DEditor::RecolourPalette(const Landstalker::Palette* palette)
+{
+    if (m_pal == nullptr || (palette != nullptr && palette != m_pal.get()))
+    {
+        return;
+    }
+    m_recolour = true;
+    ForceRedraw();
+}
+
 void Map3DEditor::UpdateSwaps()
 {
     if (m_g)
     {
         auto old_swap_count = m_swaps.size();
         m_swaps = m_g->GetRoomData()->GetTileSwaps(m_roomnum);
-        m_swap_regions.clear();
+        InvalidateRegions();
         if (m_swaps.size() != old_swap_count)
         {
             ResetPreview();
@@ -333,7 +363,7 @@ void Map3DEditor::UpdateDoors()
     {
         auto old_door_count = m_doors.size();
         m_doors = m_g->GetRoomData()->GetDoors(m_roomnum);
-        m_door_regions.clear();
+        InvalidateRegions();
         if (m_doors.size() != old_door_count)
         {
             ResetPreview();
@@ -713,6 +743,7 @@ bool Map3DEditor::HandleRegionKeyDown(unsigned int key, unsigned int modifiers)
 
     if (upd)
     {
+        InvalidateRegions();
         if (m_g)
         {
             m_g->GetRoomData()->SetDoors(m_roomnum, m_doors);
@@ -758,7 +789,7 @@ bool Map3DEditor::HandleKeyUp(unsigned int key, unsigned int /*modifiers*/)
                     m_map_disp->SetBlock({ m_map->GetBlock({x, y}, m_layer), {x, y}}, m_layer);
                 }
             }
-            Refresh();
+            ForceRedraw();
         }
         break;
     }
@@ -767,11 +798,24 @@ bool Map3DEditor::HandleKeyUp(unsigned int key, unsigned int /*modifiers*/)
 
 bool Map3DEditor::HandleMouse(MouseEventType type, bool left_down, bool right_down, unsigned int modifiers, int x, int y)
 {
+    // A paint stroke lasts until the left button is released or the cursor leaves the control
+    if (m_painting && (!left_down || type == MouseEventType::LEAVE))
+    {
+        EndPaintStroke();
+    }
+
     // Refresh hover position
+    const Coord prev_hovered = m_hovered;
     if (type != MouseEventType::LEAVE && UpdateHoveredPosition(x, y))
     {
         RefreshStatusbar();
-        Refresh(false);
+        RefreshHover(prev_hovered);
+        // Paint blocks continuously while dragging with the left button held
+        if (type == MouseEventType::MOVE && left_down && !m_dragging && modifiers == 0)
+        {
+            BeginPaintStroke();
+            SetHoveredTile();
+        }
     }
 
     // Refresh cursor
@@ -848,6 +892,7 @@ bool Map3DEditor::HandleLeftDown(unsigned int modifiers)
         }
         else
         {
+            BeginPaintStroke();
             SetHoveredTile();
         }
     }
@@ -913,12 +958,53 @@ bool Map3DEditor::HandleRightDown(unsigned int modifiers)
 
 void Map3DEditor::SetHoveredTile()
 {
-    if (m_hovered.first != -1)
+    if (m_hovered.first != -1 && m_selected_block >= 0)
     {
-        m_map->SetBlock({ static_cast<uint16_t>(m_selected_block), {m_hovered.first, m_hovered.second} }, m_layer);
-        m_map_disp->SetBlock({ static_cast<uint16_t>(m_selected_block), {m_hovered.first, m_hovered.second} }, m_layer);
-        FireMapEvent(EVT_MAPLAYER_UPDATE);
-        ForceRedraw();
+        const uint16_t old_block = m_map->GetBlock({ m_hovered.first, m_hovered.second }, m_layer);
+        if (old_block != m_selected_block)
+        {
+            SetCellBlock(m_map, m_hovered, m_selected_block);
+            // Only the painted cell is journalled; strokes fold their cells into a single step
+            auto map = m_map;
+            auto delta = std::make_unique<CellDelta<Coord, uint16_t>>(map.get(),
+                [this, map](const Coord& cell, const uint16_t& blk) { SetCellBlock(map, cell, blk); },
+                [this]()
+                {
+                    FireMapEvent(EVT_MAPLAYER_UPDATE);
+                    ForceRedraw();
+                });
+            delta->Add(m_hovered, old_block, m_selected_block);
+            m_frame->GetUndoJournal().Push("Paint Blocks", std::move(delta));
+            FireMapEvent(EVT_MAPLAYER_UPDATE);
+            ForceRedraw();
+        }
+    }
+}
+
+void Map3DEditor::SetCellBlock(std::shared_ptr<Landstalker::Tilemap3D> map, const Coord& cell, uint16_t blk)
+{
+    map->SetBlock({ blk, {cell.first, cell.second} }, m_layer);
+    if (map == m_map && m_map_disp)
+    {
+        m_map_disp->SetBlock({ blk, {cell.first, cell.second} }, m_layer);
+    }
+}
+
+void Map3DEditor::BeginPaintStroke()
+{
+    if (!m_painting)
+    {
+        m_painting = true;
+        m_frame->GetUndoJournal().BeginStroke("Paint Blocks");
+    }
+}
+
+void Map3DEditor::EndPaintStroke()
+{
+    if (m_painting)
+    {
+        m_painting = false;
+        m_frame->GetUndoJournal().EndStroke();
     }
 }
 
@@ -979,6 +1065,9 @@ void Map3DEditor::RecreateBuffer()
     m_layer_buf->Resize(m_width, m_height);
     m_width *= m_zoom;
     m_height *= m_zoom;
+    m_overlay.Destroy();
+    m_block_summary.reset();
+    m_hex_glyphs.clear();
     if (!IsCoordValid(m_hovered))
     {
         m_hovered = { -1, -1 };
@@ -998,85 +1087,423 @@ void Map3DEditor::UpdateScroll()
     AdjustScrollbars();
 }
 
-void Map3DEditor::DrawMap(wxDC& dc)
+void Map3DEditor::UpdateOverlay()
 {
-    dc.SetUserScale(m_zoom, m_zoom);
-    if (m_map_disp)
+    if (!m_map_disp || !m_blockset)
     {
-        dc.SetPen(wxColor(128,128,128));
-        dc.SetBrush(*wxTRANSPARENT_BRUSH);
-        for (int y = 0; y < m_map_disp->GetHeight(); ++y)
+        return;
+    }
+    int sx, sy;
+    GetViewStart(&sx, &sy);
+    int sw, sh;
+    GetClientSize(&sw, &sh);
+    const wxRect buffer_rect(0, 0, m_width, m_height);
+    const wxRect visible = wxRect(sx * m_scroll_rate, sy * m_scroll_rate, sw, sh).Intersect(buffer_rect);
+    const int width = m_map_disp->GetWidth();
+    const int height = m_map_disp->GetHeight();
+    bool changed = false;
+    if (!m_overlay.IsOk() || (!visible.IsEmpty() && !m_overlay_rect.Contains(visible)) || m_overlay_blockset != m_blockset.get() ||
+        m_overlay_blocks.size() != static_cast<std::size_t>(width * height))
+    {
+        if (m_overlay_blockset != m_blockset.get())
+        {
+            m_block_summary.reset();
+            m_overlay_blockset = m_blockset.get();
+        }
+        m_overlay_rect = visible;
+        m_overlay_rect.Inflate(OVERLAY_MARGIN);
+        m_overlay_rect.Intersect(buffer_rect);
+        m_overlay.Create(std::max(m_overlay_rect.width, 1), std::max(m_overlay_rect.height, 1));
+        m_overlay.InitAlpha();
+        AlphaBlend::ClampAlpha(m_overlay.GetAlpha(), m_overlay.GetWidth() * m_overlay.GetHeight(), 0x00);
+        m_overlay_blocks.assign(width * height, -1);
+        changed = true;
+    }
+    // Only cells inside the overlay are drawn, and a cell is only drawn again if its block has changed
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            auto [xp, yp] = GetScreenPosition({ x, y });
+            if (!ScaleRect(xp, yp, TILE_WIDTH + 1, TILE_HEIGHT + 1).Intersects(m_overlay_rect))
+            {
+                continue;
+            }
+            const uint16_t blk = m_map_disp->GetBlock({ x,y }, m_layer);
+            int& drawn = m_overlay_blocks[y * width + x];
+            if (drawn == blk)
+            {
+                continue;
+            }
+            if (drawn == -1)
+            {
+                DrawOverlayBorder(xp, yp);
+            }
+            DrawOverlayCell(xp, yp, blk);
+            drawn = blk;
+            changed = true;
+        }
+    }
+    if (changed)
+    {
+        *m_overlay_bmp = wxBitmap(m_overlay);
+    }
+}
+
+void Map3DEditor::DrawOverlayBorder(int x, int y)
+{
+    if (m_show_borders)
+    {
+        const wxColour grey(128, 128, 128);
+        FillOverlayRect(ScaleRect(x, y, TILE_WIDTH + 1, 1), grey);
+        FillOverlayRect(ScaleRect(x, y + TILE_HEIGHT, TILE_WIDTH + 1, 1), grey);
+        FillOverlayRect(ScaleRect(x, y, 1, TILE_HEIGHT + 1), grey);
+        FillOverlayRect(ScaleRect(x + TILE_WIDTH, y, 1, TILE_HEIGHT + 1), grey);
+    }
+}
+
+void Map3DEditor::DrawOverlayCell(int x, int y, uint16_t blk)
+{
+    // Everything other than the border lies strictly inside the cell
+    FillOverlayRect(ScaleRect(x + 1, y + 1, TILE_WIDTH - 1, TILE_HEIGHT - 1), *wxBLACK, 0x00);
+    if (m_show_priority && IsBlockPriority(blk))
+    {
+        DrawOverlayDashedRect(x + 1, y + 1, TILE_WIDTH - 1, TILE_HEIGHT - 1, m_priority_pen->GetColour());
+    }
+    if (m_show_blocknums && blk > 0)
+    {
+        DrawOverlayText(x, y, blk);
+    }
+}
+
+void Map3DEditor::FillOverlayRect(const wxRect& rect, const wxColour& colour, uint8_t alpha)
+{
+    const wxRect r = rect.Intersect(m_overlay_rect);
+    for (int y = r.GetTop(); y <= r.GetBottom(); ++y)
+    {
+        const std::size_t offset = static_cast<std::size_t>(y - m_overlay_rect.y) * m_overlay.GetWidth() + (r.x - m_overlay_rect.x);
+        uint8_t* rgb = m_overlay.GetData() + offset * 3;
+        for (int x = 0; x < r.width; ++x)
         {
-            for (int x = 0; x < m_map_disp->GetWidth(); ++x)
+            rgb[x * 3] = colour.Red();
+            rgb[x * 3 + 1] = colour.Green();
+            rgb[x * 3 + 2] = colour.Blue();
+        }
+        std::fill_n(m_overlay.GetAlpha() + offset, r.width, alpha);
+    }
+}
+
+void Map3DEditor::DrawOverlayDashedRect(int x, int y, int width, int height, const wxColour& colour)
+{
+    for (int i = 0; i < width; i += PRIORITY_DASH_LENGTH * 2)
+    {
+        const int len = std::min(PRIORITY_DASH_LENGTH, width - i);
+        FillOverlayRect(ScaleRect(x + i, y, len, 1), colour);
+        FillOverlayRect(ScaleRect(x + i, y + height - 1, len, 1), colour);
+    }
+    for (int i = 0; i < height; i += PRIORITY_DASH_LENGTH * 2)
+    {
+        const int len = std::min(PRIORITY_DASH_LENGTH, height - i);
+        FillOverlayRect(ScaleRect(x, y + i, 1, len), colour);
+        FillOverlayRect(ScaleRect(x + width - 1, y + i, 1, len), colour);
+    }
+}
+
+void Map3DEditor::DrawOverlayText(int x, int y, uint16_t blk)
+{
+    const std::array<int, 3> digits = { (blk >> 8) & 0xF, (blk >> 4) & 0xF, blk & 0xF };
+    int text_width = 0;
+    int text_height = 0;
+    for (int d : digits)
+    {
+        // Glyphs carry a one pixel outline on every side
+        text_width += GetHexGlyph(d).GetWidth() - 2;
+        text_height = std::max(text_height, GetHexGlyph(d).GetHeight() - 2);
+    }
+    const wxRect cell = ScaleRect(x, y, TILE_WIDTH, TILE_HEIGHT);
+    int gx = cell.x + (cell.width - text_width) / 2 - 1 - m_overlay_rect.x;
+    const int gy = cell.y + (cell.height - text_height) / 2 - 1 - m_overlay_rect.y;
+    for (int d : digits)
+    {
+        const wxImage& glyph = GetHexGlyph(d);
+        const int x0 = std::max(gx, 0);
+        const int x1 = std::min(gx + glyph.GetWidth(), m_overlay.GetWidth());
+        for (int py = std::max(gy, 0); py < std::min(gy + glyph.GetHeight(), m_overlay.GetHeight()) && x0 < x1; ++py)
+        {
+            const std::size_t src = static_cast<std::size_t>(py - gy) * glyph.GetWidth() + (x0 - gx);
+            const std::size_t dst = static_cast<std::size_t>(py) * m_overlay.GetWidth() + x0;
+            AlphaBlend::BlendOverAlpha(m_overlay.GetData() + dst * 3, m_overlay.GetAlpha() + dst,
+                glyph.GetData() + src * 3, glyph.GetAlpha() + src, x1 - x0);
+        }
+        gx += glyph.GetWidth() - 2;
+    }
+}
+
+wxRect Map3DEditor::ScaleRect(int x, int y, int width, int height) const
+{
+    const int left = std::lround(x * m_zoom);
+    const int top = std::lround(y * m_zoom);
+    return wxRect(left, top, std::max<int>(std::lround((x + width) * m_zoom) - left, 1),
+        std::max<int>(std::lround((y + height) * m_zoom) - top, 1));
+}
+
+bool Map3DEditor::IsBlockPriority(uint16_t blk)
+{
+    if (!m_block_summary)
+    {
+        m_block_summary = BlockSummaryIndex::Get(m_blockset);
+    }
+    return m_block_summary && m_block_summary->HasPriority(blk);
+}
+
+const wxImage& Map3DEditor::GetHexGlyph(int digit)
+{
+    if (m_hex_glyphs.empty())
+    {
+        // Each digit is rendered once, then given the same one pixel white outline
+        // that drawing the text offset in each direction would produce
+        wxMemoryDC dc;
+        dc.SetFont(GetFont());
+        for (int i = 0; i < 16; ++i)
+        {
+            const wxString t = Landstalker::StrPrintf("%X", i);
+            const wxSize extent = dc.GetTextExtent(t);
+            const int w = std::max<int>(std::ceil(extent.GetWidth() * m_zoom), 1);
+            const int h = std::max<int>(std::ceil(extent.GetHeight() * m_zoom), 1);
+            wxBitmap bmp(w, h);
+            dc.SelectObject(bmp);
+            dc.SetUserScale(m_zoom, m_zoom);
+            dc.SetBackground(*wxWHITE_BRUSH);
+            dc.Clear();
+            dc.SetTextForeground(*wxBLACK);
+            dc.DrawText(t, 0, 0);
+            dc.SelectObject(wxNullBitmap);
+            const wxImage text = bmp.ConvertToImage();
+            auto is_set = [&](int x, int y)
             {
-                int xp = (m_map_disp->GetHeight() - 1 + x - y) * TILE_WIDTH + (m_layer == Landstalker::Tilemap3D::Layer::BG ? TILE_WIDTH : 0);
-                int yp = (x + y) * TILE_HEIGHT / 2;
-                if (m_show_borders)
-                {
-                    dc.DrawRectangle(xp, yp, TILE_WIDTH + 1, TILE_HEIGHT + 1);
-                }
-                uint16_t blk = m_map_disp->GetBlock({ x,y }, m_layer);
-                if (m_show_priority)
+                return x >= 0 && y >= 0 && x < w && y < h && text.GetRed(x, y) < 0x80;
+            };
+            wxImage glyph(w + 2, h + 2);
+            glyph.InitAlpha();
+            for (int y = 0; y < h + 2; ++y)
+            {
+                for (int x = 0; x < w + 2; ++x)
                 {
-                    bool pri = false;
-                    for (std::size_t i = 0; i < Landstalker::MapBlock::GetBlockSize(); ++i)
+                    if (is_set(x - 1, y - 1))
                     {
-                        pri = pri || m_blockset->at(blk).GetTile(i).Attributes().getAttribute(Landstalker::TileAttributes::Attribute::ATTR_PRIORITY);
+                        glyph.SetRGB(x, y, 0, 0, 0);
+                        glyph.SetAlpha(x, y, 0xFF);
                     }
-                    if (pri)
+                    else if (is_set(x - 2, y - 1) || is_set(x, y - 1) || is_set(x - 1, y - 2) || is_set(x - 1, y))
                     {
-                        dc.SetPen(*m_priority_pen);
-                        dc.DrawRectangle({ xp + 1, yp + 1, TILE_WIDTH - 1, TILE_HEIGHT - 1 });
-                        dc.SetPen(wxColor(128, 128, 128));
+                        glyph.SetRGB(x, y, 0xFF, 0xFF, 0xFF);
+                        glyph.SetAlpha(x, y, 0xFF);
+                    }
+                    else
+                    {
+                        glyph.SetAlpha(x, y, 0x00);
                     }
                 }
-                if (m_show_blocknums && blk > 0)
+            }
+            m_hex_glyphs.push_back(glyph);
+        }
+    }
+    return m_hex_glyphs.at(digit);
+}
+
+void Map3DEditor::DrawTiles()
+{
+    if (!m_redraw)
+    {
+        return;
+    }
+    auto pal = m_g->GetRoomData()->GetPaletteForRoom(m_roomnum)->GetData();
+    auto tileset = m_g->GetRoomData()->GetTilesetForRoom(m_roomnum)->GetData();
+    auto blockset = m_g->GetRoomData()->GetCombinedBlocksetForRoom(m_roomnum);
+    if (pal != m_pal || tileset != m_tileset || blockset != m_blockset)
+    {
+        m_pal = pal;
+        m_tileset = tileset;
+        m_blockset = blockset;
+        m_redraw_all = true;
+    }
+    if (!m_map_rastered || !m_bmp->IsOk() || m_map_rastered->GetWidth() != m_map_disp->GetWidth() ||
+        m_map_rastered->GetHeight() != m_map_disp->GetHeight())
+    {
+        m_redraw_all = true;
+    }
+    if (m_recolour && !m_indexed_current)
+    {
+        m_redraw_all = true;
+    }
+    if (!m_redraw_all)
+    {
+        auto dirty = GetDirtyCells();
+        // Past a certain point it is cheaper to rasterise the map in one go
+        if (dirty.size() * 4 > static_cast<std::size_t>(m_map_disp->GetWidth() * m_map_disp->GetHeight()))
+        {
+            m_redraw_all = true;
+        }
+        else
+        {
+            if (m_recolour)
+            {
+                RecolourAll();
+            }
+            RasteriseCells(dirty);
+        }
+    }
+    if (m_redraw_all)
+    {
+        RasteriseAll();
+        m_redraw_all = false;
+    }
+    m_recolour = false;
+    m_redraw = false;
+}
+
+std::vector<std::pair<Landstalker::Tilemap3D::Layer, Map3DEditor::Coord>> Map3DEditor::GetDirtyCells() const
+{
+    std::vector<std::pair<Landstalker::Tilemap3D::Layer, Coord>> cells;
+    std::vector<Landstalker::Tilemap3D::Layer> layers = { m_layer };
+    if (m_layer == Landstalker::Tilemap3D::Layer::FG)
+    {
+        layers.push_back(Landstalker::Tilemap3D::Layer::BG);
+    }
+    for (auto layer : layers)
+    {
+        for (int y = 0; y < m_map_disp->GetHeight(); ++y)
+        {
+            for (int x = 0; x < m_map_disp->GetWidth(); ++x)
+            {
+                if (m_map_disp->GetBlock({ x, y }, layer) != m_map_rastered->GetBlock({ x, y }, layer))
                 {
-                    wxString t = Landstalker::StrPrintf("%03X", blk);
-                    auto extent = dc.GetTextExtent(t);
-                    dc.SetTextForeground(*wxWHITE);
-                    int tx = xp + (TILE_WIDTH - extent.GetWidth()) / 2;
-                    int ty = yp + (TILE_HEIGHT - extent.GetHeight()) / 2;
-                    dc.DrawText(t, tx + 1, ty);
-                    dc.DrawText(t, tx - 1, ty);
-                    dc.DrawText(t, tx, ty + 1);
-                    dc.DrawText(t, tx, ty - 1);
-                    dc.SetTextForeground(*wxBLACK);
-                    dc.DrawText(t, tx, ty);
+                    cells.push_back({ layer, { x, y } });
                 }
             }
         }
     }
+    return cells;
 }
 
-void Map3DEditor::DrawTiles()
+void Map3DEditor::RasteriseAll()
 {
-    if (m_redraw)
+    m_layer_buf->Clear();
+    m_layer_buf->Insert3DMapLayer(0, 0, 0, m_layer, m_map_disp, m_tileset, m_blockset, false, m_preview_swaps, m_preview_doors);
+    if (m_layer == Landstalker::Tilemap3D::Layer::FG)
     {
-        wxMemoryDC dc(*m_bmp);
-        m_pal = m_g->GetRoomData()->GetPaletteForRoom(m_roomnum)->GetData();
-        m_tileset = m_g->GetRoomData()->GetTilesetForRoom(m_roomnum)->GetData();
-        m_blockset = m_g->GetRoomData()->GetCombinedBlocksetForRoom(m_roomnum);
-        m_layer_buf->Clear();
-        m_layer_buf->Insert3DMapLayer(0, 0, 0, m_layer, m_map_disp, m_tileset, m_blockset, false, m_preview_swaps, m_preview_doors);
-        if (m_layer == Landstalker::Tilemap3D::Layer::FG)
+        m_bg_buf->Clear();
+        m_bg_buf->Insert3DMapLayer(0, 0, 0, Landstalker::Tilemap3D::Layer::BG, m_map_disp, m_tileset, m_blockset, false);
+    }
+    m_map_rastered = std::make_shared<Landstalker::Tilemap3D>(*m_map_disp);
+    m_indexed_current = true;
+    RecolourAll();
+}
+
+void Map3DEditor::RecolourAll()
+{
+    // Only the palette lookup is redone here; the indexed buffers are left as they are
+    m_layer_img = m_layer_buf->MakeImage({ m_pal }, true);
+    if (m_layer == Landstalker::Tilemap3D::Layer::FG)
+    {
+        m_bg_img = m_bg_buf->MakeImage({ m_pal }, true);
+    }
+    else
+    {
+        m_bg_img.Destroy();
+    }
+    m_canvas.Create(m_layer_img.GetWidth(), m_layer_img.GetHeight(), false);
+    CompositeRect(wxRect(0, 0, m_canvas.GetWidth(), m_canvas.GetHeight()));
+
+    m_bmp->Create(m_width, m_height);
+    wxMemoryDC dc(*m_bmp);
+    dc.SetBackground(wxBrush(wxSystemSettings::GetColour(wxSYS_COLOUR_APPWORKSPACE)));
+    dc.Clear();
+    dc.SetUserScale(m_zoom * PIXEL_SCALE, m_zoom * PIXEL_SCALE);
+    dc.DrawBitmap(wxBitmap(m_canvas), 0, 0, false);
+    dc.SelectObject(wxNullBitmap);
+}
+
+void Map3DEditor::RasteriseCells(const std::vector<std::pair<Landstalker::Tilemap3D::Layer, Coord>>& cells)
+{
+    if (cells.empty())
+    {
+        return;
+    }
+    // Cells are drawn straight into the converted images, so the indexed buffers no longer
+    // match what is on screen
+    m_indexed_current = false;
+    wxMemoryDC dc(*m_bmp);
+    dc.SetUserScale(m_zoom * PIXEL_SCALE, m_zoom * PIXEL_SCALE);
+    for (const auto& [layer, cell] : cells)
+    {
+        const wxRect rect = GetCellRasterRect(layer, cell).Intersect(wxRect(0, 0, m_canvas.GetWidth(), m_canvas.GetHeight()));
+        if (rect.IsEmpty())
         {
-            m_bg_buf->Clear();
-            m_bg_buf->Insert3DMapLayer(0, 0, 0, Landstalker::Tilemap3D::Layer::BG, m_map_disp, m_tileset, m_blockset, false);
+            continue;
         }
-        dc.SetBackground(wxBrush(wxSystemSettings::GetColour(wxSYS_COLOUR_APPWORKSPACE)));
-        dc.Clear();
-        dc.SetUserScale(m_zoom * 2.0, m_zoom * 2.0);
-        if (m_layer == Landstalker::Tilemap3D::Layer::FG)
+        RasteriseCell(layer, cell, layer == m_layer ? m_layer_img : m_bg_img);
+        m_map_rastered->SetBlock({ m_map_disp->GetBlock({ cell.first, cell.second }, layer), { cell.first, cell.second } }, layer);
+        CompositeRect(rect);
+        dc.DrawBitmap(wxBitmap(m_canvas.GetSubImage(rect)), rect.GetPosition(), false);
+    }
+    dc.SelectObject(wxNullBitmap);
+}
+
+void Map3DEditor::RasteriseCell(Landstalker::Tilemap3D::Layer layer, const Coord& cell, wxImage& img)
+{
+    const wxRect cell_rect = GetCellRasterRect(layer, cell);
+    const wxRect rect = cell_rect.Intersect(wxRect(0, 0, img.GetWidth(), img.GetHeight()));
+    if (rect.IsEmpty())
+    {
+        return;
+    }
+    const uint16_t blk = m_map_disp->GetBlock({ cell.first, cell.second }, layer);
+    m_cell_buf->Clear();
+    if (blk < m_blockset->size())
+    {
+        m_cell_buf->InsertBlock(0, 0, 0, m_blockset->at(blk), *m_tileset);
+    }
+    // Cells never overlap, so the block simply replaces whatever was there before
+    const wxImage block = m_cell_buf->MakeImage({ m_pal }, true);
+    for (int y = 0; y < rect.height; ++y)
+    {
+        const int dst = (rect.y + y) * img.GetWidth() + rect.x;
+        const int src = (rect.y - cell_rect.y + y) * block.GetWidth() + rect.x - cell_rect.x;
+        std::copy_n(block.GetData() + src * 3, rect.width * 3, img.GetData() + dst * 3);
+        std::copy_n(block.GetAlpha() + src, rect.width, img.GetAlpha() + dst);
+    }
+}
+
+void Map3DEditor::CompositeRect(const wxRect& rect)
+{
+    const wxColour bg = wxSystemSettings::GetColour(wxSYS_COLOUR_APPWORKSPACE);
+    const bool ghost = m_layer == Landstalker::Tilemap3D::Layer::FG && m_bg_img.IsOk();
+    for (int y = rect.GetTop(); y <= rect.GetBottom(); ++y)
+    {
+        const int offset = y * m_canvas.GetWidth() + rect.x;
+        uint8_t* dst = m_canvas.GetData() + offset * 3;
+        for (int x = 0; x < rect.width; ++x)
         {
-            dc.DrawBitmap(*m_bg_buf->MakeBitmap({ m_pal }, true, 0x40, 0x40), 0, 0, false);
+            dst[x * 3] = bg.Red();
+            dst[x * 3 + 1] = bg.Green();
+            dst[x * 3 + 2] = bg.Blue();
         }
-        dc.DrawBitmap(*m_layer_buf->MakeBitmap({ m_pal }, true), 0, 0, true);
-        m_redraw = false;
-        dc.SelectObject(wxNullBitmap);
+        if (ghost)
+        {
+            AlphaBlend::BlendOver(dst, m_bg_img.GetData() + offset * 3, m_bg_img.GetAlpha() + offset, rect.width, 0x40);
+        }
+        AlphaBlend::BlendOver(dst, m_layer_img.GetData() + offset * 3, m_layer_img.GetAlpha() + offset, rect.width);
     }
 }
 
+wxRect Map3DEditor::GetCellRasterRect(Landstalker::Tilemap3D::Layer layer, const Coord& cell) const
+{
+    const int xp = (m_map->GetHeight() - 1 + cell.first - cell.second) * TILE_WIDTH + (layer == Landstalker::Tilemap3D::Layer::BG ? TILE_WIDTH : 0);
+    const int yp = (cell.first + cell.second) * TILE_HEIGHT / 2;
+    return wxRect(xp / PIXEL_SCALE, yp / PIXEL_SCALE, TILE_WIDTH / PIXEL_SCALE, TILE_HEIGHT / PIXEL_SCALE);
+}
+
 void Map3DEditor::DrawTile(int /*tile*/)
 {
 }
@@ -1089,60 +1516,31 @@ void Map3DEditor::DrawCell(wxDC& dc, const std::pair<int, int>& pos, const wxPen
     dc.DrawRectangle(p.first, p.second, TILE_WIDTH + 1, TILE_HEIGHT + 1);
 }
 
-void Map3DEditor::DrawTileSwaps(wxDC& dc)
+void Map3DEditor::DrawTileSwaps(wxDC& dc, const std::vector<int>& hovered)
 {
-    m_swap_regions.clear();
-    int si = 0;
-    for (const auto& s : m_swaps)
+    for (int si = 0; si < static_cast<int>(m_swap_regions.size()); ++si)
     {
-        std::pair<int, int> src, dst;
-        auto lines = s.GetMapRegionPoly(Landstalker::TileSwap::Region::UNDEFINED, TILE_WIDTH, TILE_HEIGHT);
-        std::vector<wxPoint> wxpoints = ToWxPoints(lines);
-        auto sp = GetScreenPosition(s.GetTileOffset(Landstalker::TileSwap::Region::SOURCE, m_map, m_layer));
-        auto dp = GetScreenPosition(s.GetTileOffset(Landstalker::TileSwap::Region::DESTINATION, m_map, m_layer));
-        auto [hx, hy] = GetScreenPosition(m_hovered);
-        m_swap_regions.emplace_back(
-                ToWxPoints(Landstalker::TileSwap::OffsetRegionPoly(lines, sp)),
-                ToWxPoints(Landstalker::TileSwap::OffsetRegionPoly(lines, dp)));
-        bool hovered = false;
-        if (!m_dragging)
-        {
-            hovered = Pnpoly(m_swap_regions.back().first, hx, hy) || Pnpoly(m_swap_regions.back().second, hx, hy);
-        }
-        else
-        {
-            hovered = m_selected_region == si;
-        }
-        dc.SetPen(wxPen(hovered ? wxColor(128, 128, 255) : *wxBLUE, (m_selected_region == si) ? 3 : 1));
-        dc.DrawPolygon(wxpoints.size(), wxpoints.data(), sp.first, sp.second);
-        dc.SetPen(wxPen(hovered ? wxColor(255, 128, 128) : *wxRED, (m_selected_region == si) ? 3 : 1));
-        dc.DrawPolygon(wxpoints.size(), wxpoints.data(), dp.first, dp.second);
-        ++si;
+        const bool is_hovered = std::find(hovered.cbegin(), hovered.cend(), si) != hovered.cend();
+        const auto& [src, dst] = m_swap_regions[si];
+        dc.SetPen(wxPen(is_hovered ? wxColor(128, 128, 255) : *wxBLUE, (m_selected_region == si) ? 3 : 1));
+        dc.DrawPolygon(src.size(), src.data());
+        dc.SetPen(wxPen(is_hovered ? wxColor(255, 128, 128) : *wxRED, (m_selected_region == si) ? 3 : 1));
+        dc.DrawPolygon(dst.size(), dst.data());
     }
 }
 
-void Map3DEditor::DrawDoors(wxDC& dc)
+void Map3DEditor::DrawDoors(wxDC& dc, const std::vector<int>& hovered)
 {
-    int di = 0x100;
-    m_door_regions.clear();
-    for (const auto& d : m_doors)
+    for (int i = 0; i < static_cast<int>(m_door_regions.size()); ++i)
     {
-        if (m_map_disp && d.x < m_map_disp->GetHeightmapWidth() && d.y < m_map_disp->GetHeightmapHeight())
+        const int di = 0x100 + i;
+        wxColor colour(255, 0, 255);
+        if (std::find(hovered.cbegin(), hovered.cend(), di) != hovered.cend())
         {
-            auto [valid, lines] = d.GetMapRegionPoly(m_map_disp, TILE_WIDTH, TILE_HEIGHT);
-            auto wxpoints = ToWxPoints(lines);
-            auto pos = GetScreenPosition(d.GetTileOffset(m_map_disp, m_layer));
-            auto [hx, hy] = GetScreenPosition(m_hovered);
-            m_door_regions.push_back(ToWxPoints(Landstalker::Door::OffsetRegionPoly(lines, pos)));
-            wxColor colour = valid ? wxColour(255, 0, 255) : wxColour(255, 0, 255);
-            if (Pnpoly(m_door_regions.back(), hx, hy))
-            {
-                colour = colour.ChangeLightness(150);
-            }
-            dc.SetPen(wxPen(colour, di == m_selected_region ? 3 : 1, wxPENSTYLE_SHORT_DASH));
-            dc.DrawPolygon(wxpoints.size(), wxpoints.data(), pos.first, pos.second);
-            ++di;
+            colour = colour.ChangeLightness(150);
         }
+        dc.SetPen(wxPen(colour, di == m_selected_region ? 3 : 1, wxPENSTYLE_SHORT_DASH));
+        dc.DrawPolygon(m_door_regions[i].size(), m_door_regions[i].data());
     }
 }
 
@@ -1150,9 +1548,7 @@ void Map3DEditor::OnDraw(wxDC& dc)
 {
     if (m_redraw)
     {
-        m_bmp->Create(m_width, m_height);
         DrawTiles();
-        m_redraw = false;
     }
     int sx, sy;
     GetViewStart(&sx, &sy);
@@ -1165,11 +1561,17 @@ void Map3DEditor::OnDraw(wxDC& dc)
     dc.SetBackground(wxBrush(wxSystemSettings::GetColour(wxSYS_COLOUR_APPWORKSPACE)));
     dc.Clear();
     dc.Blit(sx, sy, sw, sh, &mdc, sx, sy, wxCOPY);
-    dc.SetUserScale(m_zoom, m_zoom);
     mdc.SelectObject(wxNullBitmap);
-    DrawMap(dc);
-    DrawDoors(dc);
-    DrawTileSwaps(dc);
+    UpdateOverlay();
+    if (m_overlay_bmp->IsOk())
+    {
+        dc.DrawBitmap(*m_overlay_bmp, m_overlay_rect.GetPosition(), true);
+    }
+    dc.SetUserScale(m_zoom, m_zoom);
+    UpdateRegions();
+    m_painted_hover_regions = GetHoveredRegions();
+    DrawDoors(dc, m_painted_hover_regions);
+    DrawTileSwaps(dc, m_painted_hover_regions);
     if (m_hovered.first != -1 && m_hovered != m_selected)
     {
         DrawCell(dc, m_hovered, *wxWHITE_PEN, *wxTRANSPARENT_BRUSH);
@@ -1350,10 +1752,171 @@ bool Map3DEditor::UpdateSelectedPosition(int screenx, int screeny)
     return false;
 }
 
+void Map3DEditor::InvalidateRegions()
+{
+    m_regions_valid = false;
+    m_region_index_valid = false;
+}
+
+void Map3DEditor::UpdateRegions()
+{
+    if (m_regions_valid || !m_map)
+    {
+        return;
+    }
+    m_swap_regions.clear();
+    m_swap_bounds.clear();
+    for (const auto& s : m_swaps)
+    {
+        auto lines = s.GetMapRegionPoly(Landstalker::TileSwap::Region::UNDEFINED, TILE_WIDTH, TILE_HEIGHT);
+        auto sp = GetScreenPosition(s.GetTileOffset(Landstalker::TileSwap::Region::SOURCE, m_map, m_layer));
+        auto dp = GetScreenPosition(s.GetTileOffset(Landstalker::TileSwap::Region::DESTINATION, m_map, m_layer));
+        m_swap_regions.emplace_back(
+                ToWxPoints(Landstalker::TileSwap::OffsetRegionPoly(lines, sp)),
+                ToWxPoints(Landstalker::TileSwap::OffsetRegionPoly(lines, dp)));
+        m_swap_bounds.push_back(RegionIndex::GetBounds(m_swap_regions.back().first)
+            .Union(RegionIndex::GetBounds(m_swap_regions.back().second)));
+    }
+    m_door_regions.clear();
+    m_door_bounds.clear();
+    for (const auto& d : m_doors)
+    {
+        if (m_map_disp && d.x < m_map_disp->GetHeightmapWidth() && d.y < m_map_disp->GetHeightmapHeight())
+        {
+            auto lines = d.GetMapRegionPoly(m_map_disp, TILE_WIDTH, TILE_HEIGHT).second;
+            auto pos = GetScreenPosition(d.GetTileOffset(m_map_disp, m_layer));
+            m_door_regions.push_back(ToWxPoints(Landstalker::Door::OffsetRegionPoly(lines, pos)));
+            m_door_bounds.push_back(RegionIndex::GetBounds(m_door_regions.back()));
+        }
+    }
+    m_region_index_valid = false;
+    m_regions_valid = true;
+}
+
+void Map3DEditor::UpdateRegionIndex()
+{
+    UpdateRegions();
+    if (m_region_index_valid)
+    {
+        return;
+    }
+    m_door_index.Clear();
+    for (std::size_t i = 0; i < m_door_regions.size(); ++i)
+    {
+        m_door_index.Insert(i, m_door_regions[i]);
+    }
+    // Source and destination regions are interleaved so that candidates keep the scan order
+    m_swap_index.Clear();
+    for (std::size_t i = 0; i < m_swap_regions.size(); ++i)
+    {
+        m_swap_index.Insert(i * 2, m_swap_regions[i].first);
+        m_swap_index.Insert(i * 2 + 1, m_swap_regions[i].second);
+    }
+    m_region_index_valid = true;
+}
+
+std::vector<int> Map3DEditor::GetHoveredRegions()
+{
+    // Regions are identified as in m_selected_region: swaps from 0, doors from 0x100
+    std::vector<int> hovered;
+    if (m_dragging && IsSwapSelected())
+    {
+        hovered.push_back(m_selected_region);
+    }
+    if (!IsHoverValid())
+    {
+        return hovered;
+    }
+    auto [x, y] = GetScreenPosition(m_hovered);
+    UpdateRegionIndex();
+    if (!m_dragging)
+    {
+        for (int id : m_swap_index.GetCandidates(x, y))
+        {
+            const int i = id / 2;
+            const bool is_src = (id % 2) == 0;
+            if ((hovered.empty() || hovered.back() != i) &&
+                Pnpoly(is_src ? m_swap_regions[i].first : m_swap_regions[i].second, x, y))
+            {
+                hovered.push_back(i);
+            }
+        }
+    }
+    for (int i : m_door_index.GetCandidates(x, y))
+    {
+        if (Pnpoly(m_door_regions[i], x, y))
+        {
+            hovered.push_back(0x100 + i);
+        }
+    }
+    return hovered;
+}
+
+wxRect Map3DEditor::GetRegionBounds(int region) const
+{
+    if (region >= 0 && region < static_cast<int>(m_swap_bounds.size()))
+    {
+        return m_swap_bounds[region];
+    }
+    if (region >= 0x100 && region < static_cast<int>(0x100 + m_door_bounds.size()))
+    {
+        return m_door_bounds[region - 0x100];
+    }
+    return wxRect();
+}
+
+void Map3DEditor::RefreshHover(const Coord& prev_hovered)
+{
+    if (m_dragging || !m_regions_valid)
+    {
+        // The regions themselves are moving, so there is no telling what needs repainting
+        Refresh(false);
+        return;
+    }
+    for (const auto& cell : { prev_hovered, m_hovered })
+    {
+        if (IsCoordValid(cell))
+        {
+            auto [x, y] = GetScreenPosition(cell);
+            RefreshMapRect(wxRect(x, y, TILE_WIDTH + 1, TILE_HEIGHT + 1));
+        }
+    }
+    // Only regions whose highlight differs from what is on screen need to be repainted
+    const auto hovered = GetHoveredRegions();
+    for (int region : hovered)
+    {
+        if (std::find(m_painted_hover_regions.cbegin(), m_painted_hover_regions.cend(), region) == m_painted_hover_regions.cend())
+        {
+            RefreshMapRect(GetRegionBounds(region));
+        }
+    }
+    for (int region : m_painted_hover_regions)
+    {
+        if (std::find(hovered.cbegin(), hovered.cend(), region) == hovered.cend())
+        {
+            RefreshMapRect(GetRegionBounds(region));
+        }
+    }
+}
+
+void Map3DEditor::RefreshMapRect(const wxRect& rect)
+{
+    if (rect.IsEmpty())
+    {
+        return;
+    }
+    // Leave room for the widest outline pen either side of the edge
+    const wxRect scaled = ScaleRect(rect.x - 2, rect.y - 2, rect.width + 4, rect.height + 4);
+    int x, y;
+    CalcScrolledPosition(scaled.x, scaled.y, &x, &y);
+    RefreshRect(wxRect(x - 1, y - 1, scaled.width + 2, scaled.height + 2), false);
+}
+
 int Map3DEditor::GetFirstDoorRegion(const Coord& c)
 {
     auto [x, y] = GetScreenPosition(c);
-    for (std::size_t i = 0; i < m_door_regions.size(); ++i)
+    UpdateRegionIndex();
+    for (int i : m_door_index.GetCandidates(x, y))
     {
         if (Pnpoly(m_door_regions[i], x, y) == true)
         {
@@ -1366,15 +1929,14 @@ int Map3DEditor::GetFirstDoorRegion(const Coord& c)
 std::pair<int, bool> Map3DEditor::GetFirstSwapRegion(const Coord& c)
 {
     auto [x, y] = GetScreenPosition(c);
-    for (std::size_t i = 0; i < m_swap_regions.size(); ++i)
+    UpdateRegionIndex();
+    for (int id : m_swap_index.GetCandidates(x, y))
     {
-        if (Pnpoly(m_swap_regions[i].first, x, y) == true)
-        {
-            return { i, true };
-        }
-        if (Pnpoly(m_swap_regions[i].second, x, y) == true)
+        const int i = id / 2;
+        const bool is_src = (id % 2) == 0;
+        if (Pnpoly(is_src ? m_swap_regions[i].first : m_swap_regions[i].second, x, y) == true)
         {
-            return { i, false };
+            return { i, is_src };
         }
     }
     return {-1, false};
@@ -1507,6 +2069,7 @@ void Map3DEditor::StopDrag(bool cancel)
                 m_swaps[GetSelectedSwap() - 1].map.dst_x = m_dragged_orig_pos.first;
                 m_swaps[GetSelectedSwap() - 1].map.dst_y = m_dragged_orig_pos.second;
             }
+            InvalidateRegions();
         }
         Refresh();
         if (m_g)
@@ -1533,6 +2096,7 @@ void Map3DEditor::RefreshDrag()
             {
                 m_swaps[GetSelectedSwap() - 1].map.src_x = m_dragged_orig_pos.first + relmv.first;
                 m_swaps[GetSelectedSwap() - 1].map.src_y = m_dragged_orig_pos.second + relmv.second;
+                InvalidateRegions();
             }
         }
         else
@@ -1542,6 +2106,7 @@ void Map3DEditor::RefreshDrag()
             {
                 m_swaps[GetSelectedSwap() - 1].map.dst_x = m_dragged_orig_pos.first + relmv.first;
                 m_swaps[GetSelectedSwap() - 1].map.dst_y = m_dragged_orig_pos.second + relmv.second;
+                InvalidateRegions();
             }
         }
         if (m_g)
@@ -1554,6 +2119,8 @@ void Map3DEditor::RefreshDrag()
 
 void Map3DEditor::GeneratePreview()
 {
+    // Door outlines are taken from the display map's heightmap, which is about to be replaced
+    InvalidateRegions();
     if (IsSwapSelected())
     {
         *m_map_disp = *m_map;
@@ -1580,4 +2147,5 @@ void Map3DEditor::GeneratePreview()
 void Map3DEditor::ResetPreview()
 {
     *m_map_disp = *m_map;
+    InvalidateRegions();
 }
@@ -7,6 +7,8 @@
 #include <wx/wx.h>
 #include <wx/window.h>
 #include <landstalker/main/GameData.h>
+#include <rooms/RegionIndex.h>
+#include <blockset/BlockSummaryIndex.h>
 
 class RoomViewerFrame;
 class ImageBufferWx;
@@ -67,6 +69,8 @@ public:
 	void DeleteSelectedDoor();
 
 	void RefreshGraphics();
+	// Re-applies the palette to the existing rasters after its colours were edited
+	void RecolourPalette(const Landstalker::Palette* palette);
 	void UpdateSwaps();
 	void UpdateDoors();
 
@@ -81,18 +85,36 @@ public:
 private:
 
 	void SetHoveredTile();
+	void SetCellBlock(std::shared_ptr<Landstalker::Tilemap3D> map, const Coord& cell, uint16_t blk);
+	void BeginPaintStroke();
+	void EndPaintStroke();
 	void SelectHoveredTile();
 
 	void RefreshStatusbar();
 	void ForceRedraw();
 	void RecreateBuffer();
 	void UpdateScroll();
-	void DrawMap(wxDC& dc);
+	void UpdateOverlay();
+	void DrawOverlayCell(int x, int y, uint16_t blk);
+	void DrawOverlayBorder(int x, int y);
+	void FillOverlayRect(const wxRect& rect, const wxColour& colour, uint8_t alpha = 0xFF);
+	void DrawOverlayDashedRect(int x, int y, int width, int height, const wxColour& colour);
+	void DrawOverlayText(int x, int y, uint16_t blk);
+	wxRect ScaleRect(int x, int y, int width, int height) const;
+	bool IsBlockPriority(uint16_t blk);
+	const wxImage& GetHexGlyph(int digit);
 	void DrawTiles();
 	void DrawTile(int tile);
+	std::vector<std::pair<Landstalker::Tilemap3D::Layer, Coord>> GetDirtyCells() const;
+	void RasteriseAll();
+	void RecolourAll();
+	void RasteriseCells(const std::vector<std::pair<Landstalker::Tilemap3D::Layer, Coord>>& cells);
+	void RasteriseCell(Landstalker::Tilemap3D::Layer layer, const Coord& cell, wxImage& img);
+	void CompositeRect(const wxRect& rect);
+	wxRect GetCellRasterRect(Landstalker::Tilemap3D::Layer layer, const Coord& cell) const;
 	void DrawCell(wxDC& dc, const std::pair<int, int>& pos, const wxPen& pen, const wxBrush& brush);
-	void DrawTileSwaps(wxDC& dc);
-	void DrawDoors(wxDC& dc);
+	void DrawTileSwaps(wxDC& dc, const std::vector<int>& hovered);
+	void DrawDoors(wxDC& dc, const std::vector<int>& hovered);
 
 	void OnDraw(wxDC& dc);
 	void OnPaint(wxPaintEvent& evt);
@@ -119,6 +141,13 @@ private:
 	bool UpdateSelectedPosition(int screenx, int screeny);
 	int GetFirstDoorRegion(const Coord& c);
 	std::pair<int, bool> GetFirstSwapRegion(const Coord& c);
+	void InvalidateRegions();
+	void UpdateRegions();
+	void UpdateRegionIndex();
+	std::vector<int> GetHoveredRegions();
+	wxRect GetRegionBounds(int region) const;
+	void RefreshHover(const Coord& prev_hovered);
+	void RefreshMapRect(const wxRect& rect);
 
 	void RefreshCursor(bool ctrl_down);
 	void UpdateCursor(wxStockCursor cursor);
@@ -142,6 +171,13 @@ private:
 	mutable std::shared_ptr<Landstalker::Tilemap3D> m_map_disp;
 	std::unique_ptr<ImageBufferWx> m_layer_buf;
 	std::unique_ptr<ImageBufferWx> m_bg_buf;
+	std::unique_ptr<ImageBufferWx> m_cell_buf;
+	// Unscaled rasters of the edited layer, the BG ghost shown behind FG and their composite,
+	// along with the map they were last rasterised from
+	wxImage m_layer_img;
+	wxImage m_bg_img;
+	wxImage m_canvas;
+	std::shared_ptr<Landstalker::Tilemap3D> m_map_rastered;
 
 	std::shared_ptr<Landstalker::Tileset> m_tileset;
 	std::shared_ptr<Landstalker::Palette> m_pal;
@@ -153,6 +189,10 @@ private:
 	int m_width;
 	int m_height;
 	bool m_redraw;
+	bool m_redraw_all;
+	bool m_recolour;
+	// True while m_layer_buf and m_bg_buf hold exactly what was last converted
+	bool m_indexed_current;
 	bool m_repaint;
 	double m_zoom;
 	int m_selected_block;
@@ -161,16 +201,34 @@ private:
 	Coord m_dragged;
 	Coord m_dragged_orig_pos;
 	bool m_dragging;
+	bool m_painting;
 	int m_selected_region;
 	bool m_selected_is_src;
 	bool m_preview_swap;
 
 	std::vector<std::pair<std::vector<wxPoint>, std::vector<wxPoint>>> m_swap_regions;
 	std::vector<std::vector<wxPoint>> m_door_regions;
+	// Outlines are only rebuilt when a swap or door changes, not on every paint. The
+	// bounds let hover changes repaint just the regions whose highlight changed.
+	std::vector<wxRect> m_swap_bounds;
+	std::vector<wxRect> m_door_bounds;
+	std::vector<int> m_painted_hover_regions;
+	bool m_regions_valid;
+	RegionIndex m_swap_index;
+	RegionIndex m_door_index;
+	bool m_region_index_valid;
 
 	std::unique_ptr<wxBitmap> m_bmp;
 	std::unique_ptr<wxPen> m_priority_pen;
 
+	wxImage m_overlay;
+	std::unique_ptr<wxBitmap> m_overlay_bmp;
+	wxRect m_overlay_rect;
+	std::vector<int> m_overlay_blocks;
+	Landstalker::Blockset* m_overlay_blockset;
+	std::shared_ptr<BlockSummaryIndex> m_block_summary;
+	std::vector<wxImage> m_hex_glyphs;
+
 	std::vector<Landstalker::Door> m_doors;
 	std::vector<Landstalker::TileSwap> m_swaps;
 	std::vector<Landstalker::Door> m_preview_doors;
@@ -184,7 +242,10 @@ private:
 
 	static const std::size_t TILE_WIDTH = 32;
 	static const std::size_t TILE_HEIGHT = 32;
+	static const int PIXEL_SCALE = 2;
 	static const int SCROLL_RATE = 16;
+	static const int OVERLAY_MARGIN = 256;
+	static const int PRIORITY_DASH_LENGTH = 3;
 	int m_scroll_rate;
 
 	wxStockCursor m_cursorid;
@@ -0,0 +1,111 @@
+#include <rooms/RegionIndex.h>
+
+#include <algorithm>
+#include <cmath>
+
+RegionIndex::RegionIndex(int cell_size)
+    : m_cell_size(cell_size)
+{
+}
+
+void RegionIndex::Clear()
+{
+    m_regions.clear();
+    m_cells.clear();
+}
+
+bool RegionIndex::IsEmpty() const
+{
+    return m_regions.empty();
+}
+
+void RegionIndex::Insert(int id, const wxRect& bounds)
+{
+    if (bounds.IsEmpty())
+    {
+        return;
+    }
+    const std::size_t idx = m_regions.size();
+    m_regions.push_back({ id, bounds });
+    for (int cy = GetCell(bounds.GetTop()); cy <= GetCell(bounds.GetBottom()); ++cy)
+    {
+        for (int cx = GetCell(bounds.GetLeft()); cx <= GetCell(bounds.GetRight()); ++cx)
+        {
+            m_cells[GetCellKey(cx, cy)].push_back(idx);
+        }
+    }
+}
+
+void RegionIndex::Insert(int id, const std::vector<wxPoint>& poly)
+{
+    Insert(id, GetBounds(poly));
+}
+
+void RegionIndex::Insert(int id, const std::vector<wxPoint2DDouble>& poly)
+{
+    if (poly.empty())
+    {
+        return;
+    }
+    double left = poly.front().m_x;
+    double right = left;
+    double top = poly.front().m_y;
+    double bottom = top;
+    for (const auto& p : poly)
+    {
+        left = std::min(left, p.m_x);
+        right = std::max(right, p.m_x);
+        top = std::min(top, p.m_y);
+        bottom = std::max(bottom, p.m_y);
+    }
+    Insert(id, wxRect(wxPoint(std::floor(left), std::floor(top)), wxPoint(std::ceil(right), std::ceil(bottom))));
+}
+
+std::vector<int> RegionIndex::GetCandidates(int x, int y) const
+{
+    std::vector<int> ids;
+    auto it = m_cells.find(GetCellKey(GetCell(x), GetCell(y)));
+    if (it != m_cells.cend())
+    {
+        // Cell lists are filled in insertion order, so the ids come out in that order too
+        for (std::size_t idx : it->second)
+        {
+            if (m_regions[idx].bounds.Contains(x, y))
+            {
+                ids.push_back(m_regions[idx].id);
+            }
+        }
+    }
+    return ids;
+}
+
+wxRect RegionIndex::GetBounds(const std::vector<wxPoint>& poly)
+{
+    if (poly.empty())
+    {
+        return wxRect();
+    }
+    int left = poly.front().x;
+    int right = left;
+    int top = poly.front().y;
+    int bottom = top;
+    for (const auto& p : poly)
+    {
+        left = std::min(left, p.x);
+        right = std::max(right, p.x);
+        top = std::min(top, p.y);
+        bottom = std::max(bottom, p.y);
+    }
+    return wxRect(wxPoint(left, top), wxPoint(right, bottom));
+}
+
+int64_t RegionIndex::GetCellKey(int cx, int cy) const
+{
+    return (static_cast<int64_t>(cy) << 32) | static_cast<uint32_t>(cx);
+}
+
+int RegionIndex::GetCell(int v) const
+{
+    // Round towards negative infinity so that negative coordinates get their own cells
+    return (v >= 0) ? v / m_cell_size : -((-v + m_cell_size - 1) / m_cell_size);
+}
@@ -0,0 +1,44 @@
+#ifndef _REGION_INDEX_H_
+#define _REGION_INDEX_H_
+
+#include <wx/wx.h>
+#include <wx/geometry.h>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid over the bounding boxes of a set of clickable regions. Lookups return only
+// the regions whose bounds contain the point, leaving the exact point-in-polygon test to
+// the caller.
+class RegionIndex
+{
+public:
+	RegionIndex(int cell_size = DEFAULT_CELL_SIZE);
+
+	void Clear();
+	bool IsEmpty() const;
+	void Insert(int id, const wxRect& bounds);
+	void Insert(int id, const std::vector<wxPoint>& poly);
+	void Insert(int id, const std::vector<wxPoint2DDouble>& poly);
+	// Returns the ids of all regions whose bounds contain (x, y), in insertion order
+	std::vector<int> GetCandidates(int x, int y) const;
+
+	static wxRect GetBounds(const std::vector<wxPoint>& poly);
+
+	static const int DEFAULT_CELL_SIZE = 64;
+private:
+	struct Region
+	{
+		int id;
+		wxRect bounds;
+	};
+
+	int64_t GetCellKey(int cx, int cy) const;
+	int GetCell(int v) const;
+
+	int m_cell_size;
+	std::vector<Region> m_regions;
+	std::unordered_map<int64_t, std::vector<std::size_t>> m_cells;
+};
+
+#endif // _REGION_INDEX_H_
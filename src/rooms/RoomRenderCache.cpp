@@ -0,0 +1,219 @@
+#include <rooms/RoomRenderCache.h>
+
+#include <main/ImageBufferWx.h>
+
+wxDEFINE_EVENT(EVT_ROOM_PREFETCH_COMPLETE, wxThreadEvent);
+
+using namespace Landstalker;
+
+std::size_t RoomRenderCache::Raster::GetSize() const
+{
+    const std::size_t pixels = image.IsOk() ? image.GetWidth() * image.GetHeight() : 0;
+    // The indexed buffer holds its indices and priorities along with its own RGB and alpha conversion,
+    // plus the copies of the last conversion that MakeImage keeps
+    const std::size_t indexed_pixels = indexed ? indexed->GetWidth() * indexed->GetHeight() : 0;
+    const std::size_t memo = indexed ? indexed->GetMemoSize() : 0;
+    return pixels * (image.IsOk() && image.HasAlpha() ? 4 : 3) + priority_alpha.size() + indexed_pixels * 6 + memo;
+}
+
+void RoomRenderCache::Raster::Recolour(const std::vector<std::shared_ptr<Palette>>& palette)
+{
+    if (!indexed)
+    {
+        return;
+    }
+    image = indexed->MakeImage(palette, true).Copy();
+    const auto& alpha = indexed->GetAlpha(palette, 0x00, 0xFF);
+    priority_alpha.assign(alpha.cbegin(), alpha.cend());
+}
+
+RoomRenderCache::RoomRenderCache(std::size_t max_bytes)
+    : m_bytes(0),
+      m_max_bytes(max_bytes),
+      m_generation(0),
+      m_cancelled(std::make_shared<std::atomic<bool>>(false))
+{
+    Bind(EVT_ROOM_PREFETCH_COMPLETE, &RoomRenderCache::OnPrefetchComplete, this);
+}
+
+RoomRenderCache::~RoomRenderCache()
+{
+    CancelPrefetch();
+    // Destroying the futures waits for the workers to finish
+    m_tasks.clear();
+}
+
+std::shared_ptr<RoomRenderCache::Raster> RoomRenderCache::Find(const Key& key)
+{
+    auto it = m_entries.find(key);
+    if (it == m_entries.end())
+    {
+        return nullptr;
+    }
+    m_lru.splice(m_lru.begin(), m_lru, it->second.lru);
+    return it->second.raster;
+}
+
+bool RoomRenderCache::Contains(const Key& key) const
+{
+    return m_entries.find(key) != m_entries.cend();
+}
+
+void RoomRenderCache::Insert(const Key& key, std::shared_ptr<Raster> raster)
+{
+    auto it = m_entries.find(key);
+    if (it != m_entries.end())
+    {
+        Erase(it);
+    }
+    m_lru.push_front(key);
+    const std::size_t bytes = raster->GetSize();
+    m_bytes += bytes;
+    m_entries.emplace(key, Entry{ std::move(raster), m_lru.begin(), bytes });
+    Evict();
+}
+
+void RoomRenderCache::Clear()
+{
+    // Anything still being rendered was built from data that may now be stale
+    CancelPrefetch();
+    ++m_generation;
+    m_entries.clear();
+    m_lru.clear();
+    m_bytes = 0;
+}
+
+void RoomRenderCache::ClearPreviews()
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        if (!it->first.preview_swaps.empty() || !it->first.preview_doors.empty())
+        {
+            Erase(it++);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void RoomRenderCache::Recolour(std::shared_ptr<GameData> gd, const Palette* palette)
+{
+    // Prefetched rooms were copied with the old colours, so any still in flight are dropped
+    CancelPrefetch();
+    ++m_generation;
+    for (auto& [key, entry] : m_entries)
+    {
+        const auto room_palette = gd->GetRoomData()->GetPaletteForRoom(key.roomnum)->GetData();
+        if (palette == nullptr || room_palette.get() == palette)
+        {
+            entry.raster->Recolour({ std::make_shared<Palette>(*room_palette) });
+            // Recolouring can change the size of the conversion the indexed buffer keeps
+            m_bytes -= entry.bytes;
+            entry.bytes = entry.raster->GetSize();
+            m_bytes += entry.bytes;
+        }
+    }
+    Evict();
+}
+
+RoomRenderCache::RoomSources RoomRenderCache::GetRoomSources(std::shared_ptr<GameData> gd, uint16_t roomnum)
+{
+    RoomSources sources;
+    sources.roomnum = roomnum;
+    sources.map = std::make_shared<Tilemap3D>(*gd->GetRoomData()->GetMapForRoom(roomnum)->GetData());
+    sources.tileset = std::make_shared<Tileset>(*gd->GetRoomData()->GetTilesetForRoom(roomnum)->GetData());
+    sources.blockset = std::make_shared<Blockset>(*gd->GetRoomData()->GetCombinedBlocksetForRoom(roomnum));
+    // Map layers are only ever drawn with the room palette
+    sources.palette = { std::make_shared<Palette>(*gd->GetRoomData()->GetPaletteForRoom(roomnum)->GetData()) };
+    return sources;
+}
+
+std::shared_ptr<RoomRenderCache::Raster> RoomRenderCache::Render(const RoomSources& sources, Tilemap3D::Layer layer)
+{
+    auto buf = std::make_shared<ImageBufferWx>(sources.map->GetPixelWidth(), sources.map->GetPixelHeight());
+    buf->Insert3DMapLayer(0, 0, 0, layer, sources.map, sources.tileset, sources.blockset);
+    return MakeRaster(buf, sources.palette);
+}
+
+std::shared_ptr<RoomRenderCache::Raster> RoomRenderCache::Render(const RoomSources& sources, Tilemap3D::Layer layer,
+    std::vector<TileSwap> swaps, std::vector<Door> doors)
+{
+    auto buf = std::make_shared<ImageBufferWx>(sources.map->GetPixelWidth(), sources.map->GetPixelHeight());
+    buf->Insert3DMapLayer(0, 0, 0, layer, sources.map, sources.tileset, sources.blockset, true, swaps, doors);
+    return MakeRaster(buf, sources.palette);
+}
+
+void RoomRenderCache::Prefetch(std::vector<RoomSources> rooms)
+{
+    CancelPrefetch();
+    m_tasks.remove_if([](const auto& task)
+        {
+            return task.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        });
+    if (rooms.empty())
+    {
+        return;
+    }
+    m_cancelled = std::make_shared<std::atomic<bool>>(false);
+    m_tasks.push_back(std::async(std::launch::async, &RoomRenderCache::PrefetchWorker, this,
+        std::move(rooms), m_cancelled, m_generation));
+}
+
+void RoomRenderCache::CancelPrefetch()
+{
+    *m_cancelled = true;
+}
+
+std::shared_ptr<RoomRenderCache::Raster> RoomRenderCache::MakeRaster(std::shared_ptr<ImageBufferWx> buf, const std::vector<std::shared_ptr<Palette>>& palette)
+{
+    // Rasterise at full opacity, keeping the high priority alpha so that layer opacity
+    // can be applied later without touching the tilemap again
+    auto raster = std::make_shared<Raster>();
+    raster->indexed = std::move(buf);
+    raster->Recolour(palette);
+    return raster;
+}
+
+void RoomRenderCache::PrefetchWorker(std::vector<RoomSources> rooms, std::shared_ptr<std::atomic<bool>> cancelled, unsigned int generation)
+{
+    for (const auto& room : rooms)
+    {
+        for (auto layer : { Tilemap3D::Layer::BG, Tilemap3D::Layer::FG })
+        {
+            if (*cancelled)
+            {
+                return;
+            }
+            auto* evt = new wxThreadEvent(EVT_ROOM_PREFETCH_COMPLETE);
+            evt->SetPayload(PrefetchResult{ Key{ room.roomnum, layer, false, {}, {} }, Render(room, layer), generation });
+            wxQueueEvent(this, evt);
+        }
+    }
+}
+
+void RoomRenderCache::Erase(std::map<Key, Entry>::iterator it)
+{
+    m_bytes -= it->second.bytes;
+    m_lru.erase(it->second.lru);
+    m_entries.erase(it);
+}
+
+void RoomRenderCache::Evict()
+{
+    // Always keep the most recently used entry, however large it is
+    while (m_bytes > m_max_bytes && m_lru.size() > 1)
+    {
+        Erase(m_entries.find(m_lru.back()));
+    }
+}
+
+void RoomRenderCache::OnPrefetchComplete(wxThreadEvent& evt)
+{
+    auto result = evt.GetPayload<PrefetchResult>();
+    if (result.generation == m_generation && !Contains(result.key))
+    {
+        Insert(result.key, result.raster);
+    }
+}
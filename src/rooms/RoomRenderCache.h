@@ -0,0 +1,109 @@
+#ifndef _ROOM_RENDER_CACHE_H_
+#define _ROOM_RENDER_CACHE_H_
+
+#include <wx/wx.h>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <list>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+#include <landstalker/main/GameData.h>
+
+class ImageBufferWx;
+
+class RoomRenderCache : public wxEvtHandler
+{
+public:
+	struct Raster
+	{
+		wxImage image;
+		std::vector<uint8_t> priority_alpha;
+		// The indexed pixels the image was converted from, kept so that a palette edit
+		// only has to redo the conversion
+		std::shared_ptr<ImageBufferWx> indexed;
+
+		std::size_t GetSize() const;
+		void Recolour(const std::vector<std::shared_ptr<Landstalker::Palette>>& palette);
+	};
+	struct Key
+	{
+		uint16_t roomnum;
+		Landstalker::Tilemap3D::Layer layer;
+		bool previews;
+		std::vector<int> preview_swaps;
+		std::vector<int> preview_doors;
+
+		bool operator<(const Key& rhs) const
+		{
+			return std::tie(roomnum, layer, previews, preview_swaps, preview_doors) <
+				std::tie(rhs.roomnum, rhs.layer, rhs.previews, rhs.preview_swaps, rhs.preview_doors);
+		}
+	};
+	// Private copies of everything needed to rasterise a room's map layers, so that
+	// rendering can happen away from the UI thread
+	struct RoomSources
+	{
+		uint16_t roomnum;
+		std::shared_ptr<Landstalker::Tilemap3D> map;
+		std::shared_ptr<Landstalker::Tileset> tileset;
+		std::shared_ptr<Landstalker::Blockset> blockset;
+		std::vector<std::shared_ptr<Landstalker::Palette>> palette;
+	};
+
+	RoomRenderCache(std::size_t max_bytes = DEFAULT_MAX_BYTES);
+	virtual ~RoomRenderCache();
+
+	std::shared_ptr<Raster> Find(const Key& key);
+	bool Contains(const Key& key) const;
+	void Insert(const Key& key, std::shared_ptr<Raster> raster);
+	void Clear();
+	void ClearPreviews();
+	// Converts the cached layers of every room drawn with the given palette (or all rooms,
+	// if it is null) again with its current colours
+	void Recolour(std::shared_ptr<Landstalker::GameData> gd, const Landstalker::Palette* palette);
+
+	static RoomSources GetRoomSources(std::shared_ptr<Landstalker::GameData> gd, uint16_t roomnum);
+	static std::shared_ptr<Raster> Render(const RoomSources& sources, Landstalker::Tilemap3D::Layer layer);
+	static std::shared_ptr<Raster> Render(const RoomSources& sources, Landstalker::Tilemap3D::Layer layer,
+		std::vector<Landstalker::TileSwap> swaps, std::vector<Landstalker::Door> doors);
+
+	// Rasterises the map layers of the given rooms on a worker thread. Any prefetch
+	// already in progress is abandoned.
+	void Prefetch(std::vector<RoomSources> rooms);
+	void CancelPrefetch();
+
+	static const std::size_t DEFAULT_MAX_BYTES = 192 * 1024 * 1024;
+private:
+	struct Entry
+	{
+		std::shared_ptr<Raster> raster;
+		std::list<Key>::iterator lru;
+		// Size when inserted or last recoloured, so that m_bytes stays consistent
+		std::size_t bytes;
+	};
+	struct PrefetchResult
+	{
+		Key key;
+		std::shared_ptr<Raster> raster;
+		unsigned int generation;
+	};
+
+	static std::shared_ptr<Raster> MakeRaster(std::shared_ptr<ImageBufferWx> buf, const std::vector<std::shared_ptr<Landstalker::Palette>>& palette);
+	void PrefetchWorker(std::vector<RoomSources> rooms, std::shared_ptr<std::atomic<bool>> cancelled, unsigned int generation);
+	void Erase(std::map<Key, Entry>::iterator it);
+	void Evict();
+	void OnPrefetchComplete(wxThreadEvent& evt);
+
+	std::map<Key, Entry> m_entries;
+	std::list<Key> m_lru;
+	std::size_t m_bytes;
+	std::size_t m_max_bytes;
+	unsigned int m_generation;
+	std::list<std::future<void>> m_tasks;
+	std::shared_ptr<std::atomic<bool>> m_cancelled;
+};
+
+#endif // _ROOM_RENDER_CACHE_H_
@@ -2,9 +2,13 @@
 
 #include <wx/dcbuffer.h>
 #include <wx/graphics.h>
+#include <algorithm>
+#include <cstdlib>
 #include <unordered_map>
 
+#include <main/AlphaBlend.h>
 #include <main/EditorFrame.h>
+#include <main/UndoJournal.h>
 #include <rooms/EntityPropertiesWindow.h>
 #include <rooms/WarpPropertyWindow.h>
 
@@ -25,6 +29,12 @@ wxEND_EVENT_TABLE()
 
 using namespace Landstalker;
 
+static const std::array<std::pair<RoomViewerCtrl::Layer, Tilemap3D::Layer>, 3> MAP_LAYERS = { {
+    {RoomViewerCtrl::Layer::BACKGROUND1, Tilemap3D::Layer::BG},
+    {RoomViewerCtrl::Layer::BACKGROUND2, Tilemap3D::Layer::FG},
+    {RoomViewerCtrl::Layer::FOREGROUND,  Tilemap3D::Layer::FG}
+} };
+
 RoomViewerCtrl::RoomViewerCtrl(wxWindow* parent, RoomViewerFrame* frame)
 	: wxScrolledCanvas(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxDEFAULT_FRAME_STYLE | wxWANTS_CHARS),
       m_g(nullptr),
@@ -43,7 +53,13 @@ RoomViewerCtrl::RoomViewerCtrl(wxWindow* parent, RoomViewerFrame* frame)
       m_show_swaps(true),
       m_show_entity_hitboxes(true),
       m_is_warp_pending(false),
+      m_layer_cache(std::make_unique<RoomRenderCache>()),
+      m_map_previews(false),
+      m_hm_atlas_zoom(0.0),
       m_bmp(std::make_unique<wxBitmap>()),
+      m_tiles_wide(0),
+      m_tiles_high(0),
+      m_hit_index_valid(false),
       m_scroll_rate(SCROLL_RATE),
       m_selected(NO_SELECTION),
       m_hovered(NO_SELECTION)
@@ -54,15 +70,6 @@ RoomViewerCtrl::RoomViewerCtrl(wxWindow* parent, RoomViewerFrame* frame)
     m_warp_brush = std::make_unique<wxBrush>(*wxRED, wxBRUSHSTYLE_BDIAGONAL_HATCH);
     m_layer_opacity = { {Layer::BACKGROUND1, 0xFF}, {Layer::BACKGROUND2, 0xFF}, {Layer::BG_SPRITES, 0xFF },
                         {Layer::FOREGROUND, 0xFF}, {Layer::FG_SPRITES, 0xFF}, {Layer::HEIGHTMAP, 0x80} };
-    m_layer_bufs = { {Layer::BACKGROUND1, std::make_unique<ImageBufferWx>()}, {Layer::BACKGROUND2, std::make_unique<ImageBufferWx>()},
-                     {Layer::BG_SPRITES,  std::make_unique<ImageBufferWx>()}, {Layer::FOREGROUND,  std::make_unique<ImageBufferWx>()},
-                     {Layer::FG_SPRITES,  std::make_unique<ImageBufferWx>()} };
-    m_layers = { {Layer::BACKGROUND1, std::make_unique<wxBitmap>()},              {Layer::BACKGROUND2, std::make_unique<wxBitmap>()},
-                 {Layer::BG_SPRITES_WIREFRAME_BG, std::make_unique<wxBitmap>()},  {Layer::BG_SPRITES,  std::make_unique<wxBitmap>()},
-                 {Layer::BG_SPRITES_WIREFRAME_FG, std::make_unique<wxBitmap>()},  {Layer::FOREGROUND,  std::make_unique<wxBitmap>()},
-                 {Layer::SWAPS, std::make_unique<wxBitmap>()},                    {Layer::HEIGHTMAP, std::make_unique<wxBitmap>()},
-                 {Layer::FG_SPRITES_WIREFRAME_BG, std::make_unique<wxBitmap>()},  {Layer::FG_SPRITES, std::make_unique<wxBitmap>()},
-                 {Layer::FG_SPRITES_WIREFRAME_FG,  std::make_unique<wxBitmap>()}, {Layer::WARPS, std::make_unique<wxBitmap>()} };
 }
 
 RoomViewerCtrl::~RoomViewerCtrl()
@@ -72,12 +79,14 @@ RoomViewerCtrl::~RoomViewerCtrl()
 void RoomViewerCtrl::SetGameData(std::shared_ptr<Landstalker::GameData> gd)
 {
 	m_g = gd;
+	InvalidateLayerCache();
 	Refresh(true);
 }
 
 void RoomViewerCtrl::ClearGameData()
 {
 	m_g = nullptr;
+	InvalidateLayerCache();
 	Refresh(true);
 }
 
@@ -107,6 +116,11 @@ void RoomViewerCtrl::SetRoomNum(uint16_t roomnum)
         FireEvent(EVT_ENTITY_UPDATE);
         FireEvent(EVT_WARP_UPDATE);
     }
+    if (!m_frame->IsShown())
+    {
+        // Room graphics can only have been edited in other editors while this one was hidden
+        InvalidateLayerCache();
+    }
     UpdateRoomDescText(m_roomnum);
     RefreshGraphics();
 }
@@ -324,7 +338,37 @@ void RoomViewerCtrl::SetZoom(double zoom)
 void RoomViewerCtrl::SetLayerOpacity(Layer layer, uint8_t opacity)
 {
     assert(m_layer_opacity.find(layer) != m_layer_opacity.cend());
+    if (m_layer_opacity[layer] == opacity)
+    {
+        return;
+    }
     m_layer_opacity[layer] = opacity;
+    if (m_g == nullptr)
+    {
+        return;
+    }
+    if (opacity > 0 && m_layer_rasters.find(layer) == m_layer_rasters.cend())
+    {
+        // Layer was hidden when the room was last drawn, so it has not been rasterised yet
+        switch (layer)
+        {
+        case Layer::BG_SPRITES:
+        case Layer::FG_SPRITES:
+            RedrawAllSprites();
+            break;
+        case Layer::HEIGHTMAP:
+            UpdateHeightmapLayer(m_g->GetRoomData()->GetMapForRoom(m_roomnum)->GetData());
+            break;
+        default:
+            UpdateMapLayers(m_map_previews);
+            break;
+        }
+    }
+    else
+    {
+        ApplyLayerOpacity(layer);
+    }
+    ForceRedraw();
 }
 
 uint8_t RoomViewerCtrl::GetLayerOpacity(Layer layer) const
@@ -346,9 +390,6 @@ void RoomViewerCtrl::DrawRoom(uint16_t roomnum)
         return;
     }
     auto map = m_g->GetRoomData()->GetMapForRoom(roomnum)->GetData();
-    auto blocksets = m_g->GetRoomData()->GetBlocksetsForRoom(roomnum);
-    auto tileset = m_g->GetRoomData()->GetTilesetForRoom(roomnum)->GetData();
-    auto blockset = m_g->GetRoomData()->GetCombinedBlocksetForRoom(roomnum);
     m_swaps = m_g->GetRoomData()->GetTileSwaps(roomnum);
     m_doors = m_g->GetRoomData()->GetDoors(roomnum);
     m_rpalette = PreparePalettes(roomnum);
@@ -356,38 +397,27 @@ void RoomViewerCtrl::DrawRoom(uint16_t roomnum)
     m_warp_poly.clear();
     m_link_poly.clear();
     m_entity_poly.clear();
+    m_hit_index_valid = false;
     m_layers.clear();
     m_preview_swaps.clear();
     m_preview_doors.clear();
+    m_layer_rasters.clear();
+    m_hm_cells.clear();
     m_width = map->GetPixelWidth();
     m_height = map->GetPixelHeight();
     UpdateBuffer();
 
-    if (m_layer_opacity[Layer::BACKGROUND1] > 0)
-    {
-        m_layer_bufs[Layer::BACKGROUND1]->Resize(m_width, m_height);
-        m_layer_bufs[Layer::BACKGROUND1]->Insert3DMapLayer(0, 0, 0, Tilemap3D::Layer::BG, map, tileset, blockset);
-        UpdateLayer(Layer::BACKGROUND1, m_layer_bufs[Layer::BACKGROUND1]->MakeImage(
-            m_rpalette, true, m_layer_opacity[Layer::BACKGROUND1]));
-    }
-    if (m_layer_opacity[Layer::BACKGROUND2] > 0)
-    {
-        m_layer_bufs[Layer::BACKGROUND2]->Resize(m_width, m_height);
-        m_layer_bufs[Layer::BACKGROUND2]->Insert3DMapLayer(0, 0, 0, Tilemap3D::Layer::FG, map, tileset, blockset);
-        UpdateLayer(Layer::BACKGROUND2, m_layer_bufs[Layer::BACKGROUND2]->MakeImage(
-            m_rpalette, true, m_layer_opacity[Layer::BACKGROUND2]));
-    }
-    if (m_layer_opacity[Layer::FOREGROUND] > 0)
-    {
-        m_layer_bufs[Layer::FOREGROUND]->Resize(m_width, m_height);
-        m_layer_bufs[Layer::FOREGROUND]->Insert3DMapLayer(0, 0, 0, Tilemap3D::Layer::FG, map, tileset, blockset);
-        UpdateLayer(Layer::FOREGROUND, m_layer_bufs[Layer::FOREGROUND]->MakeImage(
-            m_rpalette, true, m_layer_opacity[Layer::FOREGROUND]));
-    }
-    if (m_layer_opacity[Layer::HEIGHTMAP] > 0)
+    // Tile and sprite layers only need an image buffer, so they are rasterised on worker
+    // threads while the overlays, which need a graphics context, are drawn here
+    auto map_layers = RenderMapLayersAsync(false);
+    std::future<LayerRasters> sprite_layers;
+    if (m_show_entities || m_show_entity_hitboxes)
     {
-        UpdateLayer(Layer::HEIGHTMAP, DrawHeightmapVisualisation(map, m_layer_opacity[Layer::HEIGHTMAP]));
+        PrepareAllSprites();
+        sprite_layers = std::async(std::launch::async, &RoomViewerCtrl::RasteriseSprites,
+            m_sprite_q, m_rpalette, m_width, m_height, GetVisibleSpriteLayers());
     }
+    UpdateHeightmapLayer(map);
     if (m_show_swaps)
     {
         UpdateLayer(Layer::SWAPS, DrawRoomSwaps(m_roomnum));
@@ -396,14 +426,16 @@ void RoomViewerCtrl::DrawRoom(uint16_t roomnum)
     {
         UpdateLayer(Layer::WARPS, DrawRoomWarps(m_roomnum));
     }
-    if (m_show_entities || m_show_entity_hitboxes)
+    UpdateMapLayers(std::move(map_layers));
+    if (sprite_layers.valid())
     {
-        RedrawAllSprites();
+        UpdateSpriteLayers(sprite_layers.get());
     }
     auto mp = wxGetMousePosition();
     std::wstring s;
     CheckMousePosForLink({ mp.x, mp.y }, s);
     SetCursor(m_selected == NO_SELECTION ? wxCURSOR_ARROW : wxCURSOR_HAND);
+    PrefetchAdjacentRooms();
 }
 
 void RoomViewerCtrl::RefreshRoom(bool redraw_tiles)
@@ -417,40 +449,9 @@ void RoomViewerCtrl::RefreshRoom(bool redraw_tiles)
     auto q = PrepareSprites(m_roomnum);
     if (redraw_tiles)
     {
-        auto blocksets = m_g->GetRoomData()->GetBlocksetsForRoom(m_roomnum);
-        auto tileset = m_g->GetRoomData()->GetTilesetForRoom(m_roomnum)->GetData();
-        auto blockset = m_g->GetRoomData()->GetCombinedBlocksetForRoom(m_roomnum);
-        auto pswaps = GetPreviewSwaps();
-        auto pdoors = GetPreviewDoors();
-        if (m_layer_opacity[Layer::BACKGROUND1] > 0)
-        {
-            m_layer_bufs[Layer::BACKGROUND1]->Resize(m_width, m_height);
-            m_layer_bufs[Layer::BACKGROUND1]->Insert3DMapLayer(0, 0, 0, Tilemap3D::Layer::BG, map, tileset, blockset, true,
-                                                               pswaps, pdoors);
-            UpdateLayer(Layer::BACKGROUND1, m_layer_bufs[Layer::BACKGROUND1]->MakeImage(
-                m_rpalette, true, m_layer_opacity[Layer::BACKGROUND1]));
-        }
-        if (m_layer_opacity[Layer::BACKGROUND2] > 0)
-        {
-            m_layer_bufs[Layer::BACKGROUND2]->Resize(m_width, m_height);
-            m_layer_bufs[Layer::BACKGROUND2]->Insert3DMapLayer(0, 0, 0, Tilemap3D::Layer::FG, map, tileset, blockset, true,
-                                                               pswaps, pdoors);
-            UpdateLayer(Layer::BACKGROUND2, m_layer_bufs[Layer::BACKGROUND2]->MakeImage(
-                m_rpalette, true, m_layer_opacity[Layer::BACKGROUND2]));
-        }
-        if (m_layer_opacity[Layer::FOREGROUND] > 0)
-        {
-            m_layer_bufs[Layer::FOREGROUND]->Resize(m_width, m_height);
-            m_layer_bufs[Layer::FOREGROUND]->Insert3DMapLayer(0, 0, 0, Tilemap3D::Layer::FG, map, tileset, blockset, true,
-                                                              pswaps, pdoors);
-            UpdateLayer(Layer::FOREGROUND, m_layer_bufs[Layer::FOREGROUND]->MakeImage(
-                m_rpalette, true, m_layer_opacity[Layer::FOREGROUND]));
-        }
-    }
-    if (m_layer_opacity[Layer::HEIGHTMAP] > 0)
-    {
-        m_layers[Layer::HEIGHTMAP] = DrawHeightmapVisualisation(map, m_layer_opacity[Layer::HEIGHTMAP]);
+        UpdateMapLayers(true);
     }
+    UpdateHeightmapLayer(map);
     if (m_show_warps)
     {
         m_layers[Layer::WARPS] = DrawRoomWarps(m_roomnum);
@@ -465,52 +466,357 @@ void RoomViewerCtrl::RefreshRoom(bool redraw_tiles)
 }
 
 void RoomViewerCtrl::RedrawAllSprites()
+{
+    PrepareAllSprites();
+    UpdateSpriteLayers(RasteriseSprites(m_sprite_q, m_rpalette, m_width, m_height, GetVisibleSpriteLayers()));
+}
+
+void RoomViewerCtrl::PrepareAllSprites()
 {
     m_rpalette = PreparePalettes(m_roomnum);
-    auto q = PrepareSprites(m_roomnum);
-    m_entity_poly.clear();
+    m_sprite_q = PrepareSprites(m_roomnum);
+}
+
+std::vector<RoomViewerCtrl::Layer> RoomViewerCtrl::GetVisibleSpriteLayers() const
+{
+    std::vector<Layer> layers;
     if (m_show_entities)
     {
-        m_layer_bufs[Layer::FG_SPRITES]->Resize(m_width, m_height);
-        m_layer_bufs[Layer::BG_SPRITES]->Resize(m_width, m_height);
-        DrawSprites(q);
-        if (m_layer_opacity[Layer::BG_SPRITES] > 0)
+        for (const auto& layer : { Layer::BG_SPRITES, Layer::FG_SPRITES })
         {
-            UpdateLayer(Layer::BG_SPRITES, m_layer_bufs[Layer::BG_SPRITES]->MakeImage(m_rpalette,
-                true, m_layer_opacity[Layer::BG_SPRITES], m_layer_opacity[Layer::BG_SPRITES]));
+            if (m_layer_opacity.find(layer)->second > 0)
+            {
+                layers.push_back(layer);
+            }
         }
-        if (m_layer_opacity[Layer::FG_SPRITES] > 0)
+    }
+    return layers;
+}
+
+RoomViewerCtrl::LayerRasters RoomViewerCtrl::RasteriseSprites(std::vector<SpriteQ> q, std::vector<std::shared_ptr<Palette>> palette,
+    int width, int height, std::vector<Layer> layers)
+{
+    // Only touches its arguments, so that it can run on a worker thread
+    LayerRasters rasters;
+    if (layers.empty())
+    {
+        return rasters;
+    }
+    ImageBufferWx bg_buf(width, height);
+    ImageBufferWx fg_buf(width, height);
+    DrawSprites(q, bg_buf, fg_buf);
+    for (const auto& layer : layers)
+    {
+        const ImageBufferWx& buf = (layer == Layer::BG_SPRITES) ? bg_buf : fg_buf;
+        rasters[layer] = std::make_shared<LayerRaster>(LayerRaster{ buf.MakeImage(palette, true).Copy(), {} });
+    }
+    return rasters;
+}
+
+void RoomViewerCtrl::UpdateSpriteLayers(LayerRasters rasters)
+{
+    m_entity_poly.clear();
+    m_hit_index_valid = false;
+    if (m_show_entities)
+    {
+        for (const auto& layer : { Layer::BG_SPRITES, Layer::FG_SPRITES })
         {
-            UpdateLayer(Layer::FG_SPRITES, m_layer_bufs[Layer::FG_SPRITES]->MakeImage(m_rpalette,
-                true, m_layer_opacity[Layer::FG_SPRITES], m_layer_opacity[Layer::FG_SPRITES]));
+            auto it = rasters.find(layer);
+            if (it != rasters.cend())
+            {
+                m_layer_rasters[layer] = it->second;
+            }
+            else
+            {
+                m_layer_rasters.erase(layer);
+            }
+            ApplyLayerOpacity(layer);
         }
     }
     if (m_show_entities || m_show_entity_hitboxes)
     {
-        DrawSpriteHitboxes(q);
-        AddEntityClickRegions(q);
+        DrawSpriteHitboxes(m_sprite_q);
+        AddEntityClickRegions(m_sprite_q);
     }
 }
 
-void RoomViewerCtrl::UpdateLayer(const Layer& layer, std::unique_ptr<wxBitmap> bmp)
+void RoomViewerCtrl::RedrawSprite(int entity)
 {
-    if (m_layers.find(layer) == m_layers.cend())
+    // Anything that changes more than this entity's own sprite needs everything redrawn, and
+    // every composite tile marked dirty so that the caller's repaint picks it up
+    auto it = std::find_if(m_sprite_q.begin(), m_sprite_q.end(), [entity](const SpriteQ& s) { return s.id == entity; });
+    if (it == m_sprite_q.end() || m_sprite_q.size() != m_entities.size())
+    {
+        RedrawAllSprites();
+        MarkAllDirty();
+        return;
+    }
+    const auto palette_alloc = m_sprite_palette_alloc;
+    m_rpalette = PreparePalettes(m_roomnum);
+    if (palette_alloc != m_sprite_palette_alloc)
+    {
+        RedrawAllSprites();
+        MarkAllDirty();
+        return;
+    }
+    const wxRect old_bounds = GetSpriteBounds(*it);
+    m_sprite_q.erase(it);
+    SpriteQ s = MakeSpriteQ(entity, m_entities[entity - 1], m_g->GetRoomData()->GetMapForRoom(m_roomnum)->GetData());
+    const wxRect new_bounds = GetSpriteBounds(s);
+    m_sprite_q.insert(std::upper_bound(m_sprite_q.begin(), m_sprite_q.end(), s, SpriteDrawOrder), s);
+    m_entity_poly.clear();
+    m_hit_index_valid = false;
+    if (m_show_entities)
+    {
+        RedrawSpriteRect(old_bounds);
+        RedrawSpriteRect(new_bounds);
+    }
+    if (m_show_entities || m_show_entity_hitboxes)
+    {
+        DrawSpriteHitboxes(m_sprite_q);
+        AddEntityClickRegions(m_sprite_q);
+    }
+    for (const auto& bounds : { old_bounds, new_bounds })
     {
-        m_layers.insert({ layer, nullptr });
+        MarkDirty(GetPolyBounds({ bounds.GetTopLeft(), bounds.GetBottomRight() }));
     }
-    m_layers[layer] = std::move(bmp);
 }
 
-void RoomViewerCtrl::UpdateLayer(const Layer& layer, const wxImage& img)
+void RoomViewerCtrl::RedrawSpriteRect(const wxRect& rect)
+{
+    const wxRect r = rect.Intersect(wxRect(0, 0, m_width, m_height));
+    if (r.IsEmpty())
+    {
+        return;
+    }
+    // Every sprite overlapping the rectangle is drawn again in order, into buffers that only cover it
+    ImageBufferWx bg_buf(r.width, r.height);
+    ImageBufferWx fg_buf(r.width, r.height);
+    for (const auto& s : m_sprite_q)
+    {
+        if (s.frame != nullptr && GetSpriteBounds(s).Intersects(r))
+        {
+            (s.background ? bg_buf : fg_buf).InsertSprite(s.x - r.x, s.y - r.y, s.palette, *s.frame, s.hflip);
+        }
+    }
+    for (const auto& [layer, buf] : { std::make_pair(Layer::BG_SPRITES, &bg_buf), std::make_pair(Layer::FG_SPRITES, &fg_buf) })
+    {
+        auto it = m_layer_rasters.find(layer);
+        if (it == m_layer_rasters.end())
+        {
+            continue;
+        }
+        wxImage& dst = it->second->image;
+        const wxImage src = buf->MakeImage(m_rpalette, true);
+        for (int y = 0; y < r.height; ++y)
+        {
+            const std::size_t offset = static_cast<std::size_t>(r.y + y) * dst.GetWidth() + r.x;
+            std::copy_n(src.GetData() + y * r.width * 3, r.width * 3, dst.GetData() + offset * 3);
+            std::copy_n(src.GetAlpha() + y * r.width, r.width, dst.GetAlpha() + offset);
+        }
+        ApplyLayerOpacity(layer, r);
+    }
+}
+
+RoomRenderCache::Key RoomViewerCtrl::GetMapLayerKey(Tilemap3D::Layer layer, bool previews) const
+{
+    RoomRenderCache::Key key{ m_roomnum, layer, previews, {}, {} };
+    if (previews)
+    {
+        key.preview_swaps.assign(m_preview_swaps.cbegin(), m_preview_swaps.cend());
+        key.preview_doors.assign(m_preview_doors.cbegin(), m_preview_doors.cend());
+    }
+    return key;
+}
+
+std::future<std::shared_ptr<RoomViewerCtrl::LayerRaster>> RoomViewerCtrl::GetMapLayerRasterAsync(Tilemap3D::Layer layer, bool previews)
+{
+    auto raster = m_layer_cache->Find(GetMapLayerKey(layer, previews));
+    if (raster)
+    {
+        return std::async(std::launch::deferred, [raster]() { return raster; });
+    }
+    // The worker renders from snapshot copies, so edits made while it runs can't race with it
+    auto sources = RoomRenderCache::GetRoomSources(m_g, m_roomnum);
+    if (previews)
+    {
+        return std::async(std::launch::async, [sources, layer, swaps = GetPreviewSwaps(), doors = GetPreviewDoors()]()
+            {
+                return RoomRenderCache::Render(sources, layer, swaps, doors);
+            });
+    }
+    return std::async(std::launch::async, [sources, layer]() { return RoomRenderCache::Render(sources, layer); });
+}
+
+RoomViewerCtrl::PendingMapLayers RoomViewerCtrl::RenderMapLayersAsync(bool previews)
+{
+    // BG and FG don't depend on each other, so any that aren't cached are rendered side by side
+    m_map_previews = previews;
+    PendingMapLayers pending;
+    for (const auto& [layer, map_layer] : MAP_LAYERS)
+    {
+        if (m_layer_opacity[layer] > 0 && pending.find(map_layer) == pending.cend())
+        {
+            pending.emplace(map_layer, GetMapLayerRasterAsync(map_layer, previews));
+        }
+    }
+    return pending;
+}
+
+void RoomViewerCtrl::UpdateMapLayers(bool previews)
+{
+    UpdateMapLayers(RenderMapLayersAsync(previews));
+}
+
+void RoomViewerCtrl::UpdateMapLayers(PendingMapLayers pending)
 {
-    if (m_layers.find(layer) == m_layers.cend())
+    std::map<Tilemap3D::Layer, std::shared_ptr<LayerRaster>> rasters;
+    for (auto& [map_layer, raster] : pending)
     {
-        m_layers.insert({ layer, std::make_unique<wxBitmap>(img)});
+        rasters[map_layer] = raster.get();
+        m_layer_cache->Insert(GetMapLayerKey(map_layer, m_map_previews), rasters[map_layer]);
+    }
+    for (const auto& [layer, map_layer] : MAP_LAYERS)
+    {
+        if (m_layer_opacity[layer] > 0)
+        {
+            m_layer_rasters[layer] = rasters[map_layer];
+        }
+        else
+        {
+            m_layer_rasters.erase(layer);
+        }
+        ApplyLayerOpacity(layer);
+    }
+}
+
+void RoomViewerCtrl::UpdateHeightmapLayer(std::shared_ptr<Tilemap3D> map)
+{
+    if (m_layer_opacity[Layer::HEIGHTMAP] > 0)
+    {
+        m_layer_rasters[Layer::HEIGHTMAP] = std::make_shared<LayerRaster>(LayerRaster{ DrawHeightmapVisualisation(map), {} });
     }
     else
     {
-        m_layers[layer] = std::make_unique<wxBitmap>(img);
+        m_layer_rasters.erase(Layer::HEIGHTMAP);
+    }
+    ApplyLayerOpacity(Layer::HEIGHTMAP);
+}
+
+void RoomViewerCtrl::ApplyLayerOpacity(const Layer& layer)
+{
+    auto it = m_layer_rasters.find(layer);
+    const uint8_t opacity = m_layer_opacity[layer];
+    if (it == m_layer_rasters.cend() || opacity == 0)
+    {
+        m_layers.erase(layer);
+        return;
+    }
+    const LayerRaster& raster = *it->second;
+    wxImage img = raster.image.Copy();
+    const std::size_t count = img.GetWidth() * img.GetHeight();
+    if (raster.priority_alpha.size() == count)
+    {
+        // High priority tiles are always drawn opaque
+        AlphaBlend::ClampAlpha(img.GetAlpha(), raster.priority_alpha.data(), count, opacity);
+    }
+    else
+    {
+        SetOpacity(img, opacity);
+    }
+    UpdateLayer(layer, img);
+}
+
+void RoomViewerCtrl::ApplyLayerOpacity(const Layer& layer, const wxRect& rect)
+{
+    auto it = m_layer_rasters.find(layer);
+    auto img = m_layers.find(layer);
+    if (it == m_layer_rasters.cend() || img == m_layers.end() || img->second.GetSize() != it->second->image.GetSize())
+    {
+        ApplyLayerOpacity(layer);
+        return;
+    }
+    const LayerRaster& raster = *it->second;
+    const uint8_t opacity = m_layer_opacity[layer];
+    const int width = raster.image.GetWidth();
+    const bool has_priority = raster.priority_alpha.size() == static_cast<std::size_t>(width * raster.image.GetHeight());
+    const wxRect r = rect.Intersect(wxRect(wxPoint(0, 0), raster.image.GetSize()));
+    for (int y = 0; y < r.height; ++y)
+    {
+        const std::size_t offset = static_cast<std::size_t>(r.y + y) * width + r.x;
+        std::copy_n(raster.image.GetData() + offset * 3, r.width * 3, img->second.GetData() + offset * 3);
+        std::copy_n(raster.image.GetAlpha() + offset, r.width, img->second.GetAlpha() + offset);
+        if (has_priority)
+        {
+            AlphaBlend::ClampAlpha(img->second.GetAlpha() + offset, raster.priority_alpha.data() + offset, r.width, opacity);
+        }
+        else
+        {
+            AlphaBlend::ClampAlpha(img->second.GetAlpha() + offset, r.width, opacity);
+        }
+    }
+}
+
+void RoomViewerCtrl::InvalidateLayerCache(bool previews_only)
+{
+    if (previews_only)
+    {
+        m_layer_cache->ClearPreviews();
+    }
+    else
+    {
+        m_layer_cache->Clear();
+        m_sprite_frames.clear();
+        m_palette_sets.clear();
+    }
+    // Door and swap edits reclassify heightmap cells as well
+    m_hm_cells.clear();
+}
+
+void RoomViewerCtrl::PrefetchAdjacentRooms()
+{
+    // Render the map layers of every room reachable through a warp or room link, so that
+    // following one of them doesn't have to wait for the tilemap to be drawn
+    std::vector<uint16_t> rooms;
+    auto add_room = [&](uint16_t room)
+    {
+        if (room != m_roomnum && room < m_g->GetRoomData()->GetRoomCount() &&
+            std::find(rooms.cbegin(), rooms.cend(), room) == rooms.cend())
+        {
+            rooms.push_back(room);
+        }
+    };
+    for (const auto& warp : m_warps)
+    {
+        add_room(warp.room1 == m_roomnum ? warp.room2 : warp.room1);
+    }
+    if (m_g->GetRoomData()->HasClimbDestination(m_roomnum))
+    {
+        add_room(m_g->GetRoomData()->GetClimbDestination(m_roomnum));
     }
+    if (m_g->GetRoomData()->HasFallDestination(m_roomnum))
+    {
+        add_room(m_g->GetRoomData()->GetFallDestination(m_roomnum));
+    }
+    for (const auto& t : m_g->GetRoomData()->GetTransitions(m_roomnum))
+    {
+        add_room(t.src_rm == m_roomnum ? t.dst_rm : t.src_rm);
+    }
+    std::vector<RoomRenderCache::RoomSources> sources;
+    for (uint16_t room : rooms)
+    {
+        if (!m_layer_cache->Contains({ room, Tilemap3D::Layer::BG, false, {}, {} }) ||
+            !m_layer_cache->Contains({ room, Tilemap3D::Layer::FG, false, {}, {} }))
+        {
+            sources.push_back(RoomRenderCache::GetRoomSources(m_g, room));
+        }
+    }
+    m_layer_cache->Prefetch(std::move(sources));
+}
+
+void RoomViewerCtrl::UpdateLayer(const Layer& layer, const wxImage& img)
+{
+    m_layers[layer] = img;
 }
 
 void RoomViewerCtrl::RefreshStatusbar()
@@ -589,13 +895,8 @@ void RoomViewerCtrl::RefreshStatusbar()
 
 std::vector<std::shared_ptr<Palette>> RoomViewerCtrl::PreparePalettes(uint16_t roomnum)
 {
-    auto palette = std::vector<std::shared_ptr<Palette>>{ m_g->GetRoomData()->GetPaletteForRoom(roomnum)->GetData() };
-    palette.emplace_back();
-    palette.emplace_back(m_g->GetGraphicsData()->GetPlayerPalette()->GetData());
-    palette.emplace_back(m_g->GetGraphicsData()->GetHudPalette()->GetData());
     m_errors.clear();
     std::array<int, 3> sprite_palette_alloc = { -1, -1, -1 };
-    m_layer_bufs[Layer::FG_SPRITES]->Resize(m_width, m_height);
     for (const auto& entity : m_entities)
     {
         auto s_pal = m_g->GetSpriteData()->GetEntityPaletteIdxs(entity.GetType());
@@ -638,9 +939,21 @@ std::vector<std::shared_ptr<Palette>> RoomViewerCtrl::PreparePalettes(uint16_t r
             }
         }
     }
+    m_sprite_palette_alloc = sprite_palette_alloc;
+    const PaletteSetKey key{ m_g->GetRoomData()->GetPaletteForRoom(roomnum)->GetData(), sprite_palette_alloc,
+        m_g->GetGraphicsData()->GetPlayerPalette()->GetData(), m_g->GetGraphicsData()->GetHudPalette()->GetData() };
+    auto it = m_palette_sets.find(key);
+    if (it != m_palette_sets.cend())
+    {
+        return it->second;
+    }
+    auto palette = std::vector<std::shared_ptr<Palette>>{ std::get<0>(key) };
+    palette.emplace_back();
+    palette.emplace_back(std::get<2>(key));
+    palette.emplace_back(std::get<3>(key));
     palette[3] = std::make_shared<Palette>(std::vector<std::shared_ptr<Palette>>{ palette[3], m_g->GetSpriteData()->GetSpritePalette(sprite_palette_alloc[2], -1) });
     palette[1] = m_g->GetSpriteData()->GetSpritePalette(sprite_palette_alloc[0], sprite_palette_alloc[1]);
-    return palette;
+    return m_palette_sets.emplace(key, palette).first->second;
 }
 
 std::vector<RoomViewerCtrl::SpriteQ> RoomViewerCtrl::PrepareSprites(uint16_t roomnum)
@@ -650,96 +963,129 @@ std::vector<RoomViewerCtrl::SpriteQ> RoomViewerCtrl::PrepareSprites(uint16_t roo
     int i = 1;
     for (const auto& entity : m_entities)
     {
-        SpriteQ s;
-        if (m_g->GetSpriteData()->HasFrontAndBack(entity.GetType()))
+        sprites.push_back(MakeSpriteQ(i, entity, map));
+        i++;
+    }
+    // Fix draw order
+    std::sort(sprites.begin(), sprites.end(), SpriteDrawOrder);
+    return sprites;
+}
+
+RoomViewerCtrl::SpriteQ RoomViewerCtrl::MakeSpriteQ(int id, const Entity& entity, std::shared_ptr<Tilemap3D> map)
+{
+    SpriteQ s;
+    int anim = -1;
+    if (m_g->GetSpriteData()->HasFrontAndBack(entity.GetType()))
+    {
+        anim = 0;
+        if ((entity.GetOrientation() == Orientation::SW || entity.GetOrientation() == Orientation::SE))
+        {
+            anim = 1;
+        }
+    }
+    const auto frame_key = std::make_pair(static_cast<uint8_t>(entity.GetType()), anim);
+    auto frame_it = m_sprite_frames.find(frame_key);
+    if (frame_it == m_sprite_frames.end())
+    {
+        std::shared_ptr<SpriteFrame> frame;
+        if (anim != -1)
         {
             auto sprite = m_g->GetSpriteData()->GetSpriteFromEntity(entity.GetType());
-            int anim = 0;
-            if ((entity.GetOrientation() == Orientation::SW || entity.GetOrientation() == Orientation::SE))
-            {
-                anim = 1;
-            }
-            auto frame = m_g->GetSpriteData()->GetSpriteFrame(sprite, anim, 0);
-            s.frame = frame->GetData();
+            frame = m_g->GetSpriteData()->GetSpriteFrame(sprite, anim, 0)->GetData();
         }
         else
         {
-            auto frame = m_g->GetSpriteData()->GetDefaultEntityFrame(entity.GetType());
-            s.frame = frame->GetData();
+            frame = m_g->GetSpriteData()->GetDefaultEntityFrame(entity.GetType())->GetData();
         }
-        s.id = i;
-        s.entity = entity;
-        s.palette = entity.GetPalette();
-        s.hflip = (entity.GetOrientation() == Orientation::NW || entity.GetOrientation() == Orientation::SE);
-        s.background = false;
-        s.selected = (i == m_selected);
+        frame_it = m_sprite_frames.emplace(frame_key, frame).first;
+    }
+    s.frame = frame_it->second;
+    s.id = id;
+    s.entity = entity;
+    s.palette = entity.GetPalette();
+    s.hflip = (entity.GetOrientation() == Orientation::NW || entity.GetOrientation() == Orientation::SE);
+    s.background = false;
+    s.selected = (id == m_selected);
 
-        auto hitbox = m_g->GetSpriteData()->GetEntityHitbox(entity.GetType());
+    auto hitbox = m_g->GetSpriteData()->GetEntityHitbox(entity.GetType());
+    s.hitbox_base = hitbox.base;
+    s.hitbox_height = hitbox.height;
 
-        int x = entity.GetX() + 0x080;
-        int y = entity.GetY() - 0x080;
-        int z = entity.GetZ();
+    int x = entity.GetX() + 0x080;
+    int y = entity.GetY() - 0x080;
+    int z = entity.GetZ();
 
-        // Adjust for entities with larger hitboxes
-        if (hitbox.base >= 0x0C)
-        {
-            x += 0x80;
-            y += 0x80;
-        }
+    // Adjust for entities with larger hitboxes
+    if (hitbox.base >= 0x0C)
+    {
+        x += 0x80;
+        y += 0x80;
+    }
 
-        auto xy = map->EntityPositionToPixel(x, y, z);
-        s.x = xy.x;
-        s.y = xy.y;
-        sprites.push_back(s);
-        i++;
+    auto xy = map->EntityPositionToPixel(x, y, z);
+    s.x = xy.x;
+    s.y = xy.y;
+    return s;
+}
+
+bool RoomViewerCtrl::SpriteDrawOrder(const SpriteQ& lhs, const SpriteQ& rhs)
+{
+    if (lhs.selected || rhs.selected)
+    {
+        return rhs.selected;
     }
-    // Fix draw order
-    std::sort(sprites.begin(), sprites.end(), [this](const SpriteQ& lhs, const SpriteQ& rhs) -> bool
-        {
-            if (lhs.selected || rhs.selected)
-            {
-                return rhs.selected;
-            }
-            // Draw objects furthest away from camera first
-            auto hitbox_lhs = m_g->GetSpriteData()->GetEntityHitbox(lhs.entity.GetType());
-            auto hitbox_rhs = m_g->GetSpriteData()->GetEntityHitbox(rhs.entity.GetType());
-            int dist_lhs = lhs.entity.GetX() + lhs.entity.GetY() + hitbox_lhs.base;
-            int dist_rhs = rhs.entity.GetX() + rhs.entity.GetY() + hitbox_rhs.base;
-            if (dist_lhs != dist_rhs)
-            {
-                return dist_lhs < dist_rhs;
-            }
-            // Next draw left-most objects
-            int left_lhs = lhs.entity.GetY() - hitbox_lhs.base;
-            int left_rhs = rhs.entity.GetY() - hitbox_rhs.base;
-            if (left_lhs != left_rhs)
-            {
-                return left_lhs < left_rhs;
-            }
-            // Finally, sort by height
-            int height_lhs = lhs.entity.GetZ() + hitbox_lhs.height;
-            int height_rhs = rhs.entity.GetZ() + hitbox_rhs.height;
-            return height_lhs < height_rhs;
-        });
-    return sprites;
+    // Draw objects furthest away from camera first
+    int dist_lhs = lhs.entity.GetX() + lhs.entity.GetY() + lhs.hitbox_base;
+    int dist_rhs = rhs.entity.GetX() + rhs.entity.GetY() + rhs.hitbox_base;
+    if (dist_lhs != dist_rhs)
+    {
+        return dist_lhs < dist_rhs;
+    }
+    // Next draw left-most objects
+    int left_lhs = lhs.entity.GetY() - lhs.hitbox_base;
+    int left_rhs = rhs.entity.GetY() - rhs.hitbox_base;
+    if (left_lhs != left_rhs)
+    {
+        return left_lhs < left_rhs;
+    }
+    // Finally, sort by height
+    int height_lhs = lhs.entity.GetZ() + lhs.hitbox_height;
+    int height_rhs = rhs.entity.GetZ() + rhs.hitbox_height;
+    return height_lhs < height_rhs;
+}
+
+wxRect RoomViewerCtrl::GetSpriteBounds(const SpriteQ& s) const
+{
+    // Covers both the sprite frame and the hitbox wireframe, in unscaled room coordinates
+    int left = s.x - s.hitbox_base * 2;
+    int right = s.x + s.hitbox_base * 2;
+    int top = s.y - s.hitbox_base - s.hitbox_height;
+    int bottom = s.y + s.hitbox_base;
+    if (s.frame != nullptr)
+    {
+        // Flipped frames are mirrored about the sprite origin, so allow for either orientation
+        const int half_width = std::max(std::abs(s.frame->GetLeft()), std::abs(s.frame->GetLeft() + s.frame->GetWidth())) + 1;
+        left = std::min(left, s.x - half_width);
+        right = std::max(right, s.x + half_width);
+        top = std::min(top, s.y + s.frame->GetTop());
+        bottom = std::max(bottom, s.y + s.frame->GetTop() + s.frame->GetHeight());
+    }
+    return wxRect(wxPoint(left, top), wxPoint(right, bottom));
 }
 
 void RoomViewerCtrl::DrawSpriteHitboxes(const std::vector<SpriteQ>& q)
 {
     std::unordered_map<Layer, wxImage> layers;
     std::unordered_map<Layer, wxGraphicsContext*> ctxs;
-    layers.insert({ Layer::BG_SPRITES_WIREFRAME_BG, wxImage(m_buffer_width, m_buffer_height) });
-    layers.insert({ Layer::BG_SPRITES_WIREFRAME_FG, wxImage(m_buffer_width, m_buffer_height) });
-    layers.insert({ Layer::FG_SPRITES_WIREFRAME_BG, wxImage(m_buffer_width, m_buffer_height) });
-    layers.insert({ Layer::FG_SPRITES_WIREFRAME_FG, wxImage(m_buffer_width, m_buffer_height) });
+    layers.insert({ Layer::BG_SPRITES_WIREFRAME_BG, CreateOverlayImage() });
+    layers.insert({ Layer::BG_SPRITES_WIREFRAME_FG, CreateOverlayImage() });
+    layers.insert({ Layer::FG_SPRITES_WIREFRAME_BG, CreateOverlayImage() });
+    layers.insert({ Layer::FG_SPRITES_WIREFRAME_FG, CreateOverlayImage() });
     
     
     for (auto& img : layers)
     {
-        img.second.InitAlpha();
-        SetOpacity(img.second, 0x00);
-        auto ctx = wxGraphicsContext::Create(img.second);
-        ctx->Scale(m_zoom, m_zoom);
+        auto ctx = CreateOverlayContext(img.second);
         ctx->SetPen(*wxTRANSPARENT_PEN);
         ctx->SetBrush(*wxBLACK_BRUSH);
         ctxs.insert({ img.first, ctx });
@@ -795,7 +1141,7 @@ void RoomViewerCtrl::DrawSpriteHitboxes(const std::vector<SpriteQ>& q)
     }
 }
 
-void RoomViewerCtrl::DrawSprites(const std::vector<SpriteQ>& q)
+void RoomViewerCtrl::DrawSprites(const std::vector<SpriteQ>& q, ImageBufferWx& bg_buf, ImageBufferWx& fg_buf)
 {
     for (const auto& s : q)
     {
@@ -803,11 +1149,11 @@ void RoomViewerCtrl::DrawSprites(const std::vector<SpriteQ>& q)
         {
             if (s.background)
             {
-                m_layer_bufs[Layer::BG_SPRITES]->InsertSprite(s.x, s.y, s.palette, *s.frame, s.hflip);
+                bg_buf.InsertSprite(s.x, s.y, s.palette, *s.frame, s.hflip);
             }
             else
             {
-                m_layer_bufs[Layer::FG_SPRITES]->InsertSprite(s.x, s.y, s.palette, *s.frame, s.hflip);
+                fg_buf.InsertSprite(s.x, s.y, s.palette, *s.frame, s.hflip);
             }
         }
     }
@@ -822,18 +1168,16 @@ void RoomViewerCtrl::UpdateRoomDescText(uint16_t /*roomnum*/)
     RefreshStatusbar();
 }
 
-std::unique_ptr<wxBitmap> RoomViewerCtrl::DrawRoomWarps(uint16_t roomnum)
+wxImage RoomViewerCtrl::DrawRoomWarps(uint16_t roomnum)
 {
     m_warp_poly.clear();
     m_link_poly.clear();
+    m_hit_index_valid = false;
     auto map = m_g->GetRoomData()->GetMapForRoom(roomnum)->GetData();
     auto warps = m_g->GetRoomData()->GetWarpsForRoom(roomnum);
 
-    wxImage img(m_buffer_width, m_buffer_height);
-    img.InitAlpha();
-    SetOpacity(img, 0x00);
-    wxGraphicsContext* gc = wxGraphicsContext::Create(img);
-    gc->Scale(m_zoom, m_zoom);
+    wxImage img = CreateOverlayImage();
+    wxGraphicsContext* gc = CreateOverlayContext(img);
     gc->SetPen(*wxWHITE_PEN);
     gc->SetBrush(*wxBLACK_BRUSH);
     for (std::size_t i = 0; i < m_warps.size(); ++i)
@@ -862,7 +1206,7 @@ std::unique_ptr<wxBitmap> RoomViewerCtrl::DrawRoomWarps(uint16_t roomnum)
         line++;
     }
     delete gc;
-    return std::make_unique<wxBitmap>(img);
+    return img;
 }
 
 void RoomViewerCtrl::UpdateWarpProperties(int warp)
@@ -873,7 +1217,7 @@ void RoomViewerCtrl::UpdateWarpProperties(int warp)
         WarpPropertyWindow dlg(m_frame, m_roomnum, warp, &m_warps[warp - 1], *m_g);
         if (dlg.ShowModal() == wxID_OK)
         {
-            m_g->GetRoomData()->SetWarpsForRoom(m_roomnum, m_warps);
+            CommitWarps("Edit Warp");
             if (pend && m_warps[warp-1].IsValid())
             {
                 m_is_warp_pending = false;
@@ -886,69 +1230,162 @@ void RoomViewerCtrl::UpdateWarpProperties(int warp)
     }
 }
 
-std::unique_ptr<wxBitmap> RoomViewerCtrl::DrawHeightmapVisualisation(std::shared_ptr<Tilemap3D> map, uint8_t opacity)
+wxImage RoomViewerCtrl::DrawHeightmapVisualisation(std::shared_ptr<Tilemap3D> map)
 {
-    wxImage hm_img(m_buffer_width, m_buffer_height);
-    hm_img.InitAlpha();
-    SetOpacity(hm_img, 0x00);
-    wxGraphicsContext* hm_gc = wxGraphicsContext::Create(hm_img);
-    hm_gc->Scale(m_zoom, m_zoom);
-    hm_gc->SetPen(*wxWHITE_PEN);
-    hm_gc->SetBrush(*wxBLACK_BRUSH);
-    auto preview_swaps = GetPreviewSwaps();
+    wxImage hm_img = CreateOverlayImage();
+    UpdateHeightmapCellGrid(map);
+    if (m_hm_atlas_zoom != m_zoom)
+    {
+        m_hm_cell_atlas.clear();
+        m_hm_atlas_zoom = m_zoom;
+    }
+    const int width = map->GetHeightmapWidth();
     for (int y = 0; y < map->GetHeightmapHeight(); ++y)
     {
-        for (int x = 0; x < map->GetHeightmapWidth(); ++x)
+        for (int x = 0; x < width; ++x)
         {
             // Only display cells that are not completely restricted
-            wxColour wall_colour = *wxWHITE;
-            bool draw_outline = false;
-            for (const auto& door : m_g->GetRoomData()->GetDoors(m_roomnum))
+            const HeightmapCell& cell = m_hm_cells[y * width + x];
+            const bool draw_outline = cell.border != HeightmapCell::Border::NONE;
+            if ((map->GetHeight({ x, y }) > 0 || (map->GetCellProps({ x, y }) != 0x04)) || draw_outline)
             {
-                if ((x >= door.x && x < door.x + Door::SIZES.at(door.size).first) &&
-                    (y >= door.y && y < door.y + Door::SIZES.at(door.size).second))
-                {
-                    wall_colour = wxColor(255, 0, 255);
-                    draw_outline = true;
-                }
+                int z = map->GetHeight(cell.src);
+                auto xy(map->Iso3DToPixel({ x + 12, y + 12, z }));
+                DrawHeightmapCellSprite(hm_img, GetHeightmapCellSprite(z, map->GetCellProps(cell.src),
+                    map->GetCellType(cell.src), cell.border), xy.x, xy.y);
             }
-            for (const auto& swap : m_g->GetRoomData()->GetTileSwaps(m_roomnum))
+        }
+    }
+    return hm_img;
+}
+
+void RoomViewerCtrl::UpdateHeightmapCellGrid(std::shared_ptr<Tilemap3D> map)
+{
+    const int width = map->GetHeightmapWidth();
+    const int height = map->GetHeightmapHeight();
+    std::vector<int> previews(m_preview_swaps.cbegin(), m_preview_swaps.cend());
+    if (m_hm_cells.size() == static_cast<std::size_t>(width * height) && m_hm_cells_previews == previews)
+    {
+        return;
+    }
+    m_hm_cells.resize(width * height);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            m_hm_cells[y * width + x] = { HMPoint2D{ x, y }, HeightmapCell::Border::NONE };
+        }
+    }
+    auto mark_region = [&](int rx, int ry, int rw, int rh, HeightmapCell::Border border)
+    {
+        for (int y = std::max(ry, 0); y < std::min(ry + rh, height); ++y)
+        {
+            for (int x = std::max(rx, 0); x < std::min(rx + rw, width); ++x)
             {
-                if ((x >= swap.heightmap.src_x && x < swap.heightmap.src_x + swap.heightmap.width) &&
-                    (y >= swap.heightmap.src_y && y < swap.heightmap.src_y + swap.heightmap.height))
-                {
-                    wall_colour = *wxGREEN;
-                    draw_outline = true;
-                }
-                if ((x >= swap.heightmap.dst_x && x < swap.heightmap.dst_x + swap.heightmap.width) &&
-                    (y >= swap.heightmap.dst_y && y < swap.heightmap.dst_y + swap.heightmap.height))
-                {
-                    wall_colour = wxColor(0, 255, 255);
-                    draw_outline = true;
-                }
+                m_hm_cells[y * width + x].border = border;
             }
-            if ((map->GetHeight({ x, y }) > 0 || (map->GetCellProps({ x, y }) != 0x04)) || draw_outline)
+        }
+    };
+    for (const auto& door : m_g->GetRoomData()->GetDoors(m_roomnum))
+    {
+        mark_region(door.x, door.y, Door::SIZES.at(door.size).first, Door::SIZES.at(door.size).second,
+            HeightmapCell::Border::DOOR);
+    }
+    for (const auto& swap : m_g->GetRoomData()->GetTileSwaps(m_roomnum))
+    {
+        mark_region(swap.heightmap.src_x, swap.heightmap.src_y, swap.heightmap.width, swap.heightmap.height,
+            HeightmapCell::Border::SWAP_SRC);
+        mark_region(swap.heightmap.dst_x, swap.heightmap.dst_y, swap.heightmap.width, swap.heightmap.height,
+            HeightmapCell::Border::SWAP_DST);
+    }
+    for (const auto& s : GetPreviewSwaps())
+    {
+        for (int ry = 0; ry < s.heightmap.height; ++ry)
+        {
+            for (int rx = 0; rx < s.heightmap.width; ++rx)
             {
-                HMPoint2D p = { x, y };
-                for (const auto& s : preview_swaps)
+                const int x = s.heightmap.dst_x + rx;
+                const int y = s.heightmap.dst_y + ry;
+                if (x >= 0 && x < width && y >= 0 && y < height)
                 {
-                    int rx = x - s.heightmap.dst_x;
-                    int ry = y - s.heightmap.dst_y;
-                    if (rx >= 0 && rx < s.heightmap.width && ry >= 0 && ry < s.heightmap.height)
-                    {
-                        p = { rx + s.heightmap.src_x, ry + s.heightmap.src_y };
-                    }
+                    m_hm_cells[y * width + x].src = { rx + s.heightmap.src_x, ry + s.heightmap.src_y };
                 }
-                int z = map->GetHeight(p);
-                auto xy(map->Iso3DToPixel({ x + 12, y + 12, z }));
-                DrawHeightmapCell(*hm_gc, xy.x, xy.y, z, TILE_WIDTH, TILE_HEIGHT,
-                    map->GetCellProps(p), map->GetCellType(p), draw_outline, wall_colour);
             }
         }
     }
-    delete hm_gc;
-    SetOpacity(hm_img, opacity);
-    return std::make_unique<wxBitmap>(hm_img);
+    m_hm_cells_previews = std::move(previews);
+}
+
+const wxImage& RoomViewerCtrl::GetHeightmapCellSprite(int z, int restrictions, int classification, HeightmapCell::Border border)
+{
+    const auto key = std::make_tuple(z, restrictions, classification, border);
+    auto it = m_hm_cell_atlas.find(key);
+    if (it != m_hm_cell_atlas.cend())
+    {
+        return it->second;
+    }
+    wxColour border_colour = *wxWHITE;
+    switch (border)
+    {
+    case HeightmapCell::Border::DOOR:
+        border_colour = wxColor(255, 0, 255);
+        break;
+    case HeightmapCell::Border::SWAP_SRC:
+        border_colour = *wxGREEN;
+        break;
+    case HeightmapCell::Border::SWAP_DST:
+        border_colour = wxColor(0, 255, 255);
+        break;
+    default:
+        break;
+    }
+    // The sprite covers the cell top, both walls and a margin for the outline pen. The
+    // margin is a whole number of pixels so that the cell origin stays on the pixel grid.
+    const int margin = GetHeightmapSpriteMargin();
+    const int width = std::ceil(TILE_WIDTH * m_zoom) + margin * 2;
+    const int height = std::ceil(TILE_HEIGHT * (std::max(z, 0) + 1) * m_zoom) + margin * 2;
+    wxImage sprite(width, height);
+    sprite.InitAlpha();
+    SetOpacity(sprite, 0x00);
+    wxGraphicsContext* gc = wxGraphicsContext::Create(sprite);
+    gc->Translate(margin, margin);
+    gc->Scale(m_zoom, m_zoom);
+    gc->SetPen(*wxWHITE_PEN);
+    gc->SetBrush(*wxBLACK_BRUSH);
+    DrawHeightmapCell(*gc, 0, 0, z, TILE_WIDTH, TILE_HEIGHT,
+        restrictions, classification, border != HeightmapCell::Border::NONE, border_colour);
+    delete gc;
+    return m_hm_cell_atlas.emplace(key, sprite).first->second;
+}
+
+void RoomViewerCtrl::DrawHeightmapCellSprite(wxImage& image, const wxImage& sprite, int x, int y)
+{
+    // Position the sprite from the rounded cell origin, as used by the rest of the grid,
+    // so that neighbouring cells line up exactly at every zoom level
+    const int margin = GetHeightmapSpriteMargin();
+    const int dx = std::lround(x * m_zoom) - margin - m_render_rect.x;
+    const int dy = std::lround(y * m_zoom) - margin - m_render_rect.y;
+    const int x0 = std::max(dx, 0);
+    const int x1 = std::min(dx + sprite.GetWidth(), image.GetWidth());
+    const int y0 = std::max(dy, 0);
+    const int y1 = std::min(dy + sprite.GetHeight(), image.GetHeight());
+    if (x1 <= x0 || y1 <= y0)
+    {
+        // Cell lies outside of the rendered part of the room
+        return;
+    }
+    for (int py = y0; py < y1; ++py)
+    {
+        const std::size_t src = static_cast<std::size_t>(py - dy) * sprite.GetWidth() + (x0 - dx);
+        const std::size_t dst = static_cast<std::size_t>(py) * image.GetWidth() + x0;
+        AlphaBlend::BlendOverAlpha(image.GetData() + dst * 3, image.GetAlpha() + dst,
+            sprite.GetData() + src * 3, sprite.GetAlpha() + src, x1 - x0);
+    }
+}
+
+int RoomViewerCtrl::GetHeightmapSpriteMargin() const
+{
+    return std::lround(HM_CELL_SPRITE_MARGIN * m_zoom);
 }
 
 void RoomViewerCtrl::DrawHeightmapCell(wxGraphicsContext& gc, int x, int y, int zz, int width, int height, int restrictions, int classification, bool draw_walls, wxColor border_colour)
@@ -1037,6 +1474,7 @@ void RoomViewerCtrl::DrawHeightmapCell(wxGraphicsContext& gc, int x, int y, int
 void RoomViewerCtrl::DrawTileSwaps(wxGraphicsContext& gc, uint16_t roomnum)
 {
     m_swap_regions.clear();
+    m_hit_index_valid = false;
     if (!m_g)
     {
         return;
@@ -1099,6 +1537,7 @@ void RoomViewerCtrl::DrawTileSwaps(wxGraphicsContext& gc, uint16_t roomnum)
 void RoomViewerCtrl::DrawDoors(wxGraphicsContext& gc, uint16_t roomnum)
 {
     m_door_regions.clear();
+    m_hit_index_valid = false;
     if (!m_g)
     {
         return;
@@ -1161,19 +1600,16 @@ void RoomViewerCtrl::DrawDoors(wxGraphicsContext& gc, uint16_t roomnum)
     }
 }
 
-std::unique_ptr<wxBitmap> RoomViewerCtrl::DrawRoomSwaps(uint16_t roomnum)
+wxImage RoomViewerCtrl::DrawRoomSwaps(uint16_t roomnum)
 {
-    wxImage img = wxImage(m_buffer_width, m_buffer_height);
-    img.InitAlpha();
-    SetOpacity(img, 0x00);
-    wxGraphicsContext* gc = wxGraphicsContext::Create(img);
-    gc->Scale(m_zoom, m_zoom);
+    wxImage img = CreateOverlayImage();
+    wxGraphicsContext* gc = CreateOverlayContext(img);
     gc->SetPen(*wxWHITE_PEN);
     gc->SetBrush(*wxBLACK_BRUSH);
     DrawTileSwaps(*gc, roomnum);
     DrawDoors(*gc, roomnum);
     delete gc;
-    return std::make_unique<wxBitmap>(img);
+    return img;
 }
 
 std::vector<wxPoint2DDouble> RoomViewerCtrl::ToWxPoints2DDouble(const std::vector<std::pair<int, int>>& points)
@@ -1306,7 +1742,7 @@ void RoomViewerCtrl::AddWarp()
                 idx = m_warps.size();
                 m_is_warp_pending = false;
             }
-            m_g->GetRoomData()->SetWarpsForRoom(m_roomnum, m_warps);
+            CommitWarps("Add Warp");
             SelectWarp(idx);
         }
         else
@@ -1365,10 +1801,7 @@ void RoomViewerCtrl::RefreshHeightmap()
     if (IsShownOnScreen())
     {
         auto map = m_g->GetRoomData()->GetMapForRoom(m_roomnum)->GetData();
-        if (m_layer_opacity[Layer::HEIGHTMAP] > 0)
-        {
-            m_layers[Layer::HEIGHTMAP] = DrawHeightmapVisualisation(map, m_layer_opacity[Layer::HEIGHTMAP]);
-        }
+        UpdateHeightmapLayer(map);
         if (m_show_warps)
         {
             m_layers[Layer::WARPS] = DrawRoomWarps(m_roomnum);
@@ -1383,9 +1816,9 @@ void RoomViewerCtrl::RefreshHeightmap()
 
 void RoomViewerCtrl::RefreshLayers()
 {
+    InvalidateLayerCache();
     if (IsShownOnScreen())
     {
-        auto map = m_g->GetRoomData()->GetMapForRoom(m_roomnum)->GetData();
         if (m_layer_opacity[Layer::BACKGROUND1] > 0
             || m_layer_opacity[Layer::BACKGROUND2] > 0
             || m_layer_opacity[Layer::FOREGROUND] > 0)
@@ -1427,7 +1860,7 @@ void RoomViewerCtrl::DeleteSelectedWarp()
         {
             ForceRedraw();
         }
-        m_g->GetRoomData()->SetWarpsForRoom(m_roomnum, m_warps);
+        CommitWarps("Delete Warp");
         RefreshStatusbar();
         FireEvent(EVT_WARP_UPDATE);
     }
@@ -1497,6 +1930,7 @@ void RoomViewerCtrl::UpdateSwaps()
     {
         auto old_swap_size = m_swaps.size();
         m_swaps = m_g->GetRoomData()->GetTileSwaps(m_roomnum);
+        InvalidateLayerCache(true);
         if (m_swaps.size() != old_swap_size)
         {
             ClearAllPreviews();
@@ -1556,39 +1990,137 @@ int RoomViewerCtrl::GetSelectedDoorIndex() const
     }
     else
     {
-        return NO_SELECTION;
+        return NO_SELECTION;
+    }
+}
+
+void RoomViewerCtrl::UpdateDoors()
+{
+    if (m_g)
+    {
+        auto old_swap_size = m_doors.size();
+        m_doors = m_g->GetRoomData()->GetDoors(m_roomnum);
+        InvalidateLayerCache(true);
+        if (m_doors.size() != old_swap_size)
+        {
+            ClearAllPreviews();
+        }
+        RefreshRoom(true);
+    }
+}
+
+void RoomViewerCtrl::SetOpacity(wxImage& image, uint8_t opacity)
+{
+    AlphaBlend::ClampAlpha(image.GetAlpha(), image.GetWidth() * image.GetHeight(), opacity);
+}
+
+void RoomViewerCtrl::ForceRedraw()
+{
+    MarkAllDirty();
+    m_repaint = true;
+    Refresh(true);
+}
+
+void RoomViewerCtrl::MarkDirty(const wxRect& rect)
+{
+    const wxRect r = rect.Intersect(wxRect(0, 0, m_buffer_width, m_buffer_height));
+    if (r.IsEmpty() || m_dirty_tiles.empty())
+    {
+        return;
+    }
+    for (int ty = r.GetTop() / COMPOSITE_TILE_SIZE; ty <= r.GetBottom() / COMPOSITE_TILE_SIZE; ++ty)
+    {
+        for (int tx = r.GetLeft() / COMPOSITE_TILE_SIZE; tx <= r.GetRight() / COMPOSITE_TILE_SIZE; ++tx)
+        {
+            m_dirty_tiles[ty * m_tiles_wide + tx] = true;
+        }
+    }
+    m_redraw = true;
+}
+
+void RoomViewerCtrl::MarkAllDirty()
+{
+    std::fill(m_dirty_tiles.begin(), m_dirty_tiles.end(), true);
+    m_redraw = true;
+}
+
+void RoomViewerCtrl::MarkRegionDirty(int index)
+{
+    for (const auto& rect : GetRegionRects(index))
+    {
+        MarkDirty(rect);
+    }
+}
+
+std::vector<wxRect> RoomViewerCtrl::GetRegionRects(int index) const
+{
+    if (index > SWAP_IDX_OFFSET && index <= SWAP_IDX_OFFSET + static_cast<int>(m_swap_regions.size()))
+    {
+        const auto& [src, dst] = m_swap_regions[index - SWAP_IDX_OFFSET - 1];
+        return { GetPolyBounds(src), GetPolyBounds(dst) };
+    }
+    else if (index > DOOR_IDX_OFFSET && index <= DOOR_IDX_OFFSET + static_cast<int>(m_door_regions.size()))
+    {
+        return { GetPolyBounds(m_door_regions[index - DOOR_IDX_OFFSET - 1].second) };
     }
+    return {};
 }
 
-void RoomViewerCtrl::UpdateDoors()
+void RoomViewerCtrl::RedrawRegion(int index)
 {
-    if (m_g)
+    // Only the overlay under the swap or door outline is drawn again. Every outline is
+    // redrawn into the patch, clipped to it, so that overlapping outlines stay intact.
+    auto layer = m_layers.find(Layer::SWAPS);
+    for (const auto& rect : GetRegionRects(index))
     {
-        auto old_swap_size = m_doors.size();
-        m_doors = m_g->GetRoomData()->GetDoors(m_roomnum);
-        if (m_doors.size() != old_swap_size)
+        const wxRect r = rect.Intersect(m_render_rect);
+        if (layer != m_layers.end() && layer->second.IsOk() && !r.IsEmpty())
         {
-            ClearAllPreviews();
+            wxImage patch(r.width, r.height);
+            patch.InitAlpha();
+            AlphaBlend::ClampAlpha(patch.GetAlpha(), r.width * r.height, 0x00);
+            wxGraphicsContext* gc = wxGraphicsContext::Create(patch);
+            gc->Translate(-r.x, -r.y);
+            gc->Scale(m_zoom, m_zoom);
+            gc->SetPen(*wxWHITE_PEN);
+            gc->SetBrush(*wxBLACK_BRUSH);
+            DrawTileSwaps(*gc, m_roomnum);
+            DrawDoors(*gc, m_roomnum);
+            delete gc;
+            wxImage& img = layer->second;
+            for (int y = 0; y < r.height; ++y)
+            {
+                const std::size_t offset = static_cast<std::size_t>(r.y - m_render_rect.y + y) * img.GetWidth() + r.x - m_render_rect.x;
+                std::copy_n(patch.GetData() + y * r.width * 3, r.width * 3, img.GetData() + offset * 3);
+                std::copy_n(patch.GetAlpha() + y * r.width, r.width, img.GetAlpha() + offset);
+            }
         }
-        RefreshRoom(true);
+        MarkDirty(rect);
     }
 }
 
-void RoomViewerCtrl::SetOpacity(wxImage& image, uint8_t opacity)
+wxRect RoomViewerCtrl::GetPolyBounds(const std::vector<wxPoint2DDouble>& poly) const
 {
-    uint8_t* alpha = image.GetAlpha();
-    for (int i = 0; i < (image.GetHeight() * image.GetWidth()); i++)
+    if (poly.empty())
     {
-        *alpha = (*alpha < opacity) ? *alpha : opacity;
-        alpha++;
+        return wxRect();
     }
-}
-
-void RoomViewerCtrl::ForceRedraw()
-{
-    m_redraw = true;
-    m_repaint = true;
-    Refresh(true);
+    double left = poly.front().m_x;
+    double right = poly.front().m_x;
+    double top = poly.front().m_y;
+    double bottom = poly.front().m_y;
+    for (const auto& p : poly)
+    {
+        left = std::min(left, p.m_x);
+        right = std::max(right, p.m_x);
+        top = std::min(top, p.m_y);
+        bottom = std::max(bottom, p.m_y);
+    }
+    // Polygons are stored in unscaled room coordinates - allow for the widest outline pen
+    const int margin = std::ceil(2 * m_zoom) + 2;
+    const int x = std::floor(left * m_zoom) - margin;
+    const int y = std::floor(top * m_zoom) - margin;
+    return wxRect(x, y, std::ceil(right * m_zoom) + margin - x + 1, std::ceil(bottom * m_zoom) + margin - y + 1);
 }
 
 void RoomViewerCtrl::ForceRepaint()
@@ -1609,7 +2141,80 @@ void RoomViewerCtrl::UpdateBuffer()
 {
     m_buffer_width = std::ceil(m_width * m_zoom);
     m_buffer_height = std::ceil(m_height * m_zoom);
-    m_bmp->Create(m_buffer_width, m_buffer_height);
+    m_tiles_wide = (m_buffer_width + COMPOSITE_TILE_SIZE - 1) / COMPOSITE_TILE_SIZE;
+    m_tiles_high = (m_buffer_height + COMPOSITE_TILE_SIZE - 1) / COMPOSITE_TILE_SIZE;
+    m_dirty_tiles.assign(m_tiles_wide * m_tiles_high, true);
+    // Only the part of the room around the viewport is ever rasterised at the current zoom.
+    // The overlays drawn after this call are sized to match.
+    m_render_rect = GetRenderRect(GetVisibleRect());
+    m_bmp->Create(std::max(m_render_rect.width, 1), std::max(m_render_rect.height, 1));
+    m_redraw = true;
+}
+
+wxRect RoomViewerCtrl::GetVisibleRect() const
+{
+    int sx, sy;
+    GetViewStart(&sx, &sy);
+    int sw, sh;
+    GetClientSize(&sw, &sh);
+    return wxRect(sx * m_scroll_rate, sy * m_scroll_rate, sw, sh).Intersect(wxRect(0, 0, m_buffer_width, m_buffer_height));
+}
+
+wxRect RoomViewerCtrl::GetRenderRect(const wxRect& visible) const
+{
+    // Pad the viewport so that short scrolls don't need anything redrawn, and align to the
+    // composite tiles so that each tile lies entirely inside or outside of the render area
+    const int left = std::max(visible.GetLeft() - RENDER_MARGIN, 0) / COMPOSITE_TILE_SIZE * COMPOSITE_TILE_SIZE;
+    const int top = std::max(visible.GetTop() - RENDER_MARGIN, 0) / COMPOSITE_TILE_SIZE * COMPOSITE_TILE_SIZE;
+    const int right = (visible.GetRight() + RENDER_MARGIN) / COMPOSITE_TILE_SIZE * COMPOSITE_TILE_SIZE + COMPOSITE_TILE_SIZE;
+    const int bottom = (visible.GetBottom() + RENDER_MARGIN) / COMPOSITE_TILE_SIZE * COMPOSITE_TILE_SIZE + COMPOSITE_TILE_SIZE;
+    return wxRect(left, top, std::min(right, m_buffer_width) - left, std::min(bottom, m_buffer_height) - top);
+}
+
+void RoomViewerCtrl::UpdateRenderRect()
+{
+    m_render_rect = GetRenderRect(GetVisibleRect());
+    m_bmp->Create(std::max(m_render_rect.width, 1), std::max(m_render_rect.height, 1));
+    RedrawOverlays();
+    MarkAllDirty();
+}
+
+void RoomViewerCtrl::RedrawOverlays()
+{
+    if (m_g == nullptr)
+    {
+        return;
+    }
+    UpdateHeightmapLayer(m_g->GetRoomData()->GetMapForRoom(m_roomnum)->GetData());
+    if (m_show_warps)
+    {
+        m_layers[Layer::WARPS] = DrawRoomWarps(m_roomnum);
+    }
+    if (m_show_swaps)
+    {
+        m_layers[Layer::SWAPS] = DrawRoomSwaps(m_roomnum);
+    }
+    if (m_show_entities || m_show_entity_hitboxes)
+    {
+        DrawSpriteHitboxes(m_sprite_q);
+    }
+}
+
+wxImage RoomViewerCtrl::CreateOverlayImage() const
+{
+    wxImage img(std::max(m_render_rect.width, 1), std::max(m_render_rect.height, 1));
+    img.InitAlpha();
+    AlphaBlend::ClampAlpha(img.GetAlpha(), img.GetWidth() * img.GetHeight(), 0x00);
+    return img;
+}
+
+wxGraphicsContext* RoomViewerCtrl::CreateOverlayContext(wxImage& img) const
+{
+    // Overlays are drawn in room coordinates, and only cover the render area
+    wxGraphicsContext* gc = wxGraphicsContext::Create(img);
+    gc->Translate(-m_render_rect.x, -m_render_rect.y);
+    gc->Scale(m_zoom, m_zoom);
+    return gc;
 }
 
 void RoomViewerCtrl::RefreshGraphics()
@@ -1621,16 +2226,56 @@ void RoomViewerCtrl::RefreshGraphics()
     if (!m_show_warps)
     {
         m_warp_poly.clear();
+        m_hit_index_valid = false;
     }
     if (!m_show_entities && !m_show_entity_hitboxes)
     {
         m_entity_poly.clear();
+        m_hit_index_valid = false;
     }
     DrawRoom(m_roomnum);
     UpdateScroll();
     ForceRedraw();
 }
 
+void RoomViewerCtrl::RecolourPalette(const Palette* palette)
+{
+    if (m_g == nullptr)
+    {
+        return;
+    }
+    // Sprite palettes are combined into new palettes, which have to be rebuilt to see the edit
+    m_palette_sets.clear();
+    m_layer_cache->Recolour(m_g, palette);
+    const auto room_palette = m_g->GetRoomData()->GetPaletteForRoom(m_roomnum)->GetData();
+    if (palette == nullptr || room_palette.get() == palette)
+    {
+        // The displayed layers may have been evicted from the cache, in which case nothing
+        // else will have recoloured them
+        std::vector<std::shared_ptr<LayerRaster>> recoloured;
+        for (const auto& [layer, map_layer] : MAP_LAYERS)
+        {
+            auto it = m_layer_rasters.find(layer);
+            if (it == m_layer_rasters.end())
+            {
+                continue;
+            }
+            if (std::find(recoloured.cbegin(), recoloured.cend(), it->second) == recoloured.cend() &&
+                m_layer_cache->Find(GetMapLayerKey(map_layer, m_map_previews)) != it->second)
+            {
+                it->second->Recolour({ std::make_shared<Palette>(*room_palette) });
+                recoloured.push_back(it->second);
+            }
+            ApplyLayerOpacity(layer);
+        }
+    }
+    if (m_show_entities || m_show_entity_hitboxes)
+    {
+        RedrawAllSprites();
+    }
+    ForceRedraw();
+}
+
 int RoomViewerCtrl::GetErrorCount() const
 {
     return m_errors.size();
@@ -1706,36 +2351,131 @@ void RoomViewerCtrl::OnDraw(wxDC& dc)
     sy *= m_scroll_rate;
     int sw, sh;
     GetClientSize(&sw, &sh);
+    const wxRect visible = GetVisibleRect();
+    if (!visible.IsEmpty() && !m_render_rect.Contains(visible))
+    {
+        UpdateRenderRect();
+    }
     wxMemoryDC mdc(*m_bmp);
     if (m_redraw)
     {
-        mdc.SetBackground(m_alpha ? *m_alpha_brush : *wxBLACK_BRUSH);
-        mdc.Clear();
-        for (const auto& layer : m_layers)
+        // Tiles outside of the render area keep their dirty flag until they are scrolled into view
+        wxImage tile;
+        for (int ty = m_render_rect.GetTop() / COMPOSITE_TILE_SIZE; ty < m_tiles_high && ty * COMPOSITE_TILE_SIZE <= m_render_rect.GetBottom(); ++ty)
         {
-            if (layer.first == Layer::BACKGROUND1 ||
-                layer.first == Layer::BACKGROUND2 ||
-                layer.first == Layer::FOREGROUND ||
-                layer.first == Layer::BG_SPRITES ||
-                layer.first == Layer::FG_SPRITES)
-            {
-                mdc.SetUserScale(m_zoom, m_zoom);
-            }
-            else
+            for (int tx = m_render_rect.GetLeft() / COMPOSITE_TILE_SIZE; tx < m_tiles_wide && tx * COMPOSITE_TILE_SIZE <= m_render_rect.GetRight(); ++tx)
             {
-                mdc.SetUserScale(1.0, 1.0);
+                if (m_dirty_tiles[ty * m_tiles_wide + tx])
+                {
+                    const wxRect rect = wxRect(tx * COMPOSITE_TILE_SIZE, ty * COMPOSITE_TILE_SIZE,
+                        COMPOSITE_TILE_SIZE, COMPOSITE_TILE_SIZE).Intersect(m_render_rect);
+                    if (!rect.IsEmpty())
+                    {
+                        CompositeTile(tile, rect);
+                        mdc.DrawBitmap(wxBitmap(tile), rect.GetPosition() - m_render_rect.GetPosition());
+                    }
+                    m_dirty_tiles[ty * m_tiles_wide + tx] = false;
+                }
             }
-            mdc.DrawBitmap(*layer.second, 0, 0, true);
         }
         m_redraw = false;
     }
-    mdc.SetUserScale(1.0, 1.0);
     dc.SetBackground(*wxBLACK_BRUSH);
     dc.Clear();
-    dc.Blit(sx, sy, sw, sh, &mdc, sx, sy, wxCOPY);
+    dc.Blit(sx, sy, sw, sh, &mdc, sx - m_render_rect.x, sy - m_render_rect.y, wxCOPY);
     mdc.SelectObject(wxNullBitmap);
 }
 
+void RoomViewerCtrl::CompositeTile(wxImage& tile, const wxRect& rect)
+{
+    const int w = rect.width;
+    const int h = rect.height;
+    if (!tile.IsOk() || tile.GetWidth() != w || tile.GetHeight() != h)
+    {
+        tile = wxImage(w, h, false);
+    }
+    uint8_t* out = tile.GetData();
+    if (m_alpha && m_stipple.IsOk())
+    {
+        const int pw = m_stipple.GetWidth();
+        const int ph = m_stipple.GetHeight();
+        const uint8_t* pattern = m_stipple.GetData();
+        for (int y = 0; y < h; ++y)
+        {
+            const uint8_t* prow = pattern + ((rect.y + y) % ph) * pw * 3;
+            uint8_t* orow = out + y * w * 3;
+            for (int x = 0; x < w; ++x)
+            {
+                std::copy_n(prow + ((rect.x + x) % pw) * 3, 3, orow + x * 3);
+            }
+        }
+    }
+    else
+    {
+        std::fill_n(out, w * h * 3, 0);
+    }
+    std::vector<uint8_t> row_rgb(w * 3);
+    std::vector<uint8_t> row_alpha(w, 0xFF);
+    std::vector<int> src_x(w);
+    for (const auto& [layer, img] : m_layers)
+    {
+        if (!img.IsOk())
+        {
+            continue;
+        }
+        const int iw = img.GetWidth();
+        const int ih = img.GetHeight();
+        const uint8_t* rgb = img.GetData();
+        const uint8_t* alpha = img.HasAlpha() ? img.GetAlpha() : nullptr;
+        if (layer == Layer::BACKGROUND1 ||
+            layer == Layer::BACKGROUND2 ||
+            layer == Layer::FOREGROUND ||
+            layer == Layer::BG_SPRITES ||
+            layer == Layer::FG_SPRITES)
+        {
+            // Tile and sprite layers are stored unscaled - sample them nearest-neighbour
+            int cols = 0;
+            while (cols < w && (src_x[cols] = static_cast<int>((rect.x + cols) / m_zoom)) < iw)
+            {
+                ++cols;
+            }
+            for (int y = 0; y < h; ++y)
+            {
+                const int sy = static_cast<int>((rect.y + y) / m_zoom);
+                if (sy >= ih)
+                {
+                    break;
+                }
+                const uint8_t* srow = rgb + sy * iw * 3;
+                for (int x = 0; x < cols; ++x)
+                {
+                    std::copy_n(srow + src_x[x] * 3, 3, row_rgb.data() + x * 3);
+                    if (alpha != nullptr)
+                    {
+                        row_alpha[x] = alpha[sy * iw + src_x[x]];
+                    }
+                }
+                AlphaBlend::BlendOver(out + y * w * 3, row_rgb.data(), row_alpha.data(), cols);
+            }
+            std::fill(row_alpha.begin(), row_alpha.end(), 0xFF);
+        }
+        else
+        {
+            // Overlays are drawn at the current zoom, and only cover the render area
+            const int ox = rect.x - m_render_rect.x;
+            const int oy = rect.y - m_render_rect.y;
+            const int cols = std::min(w, iw - ox);
+            const int rows = std::min(h, ih - oy);
+            for (int y = 0; y < rows; ++y)
+            {
+                const std::size_t offset = static_cast<std::size_t>(oy + y) * iw + ox;
+                AlphaBlend::BlendOver(out + y * w * 3, rgb + offset * 3,
+                    alpha != nullptr ? alpha + offset : row_alpha.data(), std::max(cols, 0));
+            }
+        }
+    }
+}
+
 void RoomViewerCtrl::OnPaint(wxPaintEvent& /*evt*/)
 {
 	wxBufferedPaintDC dc(this);
@@ -1809,11 +2549,11 @@ void RoomViewerCtrl::UpdateEntityProperties(int entity)
         EntityPropertiesWindow dlg(m_frame, entity, &m_entities[entity - 1], char_names);
         if (dlg.ShowModal() == wxID_OK)
         {
-            m_g->GetSpriteData()->SetRoomEntities(m_roomnum, m_entities);
+            CommitEntities("Edit Entity");
             FireEvent(EVT_ENTITY_UPDATE);
+            RedrawSprite(entity);
             RefreshStatusbar();
-            RedrawAllSprites();
-            ForceRedraw();
+            ForceRepaint();
         }
     }
 }
@@ -2106,6 +2846,9 @@ bool RoomViewerCtrl::HandleNEntityKeyDown(unsigned int key, unsigned int modifie
         return true;
     }
     bool refresh_entities = false;
+    bool reorder_entities = false;
+    // Reordering commits its own step, so it leaves this empty
+    std::string description;
     bool key_handled = false;
     if (IsEntitySelected())
     {
@@ -2117,6 +2860,7 @@ bool RoomViewerCtrl::HandleNEntityKeyDown(unsigned int key, unsigned int modifie
         case 'w':
             ent.SetX(ent.GetX() - 0x80);
             refresh_entities = true;
+            description = "Move Entity";
             key_handled = true;
             break;
         case WXK_DOWN:
@@ -2124,6 +2868,7 @@ bool RoomViewerCtrl::HandleNEntityKeyDown(unsigned int key, unsigned int modifie
         case 's':
             ent.SetX(ent.GetX() + 0x80);
             refresh_entities = true;
+            description = "Move Entity";
             key_handled = true;
             break;
         case WXK_LEFT:
@@ -2131,6 +2876,7 @@ bool RoomViewerCtrl::HandleNEntityKeyDown(unsigned int key, unsigned int modifie
         case 'a':
             ent.SetY(ent.GetY() + 0x80);
             refresh_entities = true;
+            description = "Move Entity";
             key_handled = true;
             break;
         case WXK_RIGHT:
@@ -2138,28 +2884,33 @@ bool RoomViewerCtrl::HandleNEntityKeyDown(unsigned int key, unsigned int modifie
         case 'd':
             ent.SetY(ent.GetY() - 0x80);
             refresh_entities = true;
+            description = "Move Entity";
             key_handled = true;
             break;
         case WXK_PAGEUP:
             ent.SetZ(ent.GetZ() + 0x80);
             refresh_entities = true;
+            description = "Move Entity";
             key_handled = true;
             break;
         case WXK_PAGEDOWN:
             ent.SetZ(ent.GetZ() - 0x80);
             refresh_entities = true;
+            description = "Move Entity";
             key_handled = true;
             break;
         case '+':
             ent.SetType((ent.GetType() + 1) & 0xFF);
             m_g->GetRoomData()->CleanupChests(*m_g);
             refresh_entities = true;
+            description = "Change Entity Type";
             key_handled = true;
             break;
         case '-':
             ent.SetType((ent.GetType() - 1) & 0xFF);
             m_g->GetRoomData()->CleanupChests(*m_g);
             refresh_entities = true;
+            description = "Change Entity Type";
             key_handled = true;
             break;
         case WXK_DELETE:
@@ -2176,6 +2927,7 @@ bool RoomViewerCtrl::HandleNEntityKeyDown(unsigned int key, unsigned int modifie
                 ent.SetOrientation(static_cast<Orientation>(
                     (static_cast<int>(ent.GetOrientation()) + 1) & 0x03));
                 refresh_entities = true;
+                description = "Rotate Entity";
                 key_handled = true;
             }
             else if (modifiers == 0)
@@ -2183,6 +2935,7 @@ bool RoomViewerCtrl::HandleNEntityKeyDown(unsigned int key, unsigned int modifie
                 ent.SetOrientation(static_cast<Orientation>(
                     (static_cast<int>(ent.GetOrientation()) - 1) & 0x03));
                 refresh_entities = true;
+                description = "Rotate Entity";
                 key_handled = true;
             }
             break;
@@ -2192,12 +2945,14 @@ bool RoomViewerCtrl::HandleNEntityKeyDown(unsigned int key, unsigned int modifie
             {
                 ent.SetPalette((ent.GetPalette() + 1) & 0x03);
                 refresh_entities = true;
+                description = "Change Entity Palette";
                 key_handled = true;
             }
             else if (modifiers == 0)
             {
                 ent.SetPalette((ent.GetPalette() - 1) & 0x03);
                 refresh_entities = true;
+                description = "Change Entity Palette";
                 key_handled = true;
             }
             break;
@@ -2209,6 +2964,8 @@ bool RoomViewerCtrl::HandleNEntityKeyDown(unsigned int key, unsigned int modifie
                 m_entities.back().SetX(m_entities.back().GetX() + 0x100);
                 m_selected = m_entities.size();
                 refresh_entities = true;
+                description = "Duplicate Entity";
+                reorder_entities = true;
                 key_handled = true;
             }
             break;
@@ -2218,6 +2975,7 @@ bool RoomViewerCtrl::HandleNEntityKeyDown(unsigned int key, unsigned int modifie
                 DoMoveEntityUp(m_selected);
                 m_selected--;
                 refresh_entities = true;
+                reorder_entities = true;
                 key_handled = true;
             }
             break;
@@ -2227,6 +2985,7 @@ bool RoomViewerCtrl::HandleNEntityKeyDown(unsigned int key, unsigned int modifie
                 DoMoveEntityDown(m_selected);
                 m_selected++;
                 refresh_entities = true;
+                reorder_entities = true;
                 key_handled = true;
             }
             break;
@@ -2238,11 +2997,26 @@ bool RoomViewerCtrl::HandleNEntityKeyDown(unsigned int key, unsigned int modifie
     }
     if (refresh_entities)
     {
-        m_g->GetSpriteData()->SetRoomEntities(m_roomnum, m_entities);
-        RefreshStatusbar();
-        FireEvent(EVT_ENTITY_UPDATE);
-        RedrawAllSprites();
-        ForceRedraw();
+        if (!description.empty())
+        {
+            // Repeated key presses of the same kind are undone together
+            CommitEntities(description, !reorder_entities);
+        }
+        if (reorder_entities)
+        {
+            RefreshStatusbar();
+            FireEvent(EVT_ENTITY_UPDATE);
+            RedrawAllSprites();
+            ForceRedraw();
+        }
+        else
+        {
+            // Only the selected entity has changed, so only the area around it needs redrawing
+            RedrawSprite(m_selected);
+            RefreshStatusbar();
+            FireEvent(EVT_ENTITY_UPDATE);
+            ForceRepaint();
+        }
     }
     return key_handled;
 }
@@ -2395,7 +3169,7 @@ bool RoomViewerCtrl::HandleNWarpKeyDown(unsigned int key, unsigned int modifiers
     }
     if (refresh_warps)
     {
-        m_g->GetRoomData()->SetWarpsForRoom(m_roomnum, m_warps);
+        CommitWarps("Edit Warp", true);
         RefreshStatusbar();
         FireEvent(EVT_WARP_UPDATE);
         m_layers[Layer::WARPS] = DrawRoomWarps(m_roomnum);
@@ -2679,7 +3453,7 @@ void RoomViewerCtrl::DoAddEntity()
     {
         m_entities.push_back(Entity());
         m_selected = m_entities.size();
-        m_g->GetSpriteData()->SetRoomEntities(m_roomnum, m_entities);
+        CommitEntities("Add Entity");
     }
 }
 
@@ -2696,7 +3470,7 @@ void RoomViewerCtrl::DoDeleteEntity(int entity)
         {
             m_selected = m_entities.size();
         }
-        m_g->GetSpriteData()->SetRoomEntities(m_roomnum, m_entities);
+        CommitEntities("Delete Entity");
         m_g->GetRoomData()->CleanupChests(*m_g);
     }
 }
@@ -2706,7 +3480,7 @@ void RoomViewerCtrl::DoMoveEntityUp(int entity)
     if (entity > 1 && entity <= static_cast<int>(m_entities.size()))
     {
         std::swap(m_entities[entity - 1], m_entities[entity - 2]);
-        m_g->GetSpriteData()->SetRoomEntities(m_roomnum, m_entities);
+        CommitEntities("Move Entity Up");
     }
 }
 
@@ -2715,91 +3489,239 @@ void RoomViewerCtrl::DoMoveEntityDown(int entity)
     if (entity > 0 && entity < static_cast<int>(m_entities.size()))
     {
         std::swap(m_entities[entity - 1], m_entities[entity]);
-        m_g->GetSpriteData()->SetRoomEntities(m_roomnum, m_entities);
+        CommitEntities("Move Entity Down");
     }
 }
 
-bool RoomViewerCtrl::CheckMousePosForLink(const std::pair<int, int>& xy, std::wstring& status_text)
+void RoomViewerCtrl::CommitEntities(const std::string& description, bool coalesce)
 {
-    int prev_hover = m_hovered;
-    if (!m_g)
+    auto gd = m_g;
+    const uint16_t roomnum = m_roomnum;
+    auto before = gd->GetSpriteData()->GetRoomEntities(roomnum);
+    auto after = m_entities;
+    gd->GetSpriteData()->SetRoomEntities(roomnum, m_entities);
+    // A room holds at most 15 entities, so keeping both lists is cheaper than diffing them
+    const std::size_t size = (before.size() + after.size()) * sizeof(Entity);
+    m_frame->GetUndoJournal().Push(description, std::make_unique<ActionDelta>(
+        [this, gd, roomnum, before]() { ApplyEntities(gd, roomnum, before); },
+        [this, gd, roomnum, after]() { ApplyEntities(gd, roomnum, after); }, size), coalesce);
+}
+
+void RoomViewerCtrl::CommitWarps(const std::string& description, bool coalesce)
+{
+    auto gd = m_g;
+    const uint16_t roomnum = m_roomnum;
+    auto before = gd->GetRoomData()->GetWarpsForRoom(roomnum);
+    auto after = m_warps;
+    gd->GetRoomData()->SetWarpsForRoom(roomnum, m_warps);
+    const std::size_t size = (before.size() + after.size()) * sizeof(WarpList::Warp);
+    m_frame->GetUndoJournal().Push(description, std::make_unique<ActionDelta>(
+        [this, gd, roomnum, before]() { ApplyWarps(gd, roomnum, before); },
+        [this, gd, roomnum, after]() { ApplyWarps(gd, roomnum, after); }, size), coalesce);
+}
+
+void RoomViewerCtrl::ApplyEntities(std::shared_ptr<GameData> gd, uint16_t roomnum, const std::vector<Entity>& entities)
+{
+    gd->GetSpriteData()->SetRoomEntities(roomnum, entities);
+    if (gd != m_g || roomnum != m_roomnum)
     {
-        return false;
+        return;
+    }
+    m_entities = entities;
+    if (m_selected > ENTITY_IDX_OFFSET && m_selected < LINK_IDX_OFFSET && !IsEntitySelected())
+    {
+        m_selected = NO_SELECTION;
+    }
+    RefreshStatusbar();
+    FireEvent(EVT_ENTITY_UPDATE);
+    RedrawAllSprites();
+    ForceRedraw();
+}
+
+void RoomViewerCtrl::ApplyWarps(std::shared_ptr<GameData> gd, uint16_t roomnum, const std::vector<WarpList::Warp>& warps)
+{
+    gd->GetRoomData()->SetWarpsForRoom(roomnum, warps);
+    if (gd != m_g || roomnum != m_roomnum)
+    {
+        return;
+    }
+    m_warps = warps;
+    if (m_is_warp_pending && std::all_of(m_warps.cbegin(), m_warps.cend(), [](const auto& w) { return w.IsValid(); }))
+    {
+        // The pending warp is only ever held in the working list, as in SetRoomNum
+        m_warps.push_back(m_pending_warp);
+    }
+    if (m_selected > WARP_IDX_OFFSET && m_selected < SWAP_IDX_OFFSET && !IsWarpSelected())
+    {
+        m_selected = NO_SELECTION;
+    }
+    RefreshStatusbar();
+    FireEvent(EVT_WARP_UPDATE);
+    if (m_show_warps)
+    {
+        m_layers[Layer::WARPS] = DrawRoomWarps(m_roomnum);
+    }
+    if (m_show_swaps)
+    {
+        m_layers[Layer::SWAPS] = DrawRoomSwaps(m_roomnum);
+    }
+    ForceRedraw();
+}
+
+void RoomViewerCtrl::UpdateHitIndex()
+{
+    if (m_hit_index_valid)
+    {
+        return;
     }
+    // Regions are inserted in hover priority order, so the first candidate that passes
+    // the exact test is the same region a linear scan would have found
+    m_hit_index.Clear();
     for (const auto& wp : m_warp_poly)
     {
-        if (Pnpoly(wp.second, xy.first, xy.second))
-        {
-            const auto& warp = m_warps.at(wp.first);
-            uint16_t room = (warp.room1 == m_roomnum) ? warp.room2 : warp.room1;
-            uint8_t wx = (warp.room1 == m_roomnum) ? warp.x2 : warp.x1;
-            uint8_t wy = (warp.room1 == m_roomnum) ? warp.y2 : warp.y1;
-            std::wstring display_name = m_g->GetRoomData()->GetRoom(room)->GetDisplayName();
-            status_text += StrWPrintf(L" - Right Click: Warp to room %03d (%d,%d) (%ls)", room, wx, wy, display_name.c_str());
-            m_hovered = WARP_IDX_OFFSET + wp.first + 1;
-            return m_hovered != prev_hover;
-        }
+        m_hit_index.Insert(WARP_IDX_OFFSET + wp.first + 1, wp.second);
     }
     int i = 0;
     for (auto it = m_link_poly.cbegin(); it != m_link_poly.cend(); ++i, ++it)
     {
-        if (Pnpoly(it->second, xy.first, xy.second))
-        {
-            std::wstring display_name = m_g->GetRoomData()->GetRoom(it->first)->GetDisplayName();
-            status_text += StrWPrintf(L" - Right Click: Warp to room %03d (%ls)", it->first, display_name.c_str());
-            m_hovered = LINK_IDX_OFFSET + i;
-            return m_hovered != prev_hover;
-        }
+        m_hit_index.Insert(LINK_IDX_OFFSET + i, it->second);
     }
     for (const auto& ep : m_entity_poly)
     {
-        if (Pnpoly(ep.second, xy.first, xy.second))
-        {
-            SetCursor(wxStockCursor::wxCURSOR_HAND);
-            m_hovered = ENTITY_IDX_OFFSET + ep.first;
-            status_text += StrWPrintf(L" - Entity %d (%ls)", ep.first, m_entities.at(ep.first - 1).GetTypeName().c_str());
-            return m_hovered != prev_hover;
-        }
+        m_hit_index.Insert(ENTITY_IDX_OFFSET + ep.first, ep.second);
     }
     for (i = 0; i < static_cast<int>(m_swap_regions.size()); ++i)
     {
-        const auto& [sp, dp] = m_swap_regions.at(i);
-        if (Pnpoly(sp, xy.first, xy.second) || Pnpoly(dp, xy.first, xy.second))
+        m_hit_index.Insert(SWAP_IDX_OFFSET + i + 1, m_swap_regions[i].first);
+        m_hit_index.Insert(SWAP_IDX_OFFSET + i + 1, m_swap_regions[i].second);
+    }
+    for (i = 0; i < static_cast<int>(m_door_regions.size()); ++i)
+    {
+        m_hit_index.Insert(DOOR_IDX_OFFSET + i + 1, m_door_regions[i].second);
+    }
+    m_hit_index_valid = true;
+}
+
+int RoomViewerCtrl::HitTest(int x, int y)
+{
+    UpdateHitIndex();
+    for (int id : m_hit_index.GetCandidates(x, y))
+    {
+        if (id > DOOR_IDX_OFFSET)
         {
-            m_hovered = SWAP_IDX_OFFSET + i + 1;
-            if (m_hovered != prev_hover)
+            if (Pnpoly(m_door_regions[id - DOOR_IDX_OFFSET - 1].second, x, y))
             {
-                UpdateLayer(Layer::SWAPS, DrawRoomSwaps(m_roomnum));
-                m_redraw = true;
-                m_repaint = true;
+                return id;
             }
-            status_text += StrWPrintf(L" - Tile Swap (%d)", i + 1);
-            return m_hovered != prev_hover;
         }
-    }
-    for (i = 0; i < static_cast<int>(m_door_regions.size()); ++i)
-    {
-        const auto& [valid, dp] = m_door_regions.at(i);
-        if (Pnpoly(dp, xy.first, xy.second))
+        else if (id > SWAP_IDX_OFFSET)
+        {
+            const auto& [sp, dp] = m_swap_regions[id - SWAP_IDX_OFFSET - 1];
+            if (Pnpoly(sp, x, y) || Pnpoly(dp, x, y))
+            {
+                return id;
+            }
+        }
+        else if (id > WARP_IDX_OFFSET)
+        {
+            auto it = std::find_if(m_warp_poly.cbegin(), m_warp_poly.cend(), [&](const auto& wp)
+                {
+                    return wp.first == id - WARP_IDX_OFFSET - 1;
+                });
+            if (it != m_warp_poly.cend() && Pnpoly(it->second, x, y))
+            {
+                return id;
+            }
+        }
+        else if (id >= LINK_IDX_OFFSET)
+        {
+            if (Pnpoly(m_link_poly[id - LINK_IDX_OFFSET].second, x, y))
+            {
+                return id;
+            }
+        }
+        else
         {
-            m_hovered = DOOR_IDX_OFFSET + i + 1;
-            if (m_hovered != prev_hover)
+            auto it = std::find_if(m_entity_poly.cbegin(), m_entity_poly.cend(), [&](const auto& ep)
+                {
+                    return ep.first == id - ENTITY_IDX_OFFSET;
+                });
+            if (it != m_entity_poly.cend() && Pnpoly(it->second, x, y))
             {
-                UpdateLayer(Layer::SWAPS, DrawRoomSwaps(m_roomnum));
-                m_redraw = true;
-                m_repaint = true;
+                return id;
             }
-            status_text += StrWPrintf(L" - Door (%d)", i + 1);
-            return m_hovered != prev_hover;
         }
     }
+    return NO_SELECTION;
+}
+
+bool RoomViewerCtrl::CheckMousePosForLink(const std::pair<int, int>& xy, std::wstring& status_text)
+{
+    int prev_hover = m_hovered;
+    if (!m_g)
+    {
+        return false;
+    }
+    const int hit = HitTest(xy.first, xy.second);
+    if (hit > DOOR_IDX_OFFSET)
+    {
+        const int i = hit - DOOR_IDX_OFFSET - 1;
+        m_hovered = hit;
+        if (m_hovered != prev_hover)
+        {
+            RedrawRegion(prev_hover);
+            RedrawRegion(m_hovered);
+            m_repaint = true;
+        }
+        status_text += StrWPrintf(L" - Door (%d)", i + 1);
+        return m_hovered != prev_hover;
+    }
+    else if (hit > SWAP_IDX_OFFSET)
+    {
+        const int i = hit - SWAP_IDX_OFFSET - 1;
+        m_hovered = hit;
+        if (m_hovered != prev_hover)
+        {
+            RedrawRegion(prev_hover);
+            RedrawRegion(m_hovered);
+            m_repaint = true;
+        }
+        status_text += StrWPrintf(L" - Tile Swap (%d)", i + 1);
+        return m_hovered != prev_hover;
+    }
+    else if (hit > WARP_IDX_OFFSET)
+    {
+        const auto& warp = m_warps.at(hit - WARP_IDX_OFFSET - 1);
+        uint16_t room = (warp.room1 == m_roomnum) ? warp.room2 : warp.room1;
+        uint8_t wx = (warp.room1 == m_roomnum) ? warp.x2 : warp.x1;
+        uint8_t wy = (warp.room1 == m_roomnum) ? warp.y2 : warp.y1;
+        std::wstring display_name = m_g->GetRoomData()->GetRoom(room)->GetDisplayName();
+        status_text += StrWPrintf(L" - Right Click: Warp to room %03d (%d,%d) (%ls)", room, wx, wy, display_name.c_str());
+        m_hovered = hit;
+        return m_hovered != prev_hover;
+    }
+    else if (hit >= LINK_IDX_OFFSET)
+    {
+        const uint16_t room = m_link_poly[hit - LINK_IDX_OFFSET].first;
+        std::wstring display_name = m_g->GetRoomData()->GetRoom(room)->GetDisplayName();
+        status_text += StrWPrintf(L" - Right Click: Warp to room %03d (%ls)", room, display_name.c_str());
+        m_hovered = hit;
+        return m_hovered != prev_hover;
+    }
+    else if (hit != NO_SELECTION)
+    {
+        SetCursor(wxStockCursor::wxCURSOR_HAND);
+        m_hovered = hit;
+        const int entity = hit - ENTITY_IDX_OFFSET;
+        status_text += StrWPrintf(L" - Entity %d (%ls)", entity, m_entities.at(entity - 1).GetTypeName().c_str());
+        return m_hovered != prev_hover;
+    }
     if (m_hovered != NO_SELECTION)
     {
         m_hovered = NO_SELECTION;
         if (prev_hover >= SWAP_IDX_OFFSET)
         {
-            UpdateLayer(Layer::SWAPS, DrawRoomSwaps(m_roomnum));
-            m_redraw = true;
+            RedrawRegion(prev_hover);
             m_repaint = true;
         }
         return m_hovered != prev_hover;
@@ -2946,10 +3868,9 @@ void RoomViewerCtrl::ClearAllPreviews()
 
 void RoomViewerCtrl::InitialiseBrushesAndPens()
 {
-    m_alpha_brush = std::make_unique<wxBrush>();
-    m_stipple = std::make_unique<wxBitmap>(6, 6);
+    wxBitmap stipple(6, 6);
     std::unique_ptr<wxMemoryDC> imagememDC(new wxMemoryDC());
-    imagememDC->SelectObject(*m_stipple);
+    imagememDC->SelectObject(stipple);
     imagememDC->SetBackground(*wxGREY_BRUSH);
     imagememDC->Clear();
     imagememDC->SetBrush(*wxLIGHT_GREY_BRUSH);
@@ -2957,8 +3878,8 @@ void RoomViewerCtrl::InitialiseBrushesAndPens()
     imagememDC->DrawRectangle(0, 0, 3, 3);
     imagememDC->DrawRectangle(3, 3, 5, 5);
     imagememDC->SelectObject(wxNullBitmap);
-    m_alpha_brush->SetStyle(wxBRUSHSTYLE_STIPPLE_MASK);
-    m_alpha_brush->SetStipple(*m_stipple);
+    // The checkerboard is tiled under transparent areas when compositing
+    m_stipple = stipple.ConvertToImage();
 }
 
 void RoomViewerCtrl::OnLeftDblClick(wxMouseEvent& evt)
@@ -3,10 +3,16 @@
 
 #include <wx/wx.h>
 #include <wx/window.h>
+#include <array>
 #include <memory>
 #include <cstdint>
+#include <future>
+#include <map>
+#include <tuple>
 #include <landstalker/main/GameData.h>
 #include <main/ImageBufferWx.h>
+#include <rooms/RegionIndex.h>
+#include <rooms/RoomRenderCache.h>
 #include <rooms/RoomViewerFrame.h>
 
 class RoomViewerCtrl : public wxScrolledCanvas
@@ -92,6 +98,11 @@ public:
 	void RefreshGraphics();
 	void RefreshHeightmap();
 	void RefreshLayers();
+	// Drops cached rasters for this room, e.g. before reopening it after its map, tileset,
+	// blocksets or palette were changed
+	void InvalidateLayerCache(bool previews_only = false);
+	// Picks up edits to a palette's colours without rasterising the room again
+	void RecolourPalette(const Landstalker::Palette* palette);
 
 	int GetErrorCount() const;
 	std::string GetErrorText(int errnum) const;
@@ -113,6 +124,27 @@ private:
 		bool background;
 		std::shared_ptr<Landstalker::SpriteFrame> frame;
 		Landstalker::Entity entity;
+		int hitbox_base;
+		int hitbox_height;
+	};
+	using LayerRaster = RoomRenderCache::Raster;
+	using LayerRasters = std::map<Layer, std::shared_ptr<LayerRaster>>;
+	// Room palette, sprite palette allocations, player palette and HUD palette
+	using PaletteSetKey = std::tuple<std::shared_ptr<Landstalker::Palette>, std::array<int, 3>,
+		std::shared_ptr<Landstalker::Palette>, std::shared_ptr<Landstalker::Palette>>;
+	using PendingMapLayers = std::map<Landstalker::Tilemap3D::Layer, std::future<std::shared_ptr<LayerRaster>>>;
+	struct HeightmapCell
+	{
+		enum class Border : uint8_t
+		{
+			NONE,
+			DOOR,
+			SWAP_SRC,
+			SWAP_DST
+		};
+		// Cell to display here, after any previewed tileswaps have been applied
+		Landstalker::HMPoint2D src;
+		Border border;
 	};
 	enum class Action
 	{
@@ -122,33 +154,73 @@ private:
 	};
 	void DrawRoom(uint16_t roomnum);
 	void RefreshRoom(bool redraw_tiles = false);
+	RoomRenderCache::Key GetMapLayerKey(Landstalker::Tilemap3D::Layer layer, bool previews) const;
+	std::future<std::shared_ptr<LayerRaster>> GetMapLayerRasterAsync(Landstalker::Tilemap3D::Layer layer, bool previews);
+	PendingMapLayers RenderMapLayersAsync(bool previews);
+	void UpdateMapLayers(bool previews);
+	void UpdateMapLayers(PendingMapLayers pending);
+	void UpdateHeightmapLayer(std::shared_ptr<Landstalker::Tilemap3D> map);
+	void ApplyLayerOpacity(const Layer& layer);
+	void ApplyLayerOpacity(const Layer& layer, const wxRect& rect);
+	void PrefetchAdjacentRooms();
 	std::vector<std::shared_ptr<Landstalker::Palette>> PreparePalettes(uint16_t roomnum);
 	std::vector<SpriteQ> PrepareSprites(uint16_t roomnum);
-	void DrawSprites(const std::vector<SpriteQ>& q);
+	SpriteQ MakeSpriteQ(int id, const Landstalker::Entity& entity, std::shared_ptr<Landstalker::Tilemap3D> map);
+	static bool SpriteDrawOrder(const SpriteQ& lhs, const SpriteQ& rhs);
+	wxRect GetSpriteBounds(const SpriteQ& s) const;
+	static void DrawSprites(const std::vector<SpriteQ>& q, ImageBufferWx& bg_buf, ImageBufferWx& fg_buf);
 	void DrawSpriteHitboxes(const std::vector<SpriteQ>& q);
 	void AddEntityClickRegions(const std::vector<SpriteQ>& q);
 	void RedrawAllSprites();
-	void UpdateLayer(const Layer& layer, std::unique_ptr<wxBitmap> bmp);
+	void PrepareAllSprites();
+	std::vector<Layer> GetVisibleSpriteLayers() const;
+	static LayerRasters RasteriseSprites(std::vector<SpriteQ> q, std::vector<std::shared_ptr<Landstalker::Palette>> palette,
+		int width, int height, std::vector<Layer> layers);
+	void UpdateSpriteLayers(LayerRasters rasters);
+	void RedrawSprite(int entity);
+	void RedrawSpriteRect(const wxRect& rect);
 	void UpdateLayer(const Layer& layer, const wxImage& image);
 	void RefreshStatusbar();
+	// Write the working entity or warp list back to the game data and record the change for undo
+	void CommitEntities(const std::string& description, bool coalesce = false);
+	void CommitWarps(const std::string& description, bool coalesce = false);
+	void ApplyEntities(std::shared_ptr<Landstalker::GameData> gd, uint16_t roomnum, const std::vector<Landstalker::Entity>& entities);
+	void ApplyWarps(std::shared_ptr<Landstalker::GameData> gd, uint16_t roomnum, const std::vector<Landstalker::WarpList::Warp>& warps);
 
 	void UpdateRoomDescText(uint16_t roomnum);
-	std::unique_ptr<wxBitmap> DrawRoomWarps(uint16_t roomnum);
+	wxImage DrawRoomWarps(uint16_t roomnum);
 	void DrawWarp(wxGraphicsContext& gc, int index, std::shared_ptr<Landstalker::Tilemap3D> map, int tile_width, int tile_height, bool adjust_z = false);
 	void AddRoomLink(wxGraphicsContext* gc, const std::wstring& label, uint16_t room, int x, int y);
-	std::unique_ptr<wxBitmap> DrawHeightmapVisualisation(std::shared_ptr<Landstalker::Tilemap3D> map, uint8_t opacity);
+	wxImage DrawHeightmapVisualisation(std::shared_ptr<Landstalker::Tilemap3D> map);
+	void UpdateHeightmapCellGrid(std::shared_ptr<Landstalker::Tilemap3D> map);
+	const wxImage& GetHeightmapCellSprite(int z, int restrictions, int classification, HeightmapCell::Border border);
+	void DrawHeightmapCellSprite(wxImage& image, const wxImage& sprite, int x, int y);
+	int GetHeightmapSpriteMargin() const;
 	void DrawHeightmapCell(wxGraphicsContext& gc, int x, int y, int z, int width, int height, int restrictions,
 		int classification, bool draw_walls = true, wxColor border_colour = *wxWHITE);
 	void DrawTileSwaps(wxGraphicsContext& dc, uint16_t roomnum);
 	void DrawDoors(wxGraphicsContext& dc, uint16_t roomnum);
-	std::unique_ptr<wxBitmap> DrawRoomSwaps(uint16_t roomnum);
+	wxImage DrawRoomSwaps(uint16_t roomnum);
 	std::vector<wxPoint2DDouble> ToWxPoints2DDouble(const std::vector<std::pair<int, int>>& points);
 	std::pair<int, int> GetScreenPosition(const std::pair<int, int>& iso_pos, uint16_t roomnum, Landstalker::Tilemap3D::Layer layer) const;
 	void ForceRepaint();
 	void ForceRedraw();
+	void MarkDirty(const wxRect& rect);
+	void MarkAllDirty();
+	void MarkRegionDirty(int index);
+	std::vector<wxRect> GetRegionRects(int index) const;
+	void RedrawRegion(int index);
+	wxRect GetPolyBounds(const std::vector<wxPoint2DDouble>& poly) const;
+	void CompositeTile(wxImage& tile, const wxRect& rect);
 	void SetOpacity(wxImage& image, uint8_t opacity);
 	void UpdateScroll();
 	void UpdateBuffer();
+	wxRect GetVisibleRect() const;
+	wxRect GetRenderRect(const wxRect& visible) const;
+	void UpdateRenderRect();
+	void RedrawOverlays();
+	wxImage CreateOverlayImage() const;
+	wxGraphicsContext* CreateOverlayContext(wxImage& img) const;
 	void RedrawRoom();
 	bool Pnpoly(const std::vector<wxPoint2DDouble>& poly, int x, int y);
 	void GoToRoom(uint16_t room);
@@ -156,6 +228,8 @@ private:
 	void DoDeleteEntity(int entity);
 	void DoMoveEntityUp(int entity);
 	void DoMoveEntityDown(int entity);
+	void UpdateHitIndex();
+	int HitTest(int x, int y);
 	bool CheckMousePosForLink(const std::pair<int, int>& xy, std::wstring& status_text);
 	bool UpdateSelection(int new_selection, Action action);
 
@@ -211,10 +285,24 @@ private:
 	bool m_is_warp_pending;
 	Landstalker::WarpList::Warp m_pending_warp;
 
-	std::map<Layer, std::shared_ptr<ImageBufferWx>> m_layer_bufs;
-	std::map<Layer, std::shared_ptr<wxBitmap>> m_layers;
+	std::map<Layer, wxImage> m_layers;
 	std::map<Layer, uint8_t> m_layer_opacity;
+	std::map<Layer, std::shared_ptr<LayerRaster>> m_layer_rasters;
+	std::unique_ptr<RoomRenderCache> m_layer_cache;
+	bool m_map_previews;
+	std::vector<HeightmapCell> m_hm_cells;
+	std::vector<int> m_hm_cells_previews;
+	std::map<std::tuple<int, int, int, HeightmapCell::Border>, wxImage> m_hm_cell_atlas;
+	double m_hm_atlas_zoom;
+	std::vector<SpriteQ> m_sprite_q;
+	std::map<std::pair<uint8_t, int>, std::shared_ptr<Landstalker::SpriteFrame>> m_sprite_frames;
+	std::array<int, 3> m_sprite_palette_alloc;
+	std::map<PaletteSetKey, std::vector<std::shared_ptr<Landstalker::Palette>>> m_palette_sets;
 	std::unique_ptr<wxBitmap> m_bmp;
+	wxRect m_render_rect;
+	std::vector<bool> m_dirty_tiles;
+	int m_tiles_wide;
+	int m_tiles_high;
 	std::vector<Landstalker::Entity> m_entities;
 	std::vector<Landstalker::WarpList::Warp> m_warps;
 	std::vector<Landstalker::Door> m_doors;
@@ -224,13 +312,14 @@ private:
 	std::list<int> m_preview_swaps;
 	std::list<int> m_preview_doors;
 
-	std::unique_ptr<wxBrush> m_alpha_brush;
-	std::unique_ptr<wxBitmap> m_stipple;
+	wxImage m_stipple;
 
 	std::unique_ptr<wxBrush> m_warp_brush;
 	std::list<std::pair<int, std::vector<wxPoint2DDouble>>> m_warp_poly;
 	std::vector<std::pair<uint16_t, std::vector<wxPoint2DDouble>>> m_link_poly;
 	std::list<std::pair<int, std::vector<wxPoint2DDouble>>> m_entity_poly;
+	RegionIndex m_hit_index;
+	bool m_hit_index_valid;
 
 	static const std::size_t TILE_WIDTH = 32;
 	static const std::size_t TILE_HEIGHT = 16;
@@ -239,6 +328,9 @@ private:
 	static const std::size_t CELL_WIDTH = 16;
 	static const std::size_t CELL_HEIGHT = 16;
 	static const int SCROLL_RATE = 8;
+	static const int COMPOSITE_TILE_SIZE = 192;
+	static const int RENDER_MARGIN = COMPOSITE_TILE_SIZE;
+	static const int HM_CELL_SPRITE_MARGIN = 4;
 	static const int NO_SELECTION = -1;
 	static const int ENTITY_IDX_OFFSET = 0;
 	static const int LINK_IDX_OFFSET = 0x100;
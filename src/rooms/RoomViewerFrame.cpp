@@ -1,8 +1,16 @@
 #include <rooms/RoomViewerFrame.h>
 
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <set>
 #include <sstream>
-#include <wx/busyinfo.h>
+#include <thread>
 #include <wx/dir.h>
 #include <wx/progdlg.h>
 #include <rooms/FlagDialog.h>
@@ -14,6 +22,8 @@
 #include <landstalker/3d_maps/MapToTmx.h>
 #include <landstalker/3d_maps/RoomToTmx.h>
 #include <rooms/RoomViewerCtrl.h>
+#include <rooms/RoomRenderCache.h>
+#include <rooms/TmxExportPlan.h>
 
 enum MENU_IDS
 {
@@ -254,6 +264,14 @@ void RoomViewerFrame::UpdateFrame()
 	FireEvent(EVT_PROPERTIES_UPDATE);
 }
 
+void RoomViewerFrame::ReloadRoom()
+{
+	// Cached rasters are keyed by room number, so they have to go once the room's map,
+	// tileset, blocksets or palette change
+	m_roomview->InvalidateLayerCache();
+	UpdateFrame();
+}
+
 void RoomViewerFrame::SetGameData(std::shared_ptr<Landstalker::GameData> gd)
 {
 	m_g = gd;
@@ -282,12 +300,29 @@ void RoomViewerFrame::SetGameData(std::shared_ptr<Landstalker::GameData> gd)
 		m_swapctrl->SetGameData(gd);
 	}
 	m_mode = RoomEdit::Mode::NORMAL;
+	m_journal.Clear();
 	UpdateFrame();
 }
 
+void RoomViewerFrame::RecolourPalette(const Landstalker::Palette* palette)
+{
+	if (m_g == nullptr)
+	{
+		return;
+	}
+	m_roomview->RecolourPalette(palette);
+	m_bgedit->RecolourPalette(palette);
+	m_fgedit->RecolourPalette(palette);
+	if (m_blkctrl->GetPalette() != nullptr && (palette == nullptr || palette == m_blkctrl->GetPalette().get()))
+	{
+		m_blkctrl->RedrawTiles();
+	}
+}
+
 void RoomViewerFrame::ClearGameData()
 {
 	m_g = nullptr;
+	m_journal.Clear();
 	if (m_roomview)
 	{
 		m_roomview->ClearGameData();
@@ -329,6 +364,8 @@ void RoomViewerFrame::SetRoomNum(uint16_t roomnum)
 	if (m_roomnum != roomnum)
 	{
 		m_reset_props = true;
+		// History is kept per room, so that undo never changes a room that isn't on screen
+		m_journal.Clear();
 	}
 	m_roomnum = roomnum;
 	m_blkctrl->SetBlockSelection(0);
@@ -419,17 +456,12 @@ bool RoomViewerFrame::ExportAllCsv(const std::string& dir)
 	return true;
 }
 
-bool RoomViewerFrame::ExportTmx(const std::string& tmx_path, const std::string& bs_path, uint16_t roomnum)
+static bool ExportBlocksetPng(const std::string& path, const Tileset& tileset, const Blockset& blockset, const std::vector<std::shared_ptr<Palette>>& palette)
 {
-	auto map = m_g->GetRoomData()->GetMapForRoom(roomnum)->GetData();
-	auto blocksets = m_g->GetRoomData()->GetCombinedBlocksetForRoom(roomnum);
-	auto palette = std::vector<std::shared_ptr<Palette>>{ m_g->GetRoomData()->GetPaletteForRoom(roomnum)->GetData() };
-	auto tileset = m_g->GetRoomData()->GetTilesetForRoom(roomnum)->GetData();
-
 	const int width = 16;
 	const int height = 64;
-	int blockwidth = MapBlock::GetBlockWidth() * tileset->GetTileWidth();
-	int blockheight = MapBlock::GetBlockHeight() * tileset->GetTileHeight();
+	int blockwidth = MapBlock::GetBlockWidth() * tileset.GetTileWidth();
+	int blockheight = MapBlock::GetBlockHeight() * tileset.GetTileHeight();
 	int pixelwidth = blockwidth * width;
 	int pixelheight = blockheight * height;
 	ImageBufferWx buf(pixelwidth, pixelheight);
@@ -438,9 +470,9 @@ bool RoomViewerFrame::ExportTmx(const std::string& tmx_path, const std::string&
 	{
 		for (int x = 0; x < pixelwidth; x += blockwidth, ++i)
 		{
-			if (i < blocksets->size())
+			if (i < blockset.size())
 			{
-				buf.InsertBlock(x, y, 0, blocksets->at(i), *tileset);
+				buf.InsertBlock(x, y, 0, blockset.at(i), tileset);
 			}
 			else
 			{
@@ -448,95 +480,182 @@ bool RoomViewerFrame::ExportTmx(const std::string& tmx_path, const std::string&
 			}
 		}
 	}
-	buf.WritePNG(bs_path, { palette }, true);
+	return buf.WritePNG(path, palette, true);
+}
+
+bool RoomViewerFrame::ExportTmx(const std::string& tmx_path, const std::string& bs_path, uint16_t roomnum)
+{
+	auto blocksets = m_g->GetRoomData()->GetCombinedBlocksetForRoom(roomnum);
+	auto palette = std::vector<std::shared_ptr<Palette>>{ m_g->GetRoomData()->GetPaletteForRoom(roomnum)->GetData() };
+	auto tileset = m_g->GetRoomData()->GetTilesetForRoom(roomnum)->GetData();
+
+	ExportBlocksetPng(bs_path, *tileset, *blocksets, palette);
 	return MapToTmx::ExportToTmx(tmx_path, *m_g->GetRoomData()->GetMapForRoom(roomnum)->GetData(), bs_path);
 }
 
 bool RoomViewerFrame::ExportAllTmx(const std::string& dir)
 {
-	wxString curdir = wxGetCwd();
-	wxSetWorkingDirectory(dir);
-	std::filesystem::path mappath(dir);
-	std::filesystem::path bspath(mappath / "blocksets");
-	std::filesystem::create_directories(bspath);
-	auto dialog = wxProgressDialog("Export", "Exporting Maps", m_g->GetRoomData()->GetRoomCount(), this);
-	std::set<std::string> exported;
-	for (std::size_t i = 0; i < m_g->GetRoomData()->GetRoomCount(); ++i)
-	{
-		auto rd = m_g->GetRoomData()->GetRoom(i);
-		std::string mapfile = rd->map + ".tmx";
-		if (exported.find(rd->map) != exported.cend())
-		{
-			continue;
-		}
-		std::string blkname = StrPrintf("BT%02d_%01d%01d_p%02d.png", rd->tileset + 1, rd->pri_blockset, rd->sec_blockset + 1, rd->room_palette + 1);
-		std::string blkpath = "blocksets";
-		blkpath += wxString(wxFileName::GetPathSeparator()).ToStdString() + blkname;
-		dialog.Update(i, "Exporting " + rd->map + "...");
-		wxYield();
-		ExportTmx(mapfile, blkpath, i);
-		exported.insert(rd->map);
-	}
-	wxSetWorkingDirectory(curdir);
-	return true;
+	return ExportTmxBatch(dir, false);
 }
 
 bool RoomViewerFrame::ExportRoomTmx(const std::string& tmx_path, const std::string& bs_path, uint16_t roomnum)
 {
-	auto map = m_g->GetRoomData()->GetMapForRoom(roomnum)->GetData();
 	auto blocksets = m_g->GetRoomData()->GetCombinedBlocksetForRoom(roomnum);
 	auto palette = std::vector<std::shared_ptr<Palette>>{ m_g->GetRoomData()->GetPaletteForRoom(roomnum)->GetData() };
 	auto tileset = m_g->GetRoomData()->GetTilesetForRoom(roomnum)->GetData();
 
-	const int width = 16;
-	const int height = 64;
-	int blockwidth = MapBlock::GetBlockWidth() * tileset->GetTileWidth();
-	int blockheight = MapBlock::GetBlockHeight() * tileset->GetTileHeight();
-	int pixelwidth = blockwidth * width;
-	int pixelheight = blockheight * height;
-	ImageBufferWx buf(pixelwidth, pixelheight);
-	std::size_t i = 0;
-	for (int y = 0; y < pixelheight; y += blockheight)
+	ExportBlocksetPng(bs_path, *tileset, *blocksets, palette);
+	return RoomToTmx::ExportToTmx(tmx_path, roomnum, m_g, bs_path);
+}
+
+bool RoomViewerFrame::ExportAllRoomsTmx(const std::string& dir)
+{
+	return ExportTmxBatch(dir, true);
+}
+
+bool RoomViewerFrame::ExportTmxBatch(const std::string& dir, bool rooms)
+{
+	// All paths are absolute, so the working directory is left alone. The TMX files still
+	// refer to their blockset images relative to themselves.
+	const std::filesystem::path outdir = std::filesystem::absolute(dir);
+	std::filesystem::create_directories(outdir / "blocksets");
+
+	std::vector<TmxExportPlan::Room> room_list;
+	for (std::size_t i = 0; i < m_g->GetRoomData()->GetRoomCount(); ++i)
 	{
-		for (int x = 0; x < pixelwidth; x += blockwidth, ++i)
+		auto rd = m_g->GetRoomData()->GetRoom(i);
+		room_list.push_back({ static_cast<uint16_t>(i), rd->name, rd->map,
+			StrPrintf("BT%02d_%01d%01d_p%02d.png", rd->tileset + 1, rd->pri_blockset, rd->sec_blockset + 1, rd->room_palette + 1) });
+	}
+	const TmxExportPlan plan(room_list, rooms);
+
+	// The blockset images (and map TMX files) are written by a pool of workers from private
+	// copies of the data they need, each paired with the file it writes
+	std::map<uint16_t, RoomRenderCache::RoomSources> sources;
+	auto get_sources = [&](uint16_t roomnum) -> const RoomRenderCache::RoomSources&
+	{
+		auto it = sources.find(roomnum);
+		if (it == sources.end())
+		{
+			it = sources.emplace(roomnum, RoomRenderCache::GetRoomSources(m_g, roomnum)).first;
+		}
+		return it->second;
+	};
+	std::vector<std::pair<std::string, std::function<bool()>>> jobs;
+	for (const auto& bs : plan.GetBlocksets())
+	{
+		const std::string path = (outdir / "blocksets" / bs.name).string();
+		jobs.push_back({ path, [src = get_sources(bs.roomnum), path]()
+			{
+				return ExportBlocksetPng(path, *src.tileset, *src.blockset, src.palette);
+			} });
+	}
+	if (!rooms)
+	{
+		for (const auto& tmx : plan.GetTmxFiles())
+		{
+			const std::string path = (outdir / tmx.name).string();
+			const std::string blkpath = (std::filesystem::path("blocksets") / tmx.blockset).string();
+			jobs.push_back({ path, [src = get_sources(tmx.roomnum), path, blkpath]()
+				{
+					return MapToTmx::ExportToTmx(path, *src.map, blkpath);
+				} });
+		}
+	}
+
+	const std::size_t room_count = rooms ? plan.GetTmxFiles().size() : 0;
+	const int total = static_cast<int>(jobs.size() + room_count);
+	auto dialog = wxProgressDialog("Export", rooms ? "Exporting Rooms" : "Exporting Maps", std::max(total, 1), this,
+		wxPD_APP_MODAL | wxPD_AUTO_HIDE | wxPD_CAN_ABORT | wxPD_ELAPSED_TIME);
+	std::atomic<std::size_t> next(0);
+	std::atomic<int> done(0);
+	std::atomic<bool> cancelled(false);
+	std::mutex failures_mutex;
+	std::vector<std::string> failures;
+	auto worker = [&]()
+	{
+		// Exceptions are left to the future, and reported once the workers are done
+		for (std::size_t j = next++; j < jobs.size() && !cancelled; j = next++)
 		{
-			if (i < blocksets->size())
+			if (!jobs[j].second())
 			{
-				buf.InsertBlock(x, y, 0, blocksets->at(i), *tileset);
+				std::lock_guard<std::mutex> lock(failures_mutex);
+				failures.push_back(jobs[j].first);
 			}
-			else
+			++done;
+		}
+	};
+	std::vector<std::future<void>> workers;
+	const std::size_t threads = std::min<std::size_t>(std::max(1U, std::thread::hardware_concurrency()), jobs.size());
+	for (std::size_t t = 0; t < threads; ++t)
+	{
+		workers.push_back(std::async(std::launch::async, worker));
+	}
+
+	// Room TMX files are built from the live game data, so they are written here while the
+	// workers get on with the images
+	std::ostringstream errorss;
+	if (rooms)
+	{
+		for (const auto& tmx : plan.GetTmxFiles())
+		{
+			if (cancelled || !dialog.Update(done, Landstalker::StrWPrintf("Exporting %s...", m_g->GetRoomData()->GetRoomDisplayName(tmx.roomnum).c_str())))
 			{
+				cancelled = true;
 				break;
 			}
+			const std::string path = (outdir / tmx.name).string();
+			try
+			{
+				if (!RoomToTmx::ExportToTmx(path, tmx.roomnum, m_g, (std::filesystem::path("blocksets") / tmx.blockset).string()))
+				{
+					errorss << "Unable to write " << path << std::endl;
+				}
+			}
+			catch (const std::exception& e)
+			{
+				errorss << path << ": " << e.what() << std::endl;
+			}
+			++done;
 		}
 	}
-	buf.WritePNG(bs_path, { palette }, true);
-
-	return RoomToTmx::ExportToTmx(tmx_path, roomnum, m_g, bs_path);
-}
-
-bool RoomViewerFrame::ExportAllRoomsTmx(const std::string& dir)
-{
-	wxBusyInfo wait("Exporting...");
-	wxString curdir = wxGetCwd();
-	wxSetWorkingDirectory(dir);
-	std::filesystem::path mappath(dir);
-	std::filesystem::path bspath(mappath / "blocksets");
-	std::filesystem::create_directories(bspath);
-	auto dialog = wxProgressDialog("Export", "Exporting Rooms", m_g->GetRoomData()->GetRoomCount(), this);
-	for (std::size_t i = 0; i < m_g->GetRoomData()->GetRoomCount(); ++i)
+	for (auto& w : workers)
 	{
-		auto rd = m_g->GetRoomData()->GetRoom(i);
-		std::string roomfile = rd->name + ".tmx";
-		std::string blkname = StrPrintf("BT%02d_%01d%01d_p%02d.png", rd->tileset + 1, rd->pri_blockset, rd->sec_blockset + 1, rd->room_palette + 1);
-		std::string blkpath = "blocksets";
-		blkpath += wxString(wxFileName::GetPathSeparator()).ToStdString() + blkname;
-		dialog.Update(i, Landstalker::StrWPrintf("Exporting %s...", m_g->GetRoomData()->GetRoomDisplayName(i).c_str()));
-		wxYield();
-		ExportRoomTmx(roomfile, blkpath, i);
+		while (w.wait_for(std::chrono::milliseconds(50)) != std::future_status::ready)
+		{
+			if (!cancelled && !dialog.Update(done, rooms ? "Writing blockset images..." : "Exporting maps..."))
+			{
+				cancelled = true;
+			}
+		}
 	}
-	wxSetWorkingDirectory(curdir);
-	return true;
+	for (const auto& path : failures)
+	{
+		errorss << "Unable to write " << path << std::endl;
+	}
+	for (auto& w : workers)
+	{
+		try
+		{
+			w.get();
+		}
+		catch (const std::exception& e)
+		{
+			errorss << e.what() << std::endl;
+		}
+	}
+	// A worker stops at its first exception, so if they all did, some jobs never started
+	const std::size_t started = std::min(next.load(), jobs.size());
+	if (!cancelled && started < jobs.size())
+	{
+		errorss << (jobs.size() - started) << " files were not written" << std::endl;
+	}
+	const bool failed = !errorss.str().empty();
+	if (failed)
+	{
+		wxMessageBox("Errors during export!\n" + errorss.str(), "Errors during export", wxICON_ERROR);
+	}
+	return !cancelled && !failed;
 }
 
 bool RoomViewerFrame::ExportPng(const std::string& path)
@@ -561,7 +680,7 @@ bool RoomViewerFrame::ImportBin(const std::string& path)
 	auto bytes = ReadBytes(path);
 	auto data = m_g->GetRoomData()->GetMapForRoom(m_roomnum);
 	data->GetData()->Decode(bytes.data());
-	UpdateFrame();
+	ReloadRoom();
 	return true;
 }
 
@@ -569,7 +688,7 @@ bool RoomViewerFrame::ImportTmx(const std::string& paths, uint16_t roomnum)
 {
 	auto map = m_g->GetRoomData()->GetMapForRoom(roomnum)->GetData();
 	auto retval = MapToTmx::ImportFromTmx(paths, *map);
-	UpdateFrame();
+	ReloadRoom();
 	return retval;
 }
 
@@ -597,7 +716,7 @@ bool RoomViewerFrame::ImportAllTmx(const std::string& dir)
 		}
 	}
 	wxSetWorkingDirectory(curdir);
-	UpdateFrame();
+	ReloadRoom();
 	return true;
 }
 
@@ -692,7 +811,7 @@ bool RoomViewerFrame::ImportCsv(const std::array<std::string, 3>& paths)
 			data->SetCellType({ x, y }, heightmap[y + 1][x] & 0xFF);
 		}
 	}
-	UpdateFrame();
+	ReloadRoom();
 	return true;
 }
 
@@ -1073,7 +1192,7 @@ void RoomViewerFrame::OnPropertyChange(wxPropertyGridEvent& evt)
 			}
 			
 
-			UpdateFrame();
+			ReloadRoom();
 		}
 	}
 	else if (name == "RP")
@@ -1081,7 +1200,7 @@ void RoomViewerFrame::OnPropertyChange(wxPropertyGridEvent& evt)
 		if (property->GetChoiceSelection() != rd->room_palette)
 		{
 			rd->room_palette = property->GetChoiceSelection();
-			UpdateFrame();
+			ReloadRoom();
 		}
 	}
 	else if (name == "PBT")
@@ -1093,7 +1212,7 @@ void RoomViewerFrame::OnPropertyChange(wxPropertyGridEvent& evt)
 			{
 				rd->sec_blockset = 0;
 			}
-			UpdateFrame();
+			ReloadRoom();
 		}
 	}
 	else if (name == "SBT")
@@ -1101,7 +1220,7 @@ void RoomViewerFrame::OnPropertyChange(wxPropertyGridEvent& evt)
 		if (property->GetChoiceSelection() != rd->sec_blockset)
 		{
 			rd->sec_blockset = property->GetChoiceSelection();
-			UpdateFrame();
+			ReloadRoom();
 		}
 	}
 	else if (name == "BGM")
@@ -1118,7 +1237,7 @@ void RoomViewerFrame::OnPropertyChange(wxPropertyGridEvent& evt)
 		if (map_name != rd->map)
 		{
 			rd->map = map_name;
-			UpdateFrame();
+			ReloadRoom();
 		}
 	}
 	else if (name == "ZB")
@@ -1158,7 +1277,7 @@ void RoomViewerFrame::OnPropertyChange(wxPropertyGridEvent& evt)
 		if (property->GetValuePlain().GetLong() != tm->GetData()->GetLeft())
 		{
 			tm->GetData()->SetLeft(static_cast<uint8_t>(property->GetValuePlain().GetLong()));
-			UpdateFrame();
+			ReloadRoom();
 		}
 	}
 	else if (name == "TTO")
@@ -1166,7 +1285,7 @@ void RoomViewerFrame::OnPropertyChange(wxPropertyGridEvent& evt)
 		if (property->GetValuePlain().GetLong() != tm->GetData()->GetTop())
 		{
 			tm->GetData()->SetTop(static_cast<uint8_t>(property->GetValuePlain().GetLong()));
-			UpdateFrame();
+			ReloadRoom();
 		}
 	}
 	else if (name == "VF")
@@ -1364,11 +1483,12 @@ void RoomViewerFrame::InitMenu(wxMenuBar& menu, ImageList& ilist) const
 	AddMenuItem(fileMenu, 12, ID_FILE_IMPORT_ALL_TMX, "Import All Maps from Tiled TMX...");
 
 	auto& editMenu = AddMenu(menu, 1, ID_EDIT, "Edit");
-	AddMenuItem(editMenu, 0, ID_EDIT_ENTITY_PROPERTIES, "Selection Properties...");
-	AddMenuItem(editMenu, 1, ID_EDIT_FLAGS, "Flags...");
-	AddMenuItem(editMenu, 2, ID_EDIT_CHESTS, "Chests...");
-	AddMenuItem(editMenu, 3, ID_EDIT_DIALOGUE, "Dialogue...");
-	AddMenuItem(editMenu, 4, ID_EDIT_TILESWAPS, "Tile Swaps...");
+	AddUndoMenuItems(editMenu, 0);
+	AddMenuItem(editMenu, 3, ID_EDIT_ENTITY_PROPERTIES, "Selection Properties...");
+	AddMenuItem(editMenu, 4, ID_EDIT_FLAGS, "Flags...");
+	AddMenuItem(editMenu, 5, ID_EDIT_CHESTS, "Chests...");
+	AddMenuItem(editMenu, 6, ID_EDIT_DIALOGUE, "Dialogue...");
+	AddMenuItem(editMenu, 7, ID_EDIT_TILESWAPS, "Tile Swaps...");
 
 	auto& viewMenu = AddMenu(menu, 2, ID_VIEW, "View");
 	AddMenuItem(viewMenu, 0, ID_VIEW_ALPHA, "Toggle Alpha", wxITEM_CHECK);
@@ -1388,6 +1508,7 @@ void RoomViewerFrame::InitMenu(wxMenuBar& menu, ImageList& ilist) const
 
 	wxAuiToolBar* main_tb = new wxAuiToolBar(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxAUI_TB_DEFAULT_STYLE | wxAUI_TB_HORIZONTAL);
 	main_tb->SetToolBitmapSize(wxSize(16, 16));
+	AddUndoTools(*main_tb, "Main", ilist);
 	main_tb->AddTool(TOOL_TOGGLE_ALPHA, "Show Transparency", ilist.GetImage("alpha"), "Show Transparency", wxITEM_CHECK);
 	main_tb->AddTool(TOOL_TOGGLE_ENTITIES, "Entities Visible", ilist.GetImage("entity"), "Entities Visible", wxITEM_CHECK);
 	main_tb->AddTool(TOOL_TOGGLE_ENTITY_HITBOX, "Entity Hitboxes Visible", ilist.GetImage("ehitbox"), "Entity Hitboxes Visible", wxITEM_CHECK);
@@ -1497,6 +1618,7 @@ void RoomViewerFrame::InitMenu(wxMenuBar& menu, ImageList& ilist) const
 	AddToolbar(m_mgr, *tm_tb, "Tilemap", "Tilemap Tools", wxAuiPaneInfo().ToolbarPane().Top().Row(1).Position(3));
 
 	UpdateUI();
+	UpdateUndoUI();
 
 	m_mgr.Update();
 }
@@ -1504,6 +1626,10 @@ void RoomViewerFrame::InitMenu(wxMenuBar& menu, ImageList& ilist) const
 void RoomViewerFrame::OnMenuClick(wxMenuEvent& evt)
 {
 	const auto id = evt.GetId();
+	if (HandleUndoMenuClick(id))
+	{
+		return;
+	}
 	if ((id >= 20000) && (id < 31000))
 	{
 		switch (id)
@@ -1703,7 +1829,8 @@ void RoomViewerFrame::OnTmClear()
 {
 	auto map = m_g->GetRoomData()->GetMapForRoom(m_roomnum);
 	map->GetData()->ClearTilemap();
-	UpdateFrame();
+	m_journal.Clear();
+	ReloadRoom();
 }
 
 void RoomViewerFrame::OnTmDeleteRow()
@@ -1713,7 +1840,8 @@ void RoomViewerFrame::OnTmDeleteRow()
 		auto sel = m_bgedit->GetSelectedCell();
 		auto map = m_g->GetRoomData()->GetMapForRoom(m_roomnum);
 		map->GetData()->DeleteTilemapRow(sel.first);
-		UpdateFrame();
+		m_journal.Clear();
+		ReloadRoom();
 	}
 }
 
@@ -1724,7 +1852,8 @@ void RoomViewerFrame::OnTmDeleteColumn()
 		auto sel = m_bgedit->GetSelectedCell();
 		auto map = m_g->GetRoomData()->GetMapForRoom(m_roomnum);
 		map->GetData()->DeleteTilemapColumn(sel.second);
-		UpdateFrame();
+		m_journal.Clear();
+		ReloadRoom();
 	}
 }
 
@@ -1735,10 +1864,11 @@ void RoomViewerFrame::OnTmInsertRowBefore()
 		auto sel = m_bgedit->GetSelectedCell();
 		auto map = m_g->GetRoomData()->GetMapForRoom(m_roomnum);
 		map->GetData()->InsertTilemapRow(sel.first);
+		m_journal.Clear();
 		++sel.first;
 		m_bgedit->SetSelectedCell(sel);
 		m_fgedit->SetSelectedCell(sel);
-		UpdateFrame();
+		ReloadRoom();
 	}
 }
 
@@ -1749,7 +1879,8 @@ void RoomViewerFrame::OnTmInsertRowAfter()
 		auto sel = m_bgedit->GetSelectedCell();
 		auto map = m_g->GetRoomData()->GetMapForRoom(m_roomnum);
 		map->GetData()->InsertTilemapRow(sel.first + 1);
-		UpdateFrame();
+		m_journal.Clear();
+		ReloadRoom();
 	}
 }
 
@@ -1760,10 +1891,11 @@ void RoomViewerFrame::OnTmInsertColumnBefore()
 		auto sel = m_bgedit->GetSelectedCell();
 		auto map = m_g->GetRoomData()->GetMapForRoom(m_roomnum);
 		map->GetData()->InsertTilemapColumn(sel.second);
+		m_journal.Clear();
 		++sel.second;
 		m_bgedit->SetSelectedCell(sel);
 		m_fgedit->SetSelectedCell(sel);
-		UpdateFrame();
+		ReloadRoom();
 	}
 }
 
@@ -1774,7 +1906,8 @@ void RoomViewerFrame::OnTmInsertColumnAfter()
 		auto sel = m_bgedit->GetSelectedCell();
 		auto map = m_g->GetRoomData()->GetMapForRoom(m_roomnum);
 		map->GetData()->InsertTilemapColumn(sel.second + 1);
-		UpdateFrame();
+		m_journal.Clear();
+		ReloadRoom();
 	}
 }
 
@@ -1893,6 +2026,7 @@ void RoomViewerFrame::OnImportBin()
 	{
 		std::string path = fd.GetPath().ToStdString();
 		ImportBin(path);
+		m_journal.Clear();
 	}
 	UpdateFrame();
 }
@@ -1916,6 +2050,7 @@ void RoomViewerFrame::OnImportCsv()
 		filenames[2] = fd.GetPath().ToStdString();
 	}
 	ImportCsv(filenames);
+	m_journal.Clear();
 	UpdateFrame();
 }
 
@@ -1926,6 +2061,7 @@ void RoomViewerFrame::OnImportTmx()
 	{
 		std::string path = fd.GetPath().ToStdString();
 		ImportTmx(path, m_roomnum);
+		m_journal.Clear();
 	}
 	UpdateFrame();
 }
@@ -1936,6 +2072,7 @@ void RoomViewerFrame::OnImportAllTmx()
 	if (dd.ShowModal() != wxID_CANCEL)
 	{
 		ImportAllTmx(dd.GetPath().ToStdString());
+		m_journal.Clear();
 	}
 }
 
@@ -2215,7 +2352,6 @@ void RoomViewerFrame::OnOpacityChange(wxCommandEvent& evt)
 		m_roomview->SetLayerOpacity(RoomViewerCtrl::Layer::HEIGHTMAP, m_layerctrl->GetLayerOpacity(layer));
 		break;
 	}
-	m_roomview->RefreshGraphics();
 }
 
 void RoomViewerFrame::OnEntityUpdate(wxCommandEvent& /*evt*/)
@@ -40,6 +40,7 @@ public:
 
 	virtual void SetGameData(std::shared_ptr<Landstalker::GameData> gd);
 	virtual void ClearGameData();
+	virtual void RecolourPalette(const Landstalker::Palette* palette) override;
 
 	void SetRoomNum(uint16_t roomnum);
 	uint16_t GetRoomNum() const { return m_roomnum; }
@@ -66,6 +67,8 @@ public:
 	void ShowTileswapDialog(bool force = false, TileSwapDialog::PageType type = TileSwapDialog::PageType::SWAPS, int row = -1);
 	void ShowErrorDialog();
 private:
+	// Exports every map (or every room) to TMX, along with each distinct blockset image
+	bool ExportTmxBatch(const std::string& dir, bool rooms);
 	virtual void InitStatusBar(wxStatusBar& status) const;
 	virtual void UpdateStatusBar(wxStatusBar& status, wxCommandEvent& evt) const;
 	virtual void InitProperties(wxPropertyGridManager& props) const;
@@ -97,6 +100,7 @@ private:
 	void OnImportTmx();
 	void OnImportAllTmx();
 	void UpdateUI() const;
+	void ReloadRoom();
 
 	void OnKeyDown(wxKeyEvent& evt);
 	void OnKeyUp(wxKeyEvent& evt);
@@ -0,0 +1,31 @@
+#include <rooms/TmxExportPlan.h>
+
+#include <set>
+
+TmxExportPlan::TmxExportPlan(const std::vector<Room>& rooms, bool per_room)
+{
+    std::set<std::string> blocksets;
+    std::set<std::string> maps;
+    for (const auto& room : rooms)
+    {
+        if (!per_room && !maps.insert(room.map).second)
+        {
+            continue;
+        }
+        if (blocksets.insert(room.blockset).second)
+        {
+            m_blocksets.push_back({ room.roomnum, room.blockset, room.blockset });
+        }
+        m_tmx_files.push_back({ room.roomnum, (per_room ? room.name : room.map) + ".tmx", room.blockset });
+    }
+}
+
+const std::vector<TmxExportPlan::File>& TmxExportPlan::GetBlocksets() const
+{
+    return m_blocksets;
+}
+
+const std::vector<TmxExportPlan::File>& TmxExportPlan::GetTmxFiles() const
+{
+    return m_tmx_files;
+}
@@ -0,0 +1,42 @@
+#ifndef _TMX_EXPORT_PLAN_H_
+#define _TMX_EXPORT_PLAN_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Works out which files a bulk TMX export writes. Rooms are identified to the blockset
+// images by name, which is fully determined by the tileset, blockset and palette they use,
+// so each image is rendered once however many rooms share it. When exporting maps rather
+// than rooms, only the first room of each map is used.
+class TmxExportPlan
+{
+public:
+	struct Room
+	{
+		uint16_t roomnum;
+		std::string name;
+		std::string map;
+		std::string blockset;
+	};
+	struct File
+	{
+		// The room whose data the file is written from
+		uint16_t roomnum;
+		std::string name;
+		// The blockset image a TMX file refers to, or the image itself
+		std::string blockset;
+	};
+
+	TmxExportPlan(const std::vector<Room>& rooms, bool per_room);
+
+	// Blockset images to render, in order of first use
+	const std::vector<File>& GetBlocksets() const;
+	// TMX files to write, named after the room or map
+	const std::vector<File>& GetTmxFiles() const;
+private:
+	std::vector<File> m_blocksets;
+	std::vector<File> m_tmx_files;
+};
+
+#endif // _TMX_EXPORT_PLAN_H_
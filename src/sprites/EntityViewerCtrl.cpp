@@ -1,5 +1,6 @@
 #include <sprites/EntityViewerCtrl.h>
 #include <wx/dcbuffer.h>
+#include <wx/dcmemory.h>
 
 wxBEGIN_EVENT_TABLE(EntityViewerCtrl, wxHVScrolledWindow)
 EVT_PAINT(EntityViewerCtrl::OnPaint)
@@ -40,12 +41,14 @@ void EntityViewerCtrl::ClearGameData()
 	m_entity_id = -1;
 	m_sprite.reset();
 	m_palette.reset();
+	InvalidateStrip();
 	Refresh(true);
 }
 
 void EntityViewerCtrl::SetActivePalette(const std::shared_ptr<Landstalker::Palette> pal)
 {
 	m_palette = pal;
+	InvalidateStrip();
 	Refresh(true);
 }
 
@@ -93,6 +96,8 @@ void EntityViewerCtrl::SetAnimation(int anim)
 {
 	m_animation = anim;
 	m_frame = 0;
+	m_lone_frame = false;
+	InvalidateStrip();
 	UpdateSprite();
 }
 
@@ -104,6 +109,11 @@ int EntityViewerCtrl::GetAnimationFrame() const
 void EntityViewerCtrl::SetAnimationFrame(int frame)
 {
 	m_frame = frame;
+	if (m_lone_frame)
+	{
+		m_lone_frame = false;
+		InvalidateStrip();
+	}
 	UpdateSprite();
 }
 
@@ -116,13 +126,14 @@ int EntityViewerCtrl::GetPixelSize() const
 void EntityViewerCtrl::SetPixelSize(int size)
 {
 	m_pixelsize = size;
-
+	InvalidateStrip();
 	Refresh(true);
 }
 
 void EntityViewerCtrl::Open(uint8_t entity, uint8_t animation, std::shared_ptr<Landstalker::Palette> pal)
 {
 	m_entity_id = entity;
+	m_lone_frame = false;
 	m_sprite_id = m_gd->GetSpriteData()->GetSpriteFromEntity(entity);
 	m_animation = animation;
 	m_frame = 0;
@@ -139,12 +150,14 @@ void EntityViewerCtrl::Open(uint8_t entity, uint8_t animation, std::shared_ptr<L
 	{
 		Play();
 	}
+	InvalidateStrip();
 	Refresh(true);
 }
 
 void EntityViewerCtrl::Open(uint8_t entity, std::shared_ptr<Landstalker::Palette> pal)
 {
 	m_entity_id = entity;
+	m_lone_frame = false;
 	m_sprite_id = m_gd->GetSpriteData()->GetSpriteFromEntity(entity);
 	m_animation = m_gd->GetSpriteData()->GetDefaultEntityAnimationId(entity);
 	m_frame = m_gd->GetSpriteData()->GetDefaultEntityFrameId(entity);
@@ -169,6 +182,7 @@ void EntityViewerCtrl::Open(uint8_t entity, std::shared_ptr<Landstalker::Palette
 	{
 		Pause();
 	}
+	InvalidateStrip();
 	Refresh(true);
 }
 
@@ -196,6 +210,15 @@ void EntityViewerCtrl::Open(std::shared_ptr<Landstalker::SpriteFrame> frame, std
 	{
 		Pause();
 	}
+	// A lone frame is not part of an animation, so it makes up the whole strip
+	m_lone_frame = true;
+	InvalidateStrip();
+	Refresh(true);
+}
+
+void EntityViewerCtrl::Redraw()
+{
+	InvalidateStrip();
 	Refresh(true);
 }
 
@@ -228,11 +251,16 @@ void EntityViewerCtrl::OnDraw(wxDC& dc)
 	dc.SetBackground(wxBrush(wxColor(32, 32, 32)));
 	dc.Clear();
 
-	if (m_sprite && m_palette)
+	if (!m_strip_valid)
 	{
-		for (int i = 0; i < static_cast<int>(m_sprite->GetTileCount()); ++i)
+		BuildStrip();
+	}
+	if (m_palette && m_frame >= 0 && m_frame < static_cast<int>(m_strip.size()))
+	{
+		const auto& frame = m_strip[m_frame];
+		if (frame.bmp.IsOk())
 		{
-			DrawTileAtPosition(dc, i);
+			dc.DrawBitmap(frame.bmp, frame.pos);
 		}
 	}
 }
@@ -242,6 +270,7 @@ void EntityViewerCtrl::OnPaint(wxPaintEvent& /*evt*/)
 	wxBufferedPaintDC dc(this);
 	this->PrepareDC(dc);
 	this->OnDraw(dc);
+	m_paint_pending = false;
 }
 
 void EntityViewerCtrl::OnSize(wxSizeEvent& evt)
@@ -255,10 +284,20 @@ void EntityViewerCtrl::OnSize(wxSizeEvent& evt)
 
 void EntityViewerCtrl::OnTimer(wxTimerEvent& /*evt*/)
 {
+	// Ticks that arrive before the previous frame has been painted are dropped rather than
+	// queueing up repaints
+	if (m_paint_pending)
+	{
+		return;
+	}
 	if (m_gd && m_sprite && m_playing)
 	{
+		if (!m_strip_valid)
+		{
+			BuildStrip();
+		}
 		m_frame++;
-		if (m_frame >= static_cast<int>(m_gd->GetSpriteData()->GetSpriteAnimationFrameCount(m_sprite_id, m_animation)))
+		if (m_frame >= static_cast<int>(m_strip.size()))
 		{
 			m_frame = 0;
 		}
@@ -266,36 +305,9 @@ void EntityViewerCtrl::OnTimer(wxTimerEvent& /*evt*/)
 	}
 }
 
-bool EntityViewerCtrl::DrawTileAtPosition(wxDC& dc, int pos)
+void EntityViewerCtrl::DrawTile(wxDC& dc, int x, int y, const Landstalker::SpriteFrame& sprite, int tile)
 {
-	bool retval = false;
-	int s = GetVisibleRowsBegin();
-	int e = GetVisibleRowsEnd();
-
-	dc.SetBrush(*wxTRANSPARENT_BRUSH);
-	auto p = m_sprite->GetTilePosition(pos);
-	auto ss = SpriteToScreenXY({ p.first, p.second });
-	auto x = ss.x / m_cellwidth;
-	auto y = ss.y / m_cellheight;
-	if ((y >= s) && (y < e))
-	{
-		dc.SetPen(*wxTRANSPARENT_PEN);
-		DrawTile(dc, x * m_cellwidth, y * m_cellheight, pos);
-		retval = true;
-	}
-	return retval;
-}
-
-void EntityViewerCtrl::DrawTile(wxDC& dc, int x, int y, int tile)
-{
-	wxPen pen = dc.GetPen();
-	wxBrush brush = dc.GetBrush();
-
-	pen.SetStyle(wxPENSTYLE_TRANSPARENT);
-	brush.SetStyle(wxBRUSHSTYLE_SOLID);
-	dc.SetPen(pen);
-
-	auto tile_bytes = m_sprite->GetTile(tile);
+	auto tile_bytes = sprite.GetTile(tile);
 	std::array<uint32_t, 64> tile_pixels = {0};
 	auto it = tile_pixels.begin();
 	for (const auto& b : tile_bytes)
@@ -303,18 +315,8 @@ void EntityViewerCtrl::DrawTile(wxDC& dc, int x, int y, int tile)
 		*it++ = m_palette->getBGRA(b);
 	}
 
-	for (int i = 0; i < static_cast<int>(tile_pixels.size()); ++i)
-	{
-		int xx = x + (i % m_sprite->GetTileWidth()) * m_pixelsize;
-		int yy = y + (i / m_sprite->GetTileWidth()) * m_pixelsize;
-		brush.SetColour(wxColour(tile_pixels[i]));
-		dc.SetBrush(brush);
-		// Has alpha
-		if ((tile_pixels[i] & 0xFF000000) > 0)
-		{
-			dc.DrawRectangle({ xx, yy, m_pixelsize, m_pixelsize });
-		}
-	}
+	const int width = sprite.GetTileWidth();
+	m_blitter.Draw(dc, x, y, tile_pixels.data(), width, tile_pixels.size() / width, m_pixelsize);
 }
 
 wxPoint EntityViewerCtrl::SpriteToScreenXY(const wxPoint& point)
@@ -326,11 +328,84 @@ void EntityViewerCtrl::UpdateSprite()
 {
 	if (m_gd)
 	{
-		auto frame = m_gd->GetSpriteData()->GetSpriteFrame(m_sprite_id, m_animation, m_frame);
-		if(frame)
+		if (!m_strip_valid)
+		{
+			BuildStrip();
+		}
+		if (m_frame >= 0 && m_frame < static_cast<int>(m_strip.size()))
+		{
+			m_sprite = m_strip[m_frame].sprite;
+			m_paint_pending = true;
+			Refresh(false);
+		}
+	}
+}
+
+void EntityViewerCtrl::InvalidateStrip()
+{
+	m_strip.clear();
+	m_strip_valid = false;
+}
+
+void EntityViewerCtrl::BuildStrip()
+{
+	m_strip.clear();
+	m_strip_valid = true;
+	if (m_lone_frame || !m_gd || m_sprite_id < 0)
+	{
+		if (m_sprite)
+		{
+			m_strip.push_back({ m_sprite, wxNullBitmap, {} });
+			RasteriseFrame(m_strip.back());
+		}
+		return;
+	}
+	const int count = static_cast<int>(m_gd->GetSpriteData()->GetSpriteAnimationFrameCount(m_sprite_id, m_animation));
+	for (int i = 0; i < count; ++i)
+	{
+		auto frame = m_gd->GetSpriteData()->GetSpriteFrame(m_sprite_id, m_animation, i);
+		if (!frame)
 		{
-			m_sprite = frame->GetData();
-			Refresh(true);
+			break;
 		}
+		m_strip.push_back({ frame->GetData(), wxNullBitmap, {} });
+		RasteriseFrame(m_strip.back());
+	}
+}
+
+void EntityViewerCtrl::RasteriseFrame(StripFrame& frame)
+{
+	if (!frame.sprite || !m_palette)
+	{
+		return;
+	}
+	const auto& sprite = *frame.sprite;
+	const int cellwidth = m_pixelsize * sprite.GetTileWidth();
+	const int cellheight = m_pixelsize * sprite.GetTileHeight();
+	const int tile_count = static_cast<int>(sprite.GetTileCount());
+	// Tiles are snapped to the cell grid, as they are when drawn to the window
+	std::vector<wxPoint> positions;
+	positions.reserve(tile_count);
+	wxRect bounds;
+	for (int i = 0; i < tile_count; ++i)
+	{
+		auto p = sprite.GetTilePosition(i);
+		auto ss = SpriteToScreenXY({ p.first, p.second });
+		positions.emplace_back(ss.x / cellwidth * cellwidth, ss.y / cellheight * cellheight);
+		bounds.Union(wxRect(positions.back(), wxSize(cellwidth, cellheight)));
+	}
+	if (bounds.IsEmpty())
+	{
+		return;
+	}
+	frame.bmp.Create(bounds.GetWidth(), bounds.GetHeight());
+	frame.pos = bounds.GetPosition();
+	wxMemoryDC dc(frame.bmp);
+	dc.SetBackground(wxBrush(wxColor(32, 32, 32)));
+	dc.Clear();
+	for (int i = 0; i < tile_count; ++i)
+	{
+		DrawTile(dc, positions[i].x - frame.pos.x, positions[i].y - frame.pos.y, sprite, i);
 	}
+	dc.SelectObject(wxNullBitmap);
 }
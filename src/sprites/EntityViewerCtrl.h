@@ -2,11 +2,13 @@
 #define _ENTITY_VIEWER_CTRL_H_
 
 #include <memory>
+#include <vector>
 
 #include <wx/wx.h>
 #include <wx/vscroll.h>
 
 #include <landstalker/main/GameData.h>
+#include <main/TileBlitter.h>
 
 class EntityViewerCtrl : public wxHVScrolledWindow
 {
@@ -38,7 +40,8 @@ public:
 	void Open(uint8_t entity, uint8_t animation, std::shared_ptr<Landstalker::Palette> pal);
 	void Open(uint8_t entity, std::shared_ptr<Landstalker::Palette> pal);
 	void Open(std::shared_ptr<Landstalker::SpriteFrame> frame, std::shared_ptr<Landstalker::Palette> pal);
-
+	// Discards the rasterised animation so that edits to the sprite are picked up
+	void Redraw();
 
 private:
 	virtual wxCoord OnGetRowHeight(size_t row) const override;
@@ -49,10 +52,19 @@ private:
 	void OnSize(wxSizeEvent& evt);
 	void OnTimer(wxTimerEvent& evt);
 
-	bool DrawTileAtPosition(wxDC& dc, int pos);
-	void DrawTile(wxDC& dc, int x, int y, int tile);
+	struct StripFrame
+	{
+		std::shared_ptr<Landstalker::SpriteFrame> sprite;
+		wxBitmap bmp;
+		wxPoint pos;
+	};
+
+	void DrawTile(wxDC& dc, int x, int y, const Landstalker::SpriteFrame& sprite, int tile);
 	wxPoint SpriteToScreenXY(const wxPoint& point);
 	void UpdateSprite();
+	void InvalidateStrip();
+	void BuildStrip();
+	void RasteriseFrame(StripFrame& frame);
 
 	int m_entity_id = -1;
 	int m_sprite_id = -1;
@@ -71,6 +83,14 @@ private:
 	std::shared_ptr<Landstalker::GameData> m_gd;
 	std::shared_ptr<Landstalker::SpriteFrame> m_sprite;
 	std::shared_ptr<Landstalker::Palette> m_palette;
+	TileBlitter m_blitter;
+
+	// Every frame of the current animation, rasterised at the current pixel size and palette.
+	// Playback just selects which one to blit.
+	std::vector<StripFrame> m_strip;
+	bool m_strip_valid = false;
+	bool m_lone_frame = false;
+	bool m_paint_pending = false;
 
 	wxTimer* m_timer = nullptr;
 
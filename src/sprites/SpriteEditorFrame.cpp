@@ -282,18 +282,30 @@ void SpriteEditorFrame::SetActivePalette(const std::vector<std::string>& names)
 	}
 }
 
+void SpriteEditorFrame::RecolourPalette(const Landstalker::Palette* palette)
+{
+	// The editor works on its own copy of the sprite palette, so only edits made here match it
+	if (m_palette == nullptr || (palette != nullptr && palette != m_palette.get()))
+	{
+		return;
+	}
+	m_paledit->Refresh(true);
+	RedrawTiles();
+}
+
 void SpriteEditorFrame::Redraw() const
 {
 	m_spriteeditor->UpdateSubSprites();
 	m_paledit->Refresh(true);
 	m_tileedit->Redraw();
+	m_preview->Redraw();
 }
 
 void SpriteEditorFrame::RedrawTiles(int index) const
 {
 	m_spriteeditor->RedrawTiles(index);
 	m_tileedit->Redraw();
-	m_preview->Refresh(true);
+	m_preview->Redraw();
 }
 
 void SpriteEditorFrame::Update()
@@ -1493,6 +1505,7 @@ void SpriteEditorFrame::OnTileChanged(wxCommandEvent& evt)
 	{
 		m_tileedit->SetTile(tile);
 	}
+	m_preview->Redraw();
 	evt.Skip();
 }
 
@@ -33,6 +33,7 @@ public:
 	bool OpenFrame(uint8_t spr, int frame = -1, int anim = -1, int ent = -1, bool fullUpdate = true);
 	virtual void SetGameData(std::shared_ptr<Landstalker::GameData> gd);
 	virtual void ClearGameData();
+	virtual void RecolourPalette(const Landstalker::Palette* palette) override;
 
 	void SetActivePalette(const std::string& name);
 	void SetActivePalette(const std::vector<std::string>& names);
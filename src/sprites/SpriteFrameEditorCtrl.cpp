@@ -1,5 +1,6 @@
 #include <sprites/SpriteFrameEditorCtrl.h>
 
+#include <algorithm>
 #include <fstream>
 #include <wx/wx.h>
 #include <wx/dcclient.h>
@@ -54,6 +55,7 @@ SpriteFrameEditorCtrl::SpriteFrameEditorCtrl(wxWindow* parent)
 	m_ctrlwidth(1),
 	m_ctrlheight(1),
 	m_redraw_all(true),
+	m_drawn_subsprites(MAX_WIDTH, MAX_HEIGHT, ORIGIN_X, ORIGIN_Y),
 	m_pendingswap(-1)
 {
 	m_tiles = std::make_shared<Landstalker::Tileset>();
@@ -143,7 +145,12 @@ void SpriteFrameEditorCtrl::UpdateSubSprites()
 	{
 		SelectSubSprite(-1);
 	}
-	RedrawTiles();
+	// The pixels in the grid stay where they are when subsprites change, so only the cells
+	// covered by a subsprite before or after the change need to be redrawn
+	const auto cells = m_drawn_subsprites.Update(GetSubSpriteExtents(),
+		static_cast<int>(m_tiles->GetTileWidth()), static_cast<int>(m_tiles->GetTileHeight()));
+	m_redraw_list.insert(cells.cbegin(), cells.cend());
+	Refresh(false);
 }
 
 void SpriteFrameEditorCtrl::SetGameData(std::shared_ptr<Landstalker::GameData> gd)
@@ -560,6 +567,7 @@ void SpriteFrameEditorCtrl::OnDraw(wxDC& dc)
 		if (m_redraw_all == true)
 		{
 			m_redraw_list.clear();
+			m_drawn_subsprites.Reset(GetSubSpriteExtents());
 			for (int y = 0; y < MAX_HEIGHT; ++y)
 			{
 				for (int x = 0; x < MAX_WIDTH; ++x)
@@ -594,51 +602,14 @@ void SpriteFrameEditorCtrl::OnDraw(wxDC& dc)
 				}
 			}
 		}
-		DrawSelectionBorders(m_memdc);
-
-		m_memdc.SetBrush(*wxTRANSPARENT_BRUSH);
-		if (m_enableborders)
-		{
-			for (int i = 0; i < static_cast<int>(m_sprite->GetSubSpriteCount()); ++i)
-			{
-				const auto& s = m_sprite->GetSubSprite(i);
-				m_memdc.SetPen(wxPen(i + 1 == m_hovered_subsprite ? wxColor(255, 128, 128) : *wxRED, i + 1 == m_selected_subsprite ? 3 : 1));
-				m_memdc.DrawRectangle(SpriteToScreenXY({ s.x, s.y }), { static_cast<int>(s.w * m_sprite->GetTileWidth() * m_pixelsize), static_cast<int>(s.h * m_sprite->GetTileHeight() * m_pixelsize) });
-			}
-		}
-		if (m_enableborders)
-		{
-			m_memdc.SetPen(wxPen(*wxGREEN, 2));
-			m_memdc.DrawLine(SpriteToScreenXY({ -10, 0 }), SpriteToScreenXY({ 10, 0 }));
-			m_memdc.DrawLine(SpriteToScreenXY({ 0, -10 }), SpriteToScreenXY({ 0, 10 }));
-		}
-		if (m_enablehitbox)
-		{
-			auto hitbox = m_gd->GetSpriteData()->GetSpriteHitbox(m_sprite_id);
-			m_memdc.SetPen(wxPen(*wxYELLOW, 1));
-			wxPoint hitbox_fg_points[] = {
-				SpriteToScreenXY({ hitbox.base * 2, 0}),
-				SpriteToScreenXY({ 0, hitbox.base}),
-				SpriteToScreenXY({ -hitbox.base * 2, 0}),
-				SpriteToScreenXY({ -hitbox.base * 2, -hitbox.height}),
-				SpriteToScreenXY({ 0, hitbox.base - hitbox.height}),
-				SpriteToScreenXY({ 0, hitbox.base}),
-				SpriteToScreenXY({ 0, hitbox.base - hitbox.height}),
-				SpriteToScreenXY({ hitbox.base * 2, 0 - hitbox.height}),
-				SpriteToScreenXY({ hitbox.base * 2, 0}),
-				SpriteToScreenXY({ hitbox.base * 2, 0 - hitbox.height}),
-				SpriteToScreenXY({ 0, -hitbox.base - hitbox.height}),
-				SpriteToScreenXY({ -hitbox.base * 2, -hitbox.height}),
-				SpriteToScreenXY({ -hitbox.base * 2, 0}),
-				SpriteToScreenXY({ 0, hitbox.base}),
-				SpriteToScreenXY({ hitbox.base * 2, 0}),
-			};
-			m_memdc.DrawPolygon(sizeof(hitbox_fg_points) / sizeof(hitbox_fg_points[0]), &hitbox_fg_points[0]);
-		}
 	}
 
 	PaintBitmap(dc);
 	m_memdc.SelectObject(wxNullBitmap);
+	if (m_sprite != nullptr)
+	{
+		DrawOverlays(dc);
+	}
 }
 
 void SpriteFrameEditorCtrl::OnPaint(wxPaintEvent& /*evt*/)
@@ -717,7 +688,7 @@ void SpriteFrameEditorCtrl::OnMouseMove(wxMouseEvent& evt)
 	if (hovered_subsprite != m_hovered_subsprite)
 	{
 		m_hovered_subsprite = hovered_subsprite;
-		RedrawTiles();
+		Refresh(false);
 	}
 	if (hovered_subsprite > 0 && (evt.GetModifiers() & wxMOD_CONTROL) > 0)
 	{
@@ -744,7 +715,7 @@ void SpriteFrameEditorCtrl::OnMouseLeave(wxMouseEvent& evt)
 	if (m_hovered_subsprite != -1)
 	{
 		m_hovered_subsprite = -1;
-		RedrawTiles();
+		Refresh(false);
 	}
 	evt.Skip();
 }
@@ -1051,41 +1022,25 @@ bool SpriteFrameEditorCtrl::UpdateRowCount()
 
 void SpriteFrameEditorCtrl::DrawTile(wxDC& dc, int x, int y, int tile)
 {
-	wxPen pen = dc.GetPen();
-	wxBrush brush = dc.GetBrush();
-
-	pen.SetStyle(wxPENSTYLE_TRANSPARENT);
-	brush.SetStyle(wxBRUSHSTYLE_SOLID);
-	dc.SetPen(pen);
-
 	auto tile_bytes = m_tiles->GetTile(tile);
 	const auto& pal = GetSelectedPalette();
+	const bool in_sprite = IsTileInSprite(tile);
 	std::vector<uint32_t> tile_pixels;
+	tile_pixels.reserve(tile_bytes.size());
 	for (const auto& b : tile_bytes)
 	{
-		tile_pixels.push_back(pal.getBGRA(b));
-	}
-
-	for (int i = 0; i < static_cast<int>(tile_pixels.size()); ++i)
-	{
-		int xx = x + (i % m_tiles->GetTileWidth()) * m_pixelsize;
-		int yy = y + (i / m_tiles->GetTileWidth()) * m_pixelsize;
-		if (IsTileInSprite(tile))
-		{
-			brush.SetColour(wxColour(tile_pixels[i]));
-		}
-		else
+		uint32_t colour = pal.getBGRA(b);
+		if (!in_sprite)
 		{
-			brush.SetColour(wxColour(tile_pixels[i]).ChangeLightness(50));
-		}
-		dc.SetBrush(brush);
-		// Has alpha
-		if ((tile_pixels[i] & 0xFF000000) > 0)
-		{
-			dc.DrawRectangle({ xx, yy, m_pixelsize, m_pixelsize });
+			// Cells outside of any subsprite are shown darkened
+			const wxColour dark = wxColour(colour).ChangeLightness(50);
+			colour = (colour & 0xFF000000) | (dark.Blue() << 16) | (dark.Green() << 8) | dark.Red();
 		}
+		tile_pixels.push_back(colour);
 	}
 
+	const int width = m_tiles->GetTileWidth();
+	m_blitter.Draw(dc, x, y, tile_pixels.data(), width, tile_pixels.size() / width, m_pixelsize);
 }
 
 bool SpriteFrameEditorCtrl::DrawTileAtPosition(wxDC& dc, int pos)
@@ -1163,6 +1118,51 @@ void SpriteFrameEditorCtrl::DrawSelectionBorders(wxDC& dc)
 	}
 }
 
+void SpriteFrameEditorCtrl::DrawOverlays(wxDC& dc)
+{
+	DrawSelectionBorders(dc);
+
+	dc.SetBrush(*wxTRANSPARENT_BRUSH);
+	if (m_enableborders)
+	{
+		for (int i = 0; i < static_cast<int>(m_sprite->GetSubSpriteCount()); ++i)
+		{
+			const auto& s = m_sprite->GetSubSprite(i);
+			dc.SetPen(wxPen(i + 1 == m_hovered_subsprite ? wxColor(255, 128, 128) : *wxRED, i + 1 == m_selected_subsprite ? 3 : 1));
+			dc.DrawRectangle(SpriteToScreenXY({ s.x, s.y }), { static_cast<int>(s.w * m_sprite->GetTileWidth() * m_pixelsize), static_cast<int>(s.h * m_sprite->GetTileHeight() * m_pixelsize) });
+		}
+	}
+	if (m_enableborders)
+	{
+		dc.SetPen(wxPen(*wxGREEN, 2));
+		dc.DrawLine(SpriteToScreenXY({ -10, 0 }), SpriteToScreenXY({ 10, 0 }));
+		dc.DrawLine(SpriteToScreenXY({ 0, -10 }), SpriteToScreenXY({ 0, 10 }));
+	}
+	if (m_enablehitbox)
+	{
+		auto hitbox = m_gd->GetSpriteData()->GetSpriteHitbox(m_sprite_id);
+		dc.SetPen(wxPen(*wxYELLOW, 1));
+		wxPoint hitbox_fg_points[] = {
+			SpriteToScreenXY({ hitbox.base * 2, 0}),
+			SpriteToScreenXY({ 0, hitbox.base}),
+			SpriteToScreenXY({ -hitbox.base * 2, 0}),
+			SpriteToScreenXY({ -hitbox.base * 2, -hitbox.height}),
+			SpriteToScreenXY({ 0, hitbox.base - hitbox.height}),
+			SpriteToScreenXY({ 0, hitbox.base}),
+			SpriteToScreenXY({ 0, hitbox.base - hitbox.height}),
+			SpriteToScreenXY({ hitbox.base * 2, 0 - hitbox.height}),
+			SpriteToScreenXY({ hitbox.base * 2, 0}),
+			SpriteToScreenXY({ hitbox.base * 2, 0 - hitbox.height}),
+			SpriteToScreenXY({ 0, -hitbox.base - hitbox.height}),
+			SpriteToScreenXY({ -hitbox.base * 2, -hitbox.height}),
+			SpriteToScreenXY({ -hitbox.base * 2, 0}),
+			SpriteToScreenXY({ 0, hitbox.base}),
+			SpriteToScreenXY({ hitbox.base * 2, 0}),
+		};
+		dc.DrawPolygon(sizeof(hitbox_fg_points) / sizeof(hitbox_fg_points[0]), &hitbox_fg_points[0]);
+	}
+}
+
 void SpriteFrameEditorCtrl::PaintBitmap(wxDC& dc)
 {
 	dc.SetBackground(wxBrush(wxSystemSettings::GetColour(wxSYS_COLOUR_APPWORKSPACE)));
@@ -1278,8 +1278,7 @@ void SpriteFrameEditorCtrl::SelectSubSprite(int sel)
 	{
 		m_selected_subsprite = -1;
 	}
-	m_redraw_all = true;
-	Refresh();
+	Refresh(false);
 }
 
 int SpriteFrameEditorCtrl::GetSelectedSubSprite() const
@@ -1295,8 +1294,7 @@ int SpriteFrameEditorCtrl::GetHoveredSubSprite() const
 void SpriteFrameEditorCtrl::ClearSubSpriteSelection()
 {
 	m_selected_subsprite = -1;
-	m_redraw_all = true;
-	Refresh();
+	Refresh(false);
 }
 
 std::shared_ptr<Landstalker::Tileset> SpriteFrameEditorCtrl::GetTileset()
@@ -1465,6 +1463,16 @@ int SpriteFrameEditorCtrl::GetSubspriteAt(int tile) const
 	return -1;
 }
 
+std::vector<SubSpriteExtents::Extent> SpriteFrameEditorCtrl::GetSubSpriteExtents() const
+{
+	std::vector<SubSpriteExtents::Extent> extents;
+	for (const auto& s : m_sprite->GetSubSprites())
+	{
+		extents.push_back({ static_cast<int>(s.x), static_cast<int>(s.y), static_cast<int>(s.w), static_cast<int>(s.h) });
+	}
+	return extents;
+}
+
 void SpriteFrameEditorCtrl::SelectTile(int tile)
 {
 	if ((m_selectedtile != -1) && (tile != m_selectedtile))
@@ -12,6 +12,8 @@
 
 #include <landstalker/main/GameData.h>
 #include <main/ImageBufferWx.h>
+#include <main/TileBlitter.h>
+#include <sprites/SubSpriteExtents.h>
 #include <landstalker/sprites/SpriteFrame.h>
 #include <landstalker/palettes/Palette.h>
 
@@ -114,6 +116,7 @@ private:
 
 	bool IsTileInSprite(int tile) const;
 	int GetSpriteTileNum(int tile);
+	std::vector<SubSpriteExtents::Extent> GetSubSpriteExtents() const;
 
 	void UpdateTileBuffer();
 	void UpdateSpriteTile(int tile);
@@ -123,6 +126,7 @@ private:
 	void DrawTile(wxDC& dc, int x, int y, int tile);
 	bool DrawTileAtPosition(wxDC& dc, int pos);
 	void DrawSelectionBorders(wxDC& dc);
+	void DrawOverlays(wxDC& dc);
 	void PaintBitmap(wxDC& dc);
 	void InitialiseBrushesAndPens();
 	void ForceRedraw();
@@ -163,6 +167,8 @@ private:
 	int m_ctrlheight;
 	std::set<int> m_redraw_list;
 	bool m_redraw_all;
+	// Subsprite extents as they were last drawn into m_bmp
+	SubSpriteExtents m_drawn_subsprites;
 	mutable std::vector<uint8_t> m_clipboard;
 	mutable std::vector<uint8_t> m_swapbuffer;
 	int m_pendingswap;
@@ -175,6 +181,7 @@ private:
 	std::unique_ptr<wxBrush> m_highlighted_brush;
 	std::unique_ptr<wxBitmap> m_stipple;
 	std::unique_ptr<wxBitmap> m_dark_stipple;
+	TileBlitter m_blitter;
 
 	int m_selected_subsprite = -1;
 	int m_hovered_subsprite = -1;
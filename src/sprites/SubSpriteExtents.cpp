@@ -0,0 +1,61 @@
+#include <sprites/SubSpriteExtents.h>
+
+#include <algorithm>
+
+SubSpriteExtents::SubSpriteExtents(int grid_width, int grid_height, int origin_x, int origin_y)
+	: m_grid_width(grid_width),
+	  m_grid_height(grid_height),
+	  m_origin_x(origin_x),
+	  m_origin_y(origin_y)
+{
+}
+
+void SubSpriteExtents::Reset(const std::vector<Extent>& extents)
+{
+	m_drawn = extents;
+}
+
+std::set<int> SubSpriteExtents::Update(const std::vector<Extent>& extents, int tile_width, int tile_height)
+{
+	std::set<int> cells;
+	const std::size_t count = std::max(extents.size(), m_drawn.size());
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		const bool had = i < m_drawn.size();
+		const bool has = i < extents.size();
+		if (had && has && IsSameExtent(m_drawn[i], extents[i]))
+		{
+			continue;
+		}
+		if (had)
+		{
+			AddCells(m_drawn[i], tile_width, tile_height, cells);
+		}
+		if (has)
+		{
+			AddCells(extents[i], tile_width, tile_height, cells);
+		}
+	}
+	m_drawn = extents;
+	return cells;
+}
+
+bool SubSpriteExtents::IsSameExtent(const Extent& lhs, const Extent& rhs)
+{
+	return lhs.x == rhs.x && lhs.y == rhs.y && lhs.w == rhs.w && lhs.h == rhs.h;
+}
+
+void SubSpriteExtents::AddCells(const Extent& extent, int tile_width, int tile_height, std::set<int>& cells) const
+{
+	const int xb = extent.x / tile_width + m_origin_x;
+	const int yb = extent.y / tile_height + m_origin_y;
+	const int xe = std::min(xb + extent.w, m_grid_width);
+	const int ye = std::min(yb + extent.h, m_grid_height);
+	for (int y = std::max(yb, 0); y < ye; ++y)
+	{
+		for (int x = std::max(xb, 0); x < xe; ++x)
+		{
+			cells.insert(y * m_grid_width + x);
+		}
+	}
+}
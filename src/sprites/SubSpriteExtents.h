@@ -0,0 +1,43 @@
+#ifndef _SUBSPRITE_EXTENTS_H_
+#define _SUBSPRITE_EXTENTS_H_
+
+#include <set>
+#include <vector>
+
+// Tracks the subsprite extents last drawn into the sprite frame editor's grid, and works out
+// which grid cells need redrawing when they change. The pixels in the grid stay where they
+// are when subsprites move, so only the cells covered by a subsprite before or after the
+// change can differ.
+class SubSpriteExtents
+{
+public:
+	// x and y are the subsprite's offset from the origin in pixels, w and h its size in tiles
+	struct Extent
+	{
+		int x;
+		int y;
+		int w;
+		int h;
+	};
+
+	SubSpriteExtents(int grid_width, int grid_height, int origin_x, int origin_y);
+
+	// Remembers the extents as drawn, e.g. after the whole grid has been redrawn
+	void Reset(const std::vector<Extent>& extents);
+	// Returns the cells, as y * grid_width + x, covered before or after the change by every
+	// subsprite whose extent differs from the one drawn, including ones added or removed.
+	// The new extents are remembered as drawn.
+	std::set<int> Update(const std::vector<Extent>& extents, int tile_width, int tile_height);
+
+	static bool IsSameExtent(const Extent& lhs, const Extent& rhs);
+private:
+	void AddCells(const Extent& extent, int tile_width, int tile_height, std::set<int>& cells) const;
+
+	int m_grid_width;
+	int m_grid_height;
+	int m_origin_x;
+	int m_origin_y;
+	std::vector<Extent> m_drawn;
+};
+
+#endif // _SUBSPRITE_EXTENTS_H_
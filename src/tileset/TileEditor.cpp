@@ -3,6 +3,9 @@
 #include <wx/dcmemory.h>
 #include <wx/dcbuffer.h>
 #include <algorithm>
+#include <set>
+#include <main/TileAtlas.h>
+#include <main/UndoJournal.h>
 
 wxBEGIN_EVENT_TABLE(TileEditor, wxHVScrolledWindow)
 EVT_PAINT(TileEditor::OnPaint)
@@ -33,6 +36,8 @@ TileEditor::TileEditor(wxWindow* parent)
 	  m_hoveredpixel{ -1, -1 },
 	  m_secondary_active(false),
 	  m_drawing(false),
+	  m_stroke_open(false),
+	  m_journal(nullptr),
 	  m_enableborders(true),
 	  m_enableedit(true),
 	  m_enablealpha(true),
@@ -92,6 +97,11 @@ void TileEditor::SetTile(const Landstalker::Tile& tile)
 	Redraw();
 }
 
+void TileEditor::SetUndoJournal(UndoJournal* journal)
+{
+	m_journal = journal;
+}
+
 void TileEditor::Redraw()
 {
 	Refresh(true);
@@ -370,6 +380,7 @@ void TileEditor::OnMouseUpDown(wxMouseEvent& evt)
 			m_drawing = false;
 		}
 	}
+	UpdateStroke();
 	int px = ConvertMouseXYToPixel(evt.GetPosition());
 	Point pt{ -1, -1 };
 	if (px >= 0)
@@ -407,6 +418,7 @@ void TileEditor::OnMouseEnter(wxMouseEvent& evt)
 		m_drawing = false;
 		m_secondary_active = false;
 	}
+	UpdateStroke();
 	evt.Skip();
 }
 
@@ -436,8 +448,7 @@ void TileEditor::MouseDraw(const Point& point)
 		int colour = m_secondary_active ? m_secondary_colour : m_primary_colour;
 		if (!m_pixels.empty() && m_pixels.at(px) != colour)
 		{
-			m_pixels.at(px) = colour;
-			m_tileset->GetTilePixels(m_tile.GetIndex()) = m_pixels;
+			WritePixel(px, colour);
 			refresh = true;
 			FireEvent(EVT_TILE_CHANGE);
 		}
@@ -519,8 +530,7 @@ bool TileEditor::SetColour(const Point& point, int colour)
 	{
 		if (m_pixels[pixel] != colour)
 		{
-			m_pixels[pixel] = colour;
-			m_tileset->GetTilePixels(m_tile.GetIndex()) = m_pixels;
+			WritePixel(pixel, colour);
 			Refresh(true);
 			retval = true;
 		}
@@ -528,6 +538,64 @@ bool TileEditor::SetColour(const Point& point, int colour)
 	return retval;
 }
 
+void TileEditor::WritePixel(int pixel, uint8_t colour)
+{
+	const int tile = m_tile.GetIndex();
+	if (m_journal != nullptr)
+	{
+		auto tileset = m_tileset;
+		// A merged stroke can span several tiles, and listeners only redraw the tile they are told about
+		auto edited = std::make_shared<std::set<int>>();
+		auto delta = std::make_unique<CellDelta<std::pair<int, int>, uint8_t>>(tileset.get(),
+			[this, tileset, edited](const std::pair<int, int>& px, const uint8_t& value)
+			{
+				tileset->GetTilePixels(px.first)[px.second] = value;
+				TileAtlas::InvalidateTile(tileset.get(), px.first);
+				edited->insert(px.first);
+				if (tileset == m_tileset && px.first == m_tile.GetIndex())
+				{
+					m_pixels[px.second] = value;
+				}
+			},
+			[this, tileset, edited]()
+			{
+				if (tileset == m_tileset)
+				{
+					Refresh(true);
+					for (int t : *edited)
+					{
+						FireEvent(EVT_TILE_CHANGE, t);
+					}
+				}
+				edited->clear();
+			});
+		delta->Add({ tile, pixel }, m_pixels[pixel], colour);
+		m_journal->Push("Draw Pixels", std::move(delta));
+	}
+	m_pixels[pixel] = colour;
+	m_tileset->GetTilePixels(tile) = m_pixels;
+	TileAtlas::InvalidateTile(m_tileset.get(), tile);
+}
+
+void TileEditor::UpdateStroke()
+{
+	// Group everything drawn between pressing and releasing the mouse into one undo step
+	if (m_journal == nullptr)
+	{
+		return;
+	}
+	if (m_drawing && !m_stroke_open)
+	{
+		m_journal->BeginStroke("Draw Pixels");
+		m_stroke_open = true;
+	}
+	else if (!m_drawing && m_stroke_open)
+	{
+		m_journal->EndStroke();
+		m_stroke_open = false;
+	}
+}
+
 int TileEditor::ValidateColour(int colour) const
 {
 	auto cmap = m_tileset->GetColourIndicies();
@@ -610,9 +678,14 @@ wxBrush TileEditor::GetBrush(int index)
 }
 
 void TileEditor::FireEvent(const wxEventType& e)
+{
+	FireEvent(e, m_tile.GetIndex());
+}
+
+void TileEditor::FireEvent(const wxEventType& e, int tile)
 {
 	wxCommandEvent evt(e);
-	evt.SetString(std::to_string(m_tile.GetIndex()));
+	evt.SetString(std::to_string(tile));
 	evt.SetClientData(&m_tileset);
 	wxPostEvent(this->GetParent(), evt);
 }
@@ -14,6 +14,8 @@
 #include <landstalker/main/GameData.h>
 #include <landstalker/main/DataTypes.h>
 
+class UndoJournal;
+
 class TileEditor : public wxHVScrolledWindow
 {
 public:
@@ -46,6 +48,8 @@ public:
 	void SetGameData(std::shared_ptr<Landstalker::GameData> gd);
 	void SetTileset(std::shared_ptr<Landstalker::Tileset> tileset);
 	void SetTile(const Landstalker::Tile& tile);
+	// Pixel edits are recorded here if set. Each mouse stroke becomes one undo step.
+	void SetUndoJournal(UndoJournal* journal);
 
 	void Redraw();
 	int GetPixelSize() const;
@@ -98,12 +102,15 @@ private:
 	void AutoSize();
 
 	bool SetColour(const Point& point, int colour);
+	void WritePixel(int pixel, uint8_t colour);
+	void UpdateStroke();
 	void SetPixelSize(int n);
 	int ValidateColour(int colour) const;
 	void InitialiseBrushesAndPens();
 	wxBrush GetBrush(int index);
 
 	void FireEvent(const wxEventType& e);
+	void FireEvent(const wxEventType& e, int tile);
 	int m_ctrlwidth;
 	int m_ctrlheight;
 	int m_pixelsize;
@@ -113,6 +120,8 @@ private:
 	Point m_hoveredpixel;
 	bool m_secondary_active;
 	bool m_drawing;
+	bool m_stroke_open;
+	UndoJournal* m_journal;
 
 	std::unique_ptr<wxBrush> m_alpha_brush;
 	std::unique_ptr<wxPen> m_border_pen;
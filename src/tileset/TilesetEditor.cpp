@@ -48,6 +48,7 @@ TilesetEditor::TilesetEditor(wxWindow* parent)
 	m_ctrlwidth(1),
 	m_ctrlheight(1),
 	m_redraw_all(true),
+	m_recolour(false),
 	m_pendingswap(-1)
 {
 	SetRowCount(m_rows);
@@ -146,6 +147,7 @@ void TilesetEditor::OnDraw(wxDC& dc)
 		m_bg_bmp.Create(m_cellwidth * m_columns + 1, m_cellheight * m_rows + 1);
 		m_bmp.Create(m_cellwidth * m_columns + 1, m_cellheight * m_rows + 1);
 		m_buf.Resize(m_tilewidth * m_columns, m_tileheight * m_rows);
+		m_tile_buf.Resize(m_tilewidth, m_tileheight);
 	}
 	wxMemoryDC background(m_bg_bmp);
 	wxMemoryDC memdc(m_bmp);
@@ -161,6 +163,10 @@ void TilesetEditor::OnDraw(wxDC& dc)
 		{
 			DrawAllTiles(background);
 		}
+		else if (m_recolour)
+		{
+			RecolourAllTiles(background);
+		}
 		else if (!m_redraw_list.empty())
 		{
 			DrawTileList(background);
@@ -301,12 +307,8 @@ void TilesetEditor::DrawAllTiles(wxDC& dest)
 {
 	int x = 0;
 	int y = 0;
-	dest.SetBrush(*wxTRANSPARENT_BRUSH);
-	dest.SetPen(*wxTRANSPARENT_PEN);
-	dest.SetBrush(m_enablealpha ? *m_alpha_brush : *wxBLACK_BRUSH);
 	for (std::size_t i = 0; i < m_tileset->GetTileCount(); ++i)
 	{
-		dest.DrawRectangle({ x * m_cellwidth, y * m_cellheight, m_cellwidth, m_cellheight });
 		m_buf.InsertTile(x * m_tilewidth, y * m_tileheight, 0, i, *m_tileset);
 		x++;
 		if (x >= m_columns)
@@ -315,6 +317,28 @@ void TilesetEditor::DrawAllTiles(wxDC& dest)
 			y++;
 		}
 	}
+	m_redraw_list.clear();
+	RecolourAllTiles(dest);
+}
+
+void TilesetEditor::RecolourAllTiles(wxDC& dest)
+{
+	// m_buf holds the indexed pixels of every tile, so after a palette edit only the
+	// conversion to RGB has to be repeated. Edits still waiting to be drawn go in first.
+	for (int index : m_redraw_list)
+	{
+		if ((index >= 0) && (index < static_cast<int>(m_tileset->GetTileCount())))
+		{
+			m_buf.InsertTile((index % m_columns) * m_tilewidth, (index / m_columns) * m_tileheight, 0, index, *m_tileset, false);
+		}
+	}
+	dest.SetBrush(*wxTRANSPARENT_BRUSH);
+	dest.SetPen(*wxTRANSPARENT_PEN);
+	dest.SetBrush(m_enablealpha ? *m_alpha_brush : *wxBLACK_BRUSH);
+	for (std::size_t i = 0; i < m_tileset->GetTileCount(); ++i)
+	{
+		dest.DrawRectangle({ static_cast<int>(i % m_columns) * m_cellwidth, static_cast<int>(i / m_columns) * m_cellheight, m_cellwidth, m_cellheight });
+	}
 	auto img = m_buf.MakeImage( { m_selected_palette }, true);
 	m_tiles_bmp = std::make_unique<wxBitmap>(img);
 	wxMemoryDC tiles(*m_tiles_bmp);
@@ -322,6 +346,7 @@ void TilesetEditor::DrawAllTiles(wxDC& dest)
 		{ img.GetWidth() * m_pixelsize, img.GetHeight() * m_pixelsize },
 		&tiles, { 0,0 }, { img.GetWidth(), img.GetHeight() }, wxCOPY, true, { 0,0 });
 	m_redraw_all = false;
+	m_recolour = false;
 	m_redraw_list.clear();
 }
 
@@ -332,6 +357,13 @@ void TilesetEditor::DrawTileList(wxDC& dest)
 	dest.SetBrush(m_enablealpha ? *m_alpha_brush : *wxBLACK_BRUSH);
 	int s = GetVisibleRowsBegin();
 	int e = GetVisibleRowsEnd();
+	if (m_tiles_bmp == nullptr)
+	{
+		DrawAllTiles(dest);
+		return;
+	}
+	// Only the changed tiles are converted and written into the existing tileset bitmap,
+	// so the cost of an edit does not depend on the size of the tileset
 	auto it = m_redraw_list.begin();
 	while (it != m_redraw_list.end())
 	{
@@ -341,13 +373,14 @@ void TilesetEditor::DrawTileList(wxDC& dest)
 			const int y = *it / m_columns;
 			if ((y >= s) && (y <= e))
 			{
+				m_tile_buf.InsertTile(0, 0, 0, *it, *m_tileset, false);
+				m_tile_buf.UpdateBitmap(*m_tiles_bmp, { x * m_tilewidth, y * m_tileheight }, { m_selected_palette }, true);
+				// Kept in step so that a later palette edit can be applied to the whole buffer
 				m_buf.InsertTile(x * m_tilewidth, y * m_tileheight, 0, *it, *m_tileset, false);
 			}
 		}
 		it++;
 	}
-	auto img = m_buf.MakeImage({ m_selected_palette }, true);
-	m_tiles_bmp = std::make_unique<wxBitmap>(img);
 	wxMemoryDC tiles(*m_tiles_bmp);
 
 	it = m_redraw_list.begin();
@@ -496,6 +529,17 @@ void TilesetEditor::InitialiseBrushesAndPens()
 	m_highlighted_brush = std::make_unique<wxBrush>(*wxTRANSPARENT_BRUSH);
 }
 
+void TilesetEditor::RecolourTiles()
+{
+	if (m_tiles_bmp == nullptr)
+	{
+		ForceRedraw();
+		return;
+	}
+	m_recolour = true;
+	Refresh();
+}
+
 void TilesetEditor::ForceRedraw()
 {
 	m_redraw_all = true;
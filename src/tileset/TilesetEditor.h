@@ -30,6 +30,8 @@ public:
 	bool Open(std::vector<uint8_t>& pixels, bool uses_compression = false, int tile_width = 8, int tile_height = 8, int tile_bitdepth = 4);
 	bool New(int r, int c);
 	void RedrawTiles(int index = -1);
+	// Converts the tiles with the palette's current colours without decoding them again
+	void RecolourTiles();
 	void ForceRedraw();
 
 	void SetPixelSize(int n);
@@ -85,6 +87,7 @@ private:
 
 	bool UpdateRowCount();
 	void DrawAllTiles(wxDC& dest);
+	void RecolourAllTiles(wxDC& dest);
 	void DrawTileList(wxDC& dest);
 	void DrawGrid(wxDC& dest);
 	void DrawSelectionBorders(wxDC& dc);
@@ -125,6 +128,7 @@ private:
 	int m_ctrlheight;
 	std::set<int> m_redraw_list;
 	bool m_redraw_all;
+	bool m_recolour;
 	mutable std::vector<uint8_t> m_clipboard;
 	int m_pendingswap;
 
@@ -137,6 +141,7 @@ private:
 	std::unique_ptr<wxBitmap> m_tiles_bmp;
 
 	ImageBufferWx m_buf;
+	ImageBufferWx m_tile_buf;
 	wxBitmap m_bmp;
 	wxBitmap m_bg_bmp;
 
@@ -5,6 +5,7 @@
 #include <sstream>
 #include <exception>
 #include <landstalker/misc/Utils.h>
+#include <main/TileAtlas.h>
 #include <wx/artprov.h>
 
 enum TOOL_IDS
@@ -33,6 +34,7 @@ enum MENU_IDS
 	ID_FILE_EXPORT_PNG,
 	ID_FILE_IMPORT_BIN,
 	ID_FILE_IMPORT_PNG,
+	ID_EDIT,
 	ID_VIEW,
 	ID_VIEW_TOGGLE_GRIDLINES,
 	ID_VIEW_TOGGLE_TILE_NOS,
@@ -98,6 +100,7 @@ TilesetEditorFrame::TilesetEditorFrame(wxWindow* parent, ImageList* imglst)
 	m_tilesetEditor = new TilesetEditor(this);
 	m_paletteEditor = new PaletteEditor(this);
 	m_tileEditor = new TileEditor(this);
+	m_tileEditor->SetUndoJournal(&m_journal);
 
 	// add the panes to the manager
 	m_mgr.SetDockSizeConstraint(0.3, 0.3);
@@ -138,12 +141,14 @@ void TilesetEditorFrame::OnTileSelectionChanged(wxCommandEvent& evt)
 void TilesetEditorFrame::OnTileChanged(wxCommandEvent& evt)
 {
 	auto tile = std::stoi(evt.GetString().ToStdString());
+	TileAtlas::InvalidateTile(m_tileset.get(), tile);
 	m_tilesetEditor->RedrawTiles(tile);
 	evt.Skip();
 }
 
 void TilesetEditorFrame::OnTilesetChange(wxCommandEvent& evt)
 {
+	TileAtlas::InvalidateTileset(m_tileset.get());
 	m_tilesetEditor->RedrawTiles();
 	m_tileEditor->SetTile(m_tilesetEditor->GetSelectedTile());
 	m_tileEditor->Redraw();
@@ -190,6 +195,8 @@ void TilesetEditorFrame::InsertTileBefore()
 		if (m_tilesetEditor->IsSelectionValid())
 		{
 			m_tilesetEditor->InsertTileBefore(m_tilesetEditor->GetSelectedTile().GetIndex());
+			// Pixel history is keyed on tile numbers, which have just shifted
+			m_journal.Clear();
 		}
 		FireEvent(EVT_PROPERTIES_UPDATE);
 	}
@@ -206,6 +213,7 @@ void TilesetEditorFrame::InsertTileAfter()
 		if (m_tilesetEditor->IsSelectionValid())
 		{
 			m_tilesetEditor->InsertTileAfter(m_tilesetEditor->GetSelectedTile().GetIndex());
+			m_journal.Clear();
 		}
 		FireEvent(EVT_PROPERTIES_UPDATE);
 	}
@@ -227,6 +235,7 @@ void TilesetEditorFrame::ExtendTileset()
 			if (count >= 1)
 			{
 				m_tilesetEditor->InsertTilesAtEnd(count);
+				m_journal.Clear();
 			}
 			else
 			{
@@ -248,6 +257,7 @@ void TilesetEditorFrame::DeleteTile()
 		if (m_tilesetEditor->IsSelectionValid())
 		{
 			m_tilesetEditor->DeleteTileAt(m_tilesetEditor->GetSelectedTile().GetIndex());
+			m_journal.Clear();
 		}
 		FireEvent(EVT_PROPERTIES_UPDATE);
 	}
@@ -348,6 +358,7 @@ void TilesetEditorFrame::New()
 	m_tileset = std::make_shared<Landstalker::Tileset>();
 	m_tileset->Clear();
 	m_tileset->InsertTilesBefore(0, 1);
+	m_journal.Clear();
 	m_tilesetEditor->RedrawTiles();
 	m_tilesetEditor->SelectTile(0);
 	FireEvent(EVT_PROPERTIES_UPDATE);
@@ -362,6 +373,8 @@ void TilesetEditorFrame::ImportFromBin()
 		bool use_compression = path.substr(path.find_last_of(".") + 1) == "lz77";
 		auto bytes = Landstalker::ReadBytes(path);
 		m_tileset->SetBits(bytes, use_compression);
+		TileAtlas::InvalidateTileset(m_tileset.get());
+		m_journal.Clear();
 		m_tilesetEditor->ForceRedraw();
 		m_tilesetEditor->SelectTile(0);
 		m_paletteEditor->SetBitsPerPixel(m_tileset->GetTileBitDepth());
@@ -455,12 +468,22 @@ void TilesetEditorFrame::OnTileEditRequested(wxCommandEvent& evt)
 
 void TilesetEditorFrame::OnPaletteChanged(wxCommandEvent& evt)
 {
+	// The tiles are recoloured along with every other editor once the event reaches the main frame
 	m_paletteEditor->Refresh();
-	m_tilesetEditor->RedrawTiles();
-	m_tileEditor->Refresh();
 	evt.Skip();
 }
 
+void TilesetEditorFrame::RecolourPalette(const Landstalker::Palette* palette)
+{
+	if (m_selected_palette == nullptr || (palette != nullptr && palette != m_selected_palette->GetData().get()))
+	{
+		return;
+	}
+	m_paletteEditor->Refresh();
+	m_tilesetEditor->RecolourTiles();
+	m_tileEditor->Refresh();
+}
+
 void TilesetEditorFrame::OnPaletteColourSelect(wxCommandEvent& evt)
 {
 	m_tileEditor->SetPrimaryColour(m_paletteEditor->GetPrimaryColour());
@@ -709,11 +732,13 @@ void TilesetEditorFrame::InitMenu(wxMenuBar& menu, ImageList& ilist) const
 	AddMenuItem(fileMenu, 2, ID_FILE_EXPORT_ALL, "Export All Tilesets...");
 	AddMenuItem(fileMenu, 3, ID_FILE_EXPORT_PNG, "Export Tileset as PNG...");
 	AddMenuItem(fileMenu, 4, ID_FILE_IMPORT_BIN, "Import Tileset...");
-	auto& viewMenu = AddMenu(menu, 1, ID_VIEW, "View");
+	auto& editMenu = AddMenu(menu, 1, ID_EDIT, "Edit");
+	AddUndoMenuItems(editMenu, 0);
+	auto& viewMenu = AddMenu(menu, 2, ID_VIEW, "View");
 	AddMenuItem(viewMenu, 0, ID_VIEW_TOGGLE_GRIDLINES, "Gridlines", wxITEM_CHECK);
 	AddMenuItem(viewMenu, 1, ID_VIEW_TOGGLE_TILE_NOS, "Tile Numbers", wxITEM_CHECK);
 	AddMenuItem(viewMenu, 2, ID_VIEW_TOGGLE_ALPHA, "Show Alpha as Black", wxITEM_CHECK);
-	auto& toolsMenu = AddMenu(menu, 2, ID_TOOLS, "Tools");
+	auto& toolsMenu = AddMenu(menu, 3, ID_TOOLS, "Tools");
 	AddMenuItem(toolsMenu, 0, ID_TOOLS_PALETTE, "Palette", wxITEM_CHECK);
 	AddMenuItem(toolsMenu, 1, ID_TOOLS_EDITOR, "Tile Editor", wxITEM_CHECK);
 	AddMenuItem(toolsMenu, 2, ID_TOOLS_TILESET_TOOLBAR, "Tileset Toolbar", wxITEM_CHECK);
@@ -742,12 +767,14 @@ void TilesetEditorFrame::InitMenu(wxMenuBar& menu, ImageList& ilist) const
 	
 	wxAuiToolBar* draw_tb = new wxAuiToolBar(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxAUI_TB_DEFAULT_STYLE | wxAUI_TB_HORIZONTAL);
 	draw_tb->SetToolBitmapSize(wxSize(16, 16));
+	AddUndoTools(*draw_tb, "Draw", ilist);
 	draw_tb->AddTool(ID_DRAW_TOGGLE_GRIDLINES, "Toggle Gridlines", ilist.GetImage("gridlines"), "Toggle Gridlines", wxITEM_CHECK);
 	draw_tb->AddSeparator();
 	draw_tb->AddTool(ID_PENCIL, "Pencil", ilist.GetImage("pencil"), "Pencil", wxITEM_RADIO);
 	AddToolbar(m_mgr, *draw_tb, "Draw", "Drawing Tools", wxAuiPaneInfo().ToolbarPane().Top().Row(1));
 	
 	UpdateUI();
+	UpdateUndoUI();
 
 	m_mgr.Update();
 }
@@ -755,6 +782,10 @@ void TilesetEditorFrame::InitMenu(wxMenuBar& menu, ImageList& ilist) const
 void TilesetEditorFrame::OnMenuClick(wxMenuEvent& evt)
 {
 	const auto id = evt.GetId();
+	if (HandleUndoMenuClick(id))
+	{
+		return;
+	}
 	if ((id >= 20000) && (id < 31000))
 	{
 		switch(id)
@@ -850,6 +881,7 @@ void TilesetEditorFrame::ClearMenu(wxMenuBar& menu) const
 void TilesetEditorFrame::SetGameData(std::shared_ptr<Landstalker::GameData> gd)
 {
 	m_gd = gd;
+	m_journal.Clear();
 	m_tileEditor->SetGameData(gd);
 	m_paletteEditor->SetGameData(gd);
 	m_tilesetEditor->SetGameData(gd);
@@ -858,6 +890,7 @@ void TilesetEditorFrame::SetGameData(std::shared_ptr<Landstalker::GameData> gd)
 void TilesetEditorFrame::ClearGameData()
 {
 	m_gd = nullptr;
+	m_journal.Clear();
 	m_selected_palette = nullptr;
 	m_tileset = nullptr;
 	m_tileset_entry = nullptr;
@@ -888,6 +921,7 @@ bool TilesetEditorFrame::Open(std::vector<uint8_t>& pixels, bool uses_compressio
 	m_animated_tileset_entry = nullptr;
 	m_tileset_entry = nullptr;
 	m_tileset = nullptr;
+	m_journal.Clear();
 	if (retval)
 	{
 		m_tileset = m_tilesetEditor->GetTileset();
@@ -910,6 +944,7 @@ bool TilesetEditorFrame::Open(const std::string& name)
 	m_animated_tileset_entry = nullptr;
 	m_tileset_entry = nullptr;
 	m_tileset = nullptr;
+	m_journal.Clear();
 	if (retval)
 	{
 		m_tileset_entry = e;
@@ -935,6 +970,7 @@ bool TilesetEditorFrame::OpenAnimated(const std::string& name)
 	m_animated_tileset_entry = nullptr;
 	m_tileset_entry = nullptr;
 	m_tileset = nullptr;
+	m_journal.Clear();
 	if (retval)
 	{
 		m_animated_tileset_entry = e;
@@ -32,6 +32,7 @@ public:
 	virtual void ClearMenu(wxMenuBar& menu) const override;
 	virtual void SetGameData(std::shared_ptr<Landstalker::GameData> gd);
 	virtual void ClearGameData();
+	virtual void RecolourPalette(const Landstalker::Palette* palette) override;
 	void SetActivePalette(std::string name);
 	bool Open(std::vector<uint8_t>& pixels, bool uses_compression = false, int tile_width = 8, int tile_height = 8, int tile_bitdepth = 4);
 	bool Open(const std::string& name);
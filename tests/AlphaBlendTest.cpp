@@ -0,0 +1,158 @@
+#include <main/AlphaBlend.h>
+#include <TestCommon.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	std::vector<uint8_t> RandomBytes(std::size_t count, std::mt19937& rng)
+	{
+		std::vector<uint8_t> bytes(count);
+		std::uniform_int_distribution<int> dist(0, 255);
+		for (auto& b : bytes)
+		{
+			b = static_cast<uint8_t>(dist(rng));
+		}
+		return bytes;
+	}
+
+	// Sprite-like alpha: long runs of fully transparent and fully opaque pixels with
+	// some partial coverage, so the SIMD fast paths are exercised as well.
+	std::vector<uint8_t> RunAlpha(std::size_t count, std::mt19937& rng)
+	{
+		std::vector<uint8_t> alpha(count);
+		std::uniform_int_distribution<int> kind(0, 2);
+		std::uniform_int_distribution<int> len(1, 40);
+		std::uniform_int_distribution<int> partial(1, 254);
+		std::size_t i = 0;
+		while (i < count)
+		{
+			const int k = kind(rng);
+			const std::size_t end = std::min(count, i + len(rng));
+			for (; i < end; ++i)
+			{
+				alpha[i] = k == 0 ? 0x00 : k == 1 ? 0xFF : static_cast<uint8_t>(partial(rng));
+			}
+		}
+		return alpha;
+	}
+
+	void TestClampAlpha(std::mt19937& rng)
+	{
+		for (std::size_t count : { 0, 1, 15, 16, 17, 31, 32, 33, 100, 1031 })
+		{
+			for (uint8_t opacity : { 0x00, 0x7F, 0xFF })
+			{
+				const auto alpha = RandomBytes(count, rng);
+				const auto priority = RunAlpha(count, rng);
+				auto simd = alpha;
+				auto scalar = alpha;
+				AlphaBlend::ClampAlpha(simd.data(), count, opacity);
+				AlphaBlend::ClampAlphaScalar(scalar.data(), count, opacity);
+				CHECK(simd == scalar);
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					CHECK_EQ(scalar[i], std::min(alpha[i], opacity));
+				}
+
+				simd = alpha;
+				scalar = alpha;
+				AlphaBlend::ClampAlpha(simd.data(), priority.data(), count, opacity);
+				AlphaBlend::ClampAlphaScalar(scalar.data(), priority.data(), count, opacity);
+				CHECK(simd == scalar);
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					CHECK_EQ(scalar[i], std::max(priority[i], std::min(alpha[i], opacity)));
+				}
+			}
+		}
+	}
+
+	void TestBlendOver(std::mt19937& rng)
+	{
+		for (std::size_t count : { 1, 15, 16, 17, 48, 333, 1024 })
+		{
+			for (uint8_t opacity : { 0x00, 0x40, 0xC0, 0xFF })
+			{
+				const auto dst = RandomBytes(count * 3, rng);
+				const auto src = RandomBytes(count * 3, rng);
+				const auto alpha = RunAlpha(count, rng);
+				auto simd = dst;
+				auto scalar = dst;
+				AlphaBlend::BlendOver(simd.data(), src.data(), alpha.data(), count, opacity);
+				AlphaBlend::BlendOverScalar(scalar.data(), src.data(), alpha.data(), count, opacity);
+				CHECK(simd == scalar);
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					if (alpha[i] == 0 || opacity == 0)
+					{
+						CHECK_EQ(scalar[i * 3], dst[i * 3]);
+					}
+					else if (alpha[i] == 0xFF && opacity == 0xFF)
+					{
+						CHECK_EQ(scalar[i * 3], src[i * 3]);
+					}
+				}
+			}
+		}
+	}
+
+	void TestBlendOverAlpha(std::mt19937& rng)
+	{
+		for (std::size_t count : { 1, 16, 17, 64, 257, 1000 })
+		{
+			const auto dst = RandomBytes(count * 3, rng);
+			const auto dst_alpha = RunAlpha(count, rng);
+			const auto src = RandomBytes(count * 3, rng);
+			const auto src_alpha = RunAlpha(count, rng);
+			auto simd = dst;
+			auto simd_alpha = dst_alpha;
+			auto scalar = dst;
+			auto scalar_alpha = dst_alpha;
+			AlphaBlend::BlendOverAlpha(simd.data(), simd_alpha.data(), src.data(), src_alpha.data(), count);
+			AlphaBlend::BlendOverAlphaScalar(scalar.data(), scalar_alpha.data(), src.data(), src_alpha.data(), count);
+			CHECK(simd == scalar);
+			CHECK(simd_alpha == scalar_alpha);
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				CHECK(scalar_alpha[i] >= std::max(dst_alpha[i], src_alpha[i]));
+			}
+		}
+	}
+
+	void TestBlendOverImage()
+	{
+		wxImage dst(4, 2);
+		wxImage src(4, 2);
+		std::fill(dst.GetData(), dst.GetData() + 4 * 2 * 3, 0x00);
+		std::fill(src.GetData(), src.GetData() + 4 * 2 * 3, 0xFF);
+
+		// Without alpha the source is opaque
+		AlphaBlend::BlendOver(dst, src);
+		CHECK_EQ(dst.GetData()[0], 0xFF);
+
+		std::fill(dst.GetData(), dst.GetData() + 4 * 2 * 3, 0x00);
+		AlphaBlend::BlendOver(dst, src, 0x80);
+		CHECK_EQ(dst.GetData()[0], 0x80);
+
+		std::fill(dst.GetData(), dst.GetData() + 4 * 2 * 3, 0x00);
+		src.InitAlpha();
+		std::fill(src.GetAlpha(), src.GetAlpha() + 4 * 2, 0x00);
+		src.GetAlpha()[1] = 0xFF;
+		AlphaBlend::BlendOver(dst, src);
+		CHECK_EQ(dst.GetData()[0], 0x00);
+		CHECK_EQ(dst.GetData()[3], 0xFF);
+	}
+}
+
+int main()
+{
+	std::mt19937 rng(1234);
+	TestClampAlpha(rng);
+	TestBlendOver(rng);
+	TestBlendOverAlpha(rng);
+	TestBlendOverImage();
+	return TEST_RESULT();
+}
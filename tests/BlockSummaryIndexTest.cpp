@@ -0,0 +1,106 @@
+#include <blockset/BlockSummaryIndex.h>
+#include <TestCommon.h>
+
+#include <memory>
+
+using Landstalker::Blockset;
+using Landstalker::MapBlock;
+using Landstalker::Tile;
+using Landstalker::TileAttributes;
+
+namespace
+{
+	MapBlock MakeBlock(uint16_t index, std::size_t tile, TileAttributes::Attribute attr)
+	{
+		MapBlock block;
+		Tile t(index);
+		t.Attributes().toggleAttribute(attr);
+		block.SetTile(tile, t);
+		return block;
+	}
+
+	void TestSummaries()
+	{
+		auto blockset = std::make_shared<Blockset>();
+		blockset->push_back(MapBlock());
+		blockset->push_back(MakeBlock(5, 1, TileAttributes::Attribute::ATTR_PRIORITY));
+		blockset->push_back(MakeBlock(0, 3, TileAttributes::Attribute::ATTR_HFLIP));
+		blockset->push_back(MakeBlock(9, 2, TileAttributes::Attribute::ATTR_VFLIP));
+		auto index = BlockSummaryIndex::Get(blockset);
+
+		CHECK(index->IsBlank(0));
+		CHECK(!index->HasPriority(0));
+		CHECK(!index->HasFlip(0));
+
+		CHECK(!index->IsBlank(1));
+		CHECK_EQ(index->GetPriorityMask(1), 0x02);
+		CHECK(!index->HasFlip(1));
+
+		CHECK(index->IsBlank(2));
+		CHECK(index->HasFlip(2));
+		CHECK_EQ(index->GetSummary(2).hflip, 0x08);
+
+		CHECK(index->HasFlip(3));
+		CHECK_EQ(index->GetSummary(3).vflip, 0x04);
+
+		// Out of range blocks report an empty summary
+		CHECK(index->IsBlank(-1));
+		CHECK(!index->HasPriority(4));
+	}
+
+	void TestSharedAndExpired()
+	{
+		auto blockset = std::make_shared<Blockset>(2);
+		auto a = BlockSummaryIndex::Get(blockset);
+		auto b = BlockSummaryIndex::Get(blockset);
+		CHECK(a == b);
+		CHECK(BlockSummaryIndex::Get(nullptr) == nullptr);
+
+		std::weak_ptr<BlockSummaryIndex> weak = a;
+		a.reset();
+		b.reset();
+		blockset.reset();
+		// Getting any other index drops the entries for destroyed blocksets
+		auto other = std::make_shared<Blockset>(1);
+		BlockSummaryIndex::Get(other);
+		CHECK(weak.expired());
+	}
+
+	void TestIncrementalUpdates()
+	{
+		auto blockset = std::make_shared<Blockset>(3);
+		auto index = BlockSummaryIndex::Get(blockset);
+		CHECK(index->IsBlank(1));
+
+		blockset->at(1) = MakeBlock(7, 0, TileAttributes::Attribute::ATTR_PRIORITY);
+		index->Update(1);
+		CHECK(!index->IsBlank(1));
+		CHECK_EQ(index->GetPriorityMask(1), 0x01);
+
+		blockset->insert(blockset->begin(), MakeBlock(3, 2, TileAttributes::Attribute::ATTR_PRIORITY));
+		index->Insert(0);
+		CHECK_EQ(index->GetPriorityMask(0), 0x04);
+		CHECK_EQ(index->GetPriorityMask(2), 0x01);
+
+		blockset->erase(blockset->begin());
+		index->Erase(0);
+		CHECK_EQ(index->GetPriorityMask(1), 0x01);
+		CHECK(!index->HasPriority(0));
+
+		// Changes made without telling the index are picked up after Invalidate, and a
+		// resized blockset is always rebuilt
+		blockset->at(0) = MakeBlock(1, 0, TileAttributes::Attribute::ATTR_HFLIP);
+		BlockSummaryIndex::Invalidate(blockset.get());
+		CHECK(index->HasFlip(0));
+		blockset->push_back(MakeBlock(2, 1, TileAttributes::Attribute::ATTR_PRIORITY));
+		CHECK_EQ(index->GetPriorityMask(3), 0x02);
+	}
+}
+
+int main()
+{
+	TestSummaries();
+	TestSharedAndExpired();
+	TestIncrementalUpdates();
+	return TEST_RESULT();
+}
@@ -0,0 +1,114 @@
+#include <2d_maps/MapChunkCache.h>
+#include <TestCommon.h>
+
+#include <set>
+#include <vector>
+
+namespace
+{
+	void TestLayout()
+	{
+		MapChunkCache cache(16, 1024);
+		CHECK_EQ(cache.GetColumns(), 0);
+		CHECK_EQ(cache.GetRows(), 0);
+		cache.SetMapSize(40, 16);
+		CHECK_EQ(cache.GetColumns(), 3);
+		CHECK_EQ(cache.GetRows(), 1);
+		CHECK_EQ(cache.GetKey(2, 0), 2);
+		cache.SetMapSize(16, 17);
+		CHECK_EQ(cache.GetColumns(), 1);
+		CHECK_EQ(cache.GetRows(), 2);
+		CHECK_EQ(cache.GetKey(0, 1), 1);
+	}
+
+	void TestInvalidation()
+	{
+		MapChunkCache cache(4, 1024);
+		cache.SetMapSize(8, 8);
+		// Chunks not in the cache have nothing to invalidate
+		CHECK(!cache.InvalidateTile(0));
+		CHECK(cache.TakeDirtyTiles(0).empty());
+
+		cache.Insert(cache.GetKey(1, 0), 16);
+		CHECK(!cache.InvalidateTile(0));
+		// (5, 0), (4, 3) and (7, 1) all lie in the chunk at (1, 0)
+		CHECK(cache.InvalidateTile(5));
+		CHECK(cache.InvalidateTile(3 * 8 + 4));
+		CHECK(cache.InvalidateTile(1 * 8 + 7));
+		CHECK(cache.InvalidateTile(5));
+		CHECK(!cache.InvalidateTile(4 * 8 + 4));
+		CHECK(!cache.InvalidateTile(-1));
+		CHECK(!cache.InvalidateTile(64));
+
+		// Dirty tiles come back in row-major order, once
+		CHECK(cache.TakeDirtyTiles(1) == (std::set<int>{ 5, 15, 28 }));
+		CHECK(cache.TakeDirtyTiles(1).empty());
+
+		// A chunk drawn again in full starts out clean
+		CHECK(cache.InvalidateTile(5));
+		cache.Insert(1, 16);
+		CHECK(cache.TakeDirtyTiles(1).empty());
+		CHECK_EQ(cache.GetBytes(), 16u);
+	}
+
+	void TestResize()
+	{
+		MapChunkCache cache(4, 1024);
+		cache.SetMapSize(8, 8);
+		cache.Insert(0, 16);
+		cache.Insert(3, 16);
+		CHECK_EQ(cache.GetCount(), 2u);
+
+		// Keeping the same dimensions keeps the chunks
+		cache.SetMapSize(8, 8);
+		CHECK_EQ(cache.GetCount(), 2u);
+
+		// Chunk keys depend on the map width, so resizing drops everything
+		cache.SetMapSize(12, 8);
+		CHECK_EQ(cache.GetCount(), 0u);
+		CHECK_EQ(cache.GetBytes(), 0u);
+		CHECK(!cache.InvalidateTile(0));
+
+		cache.Insert(0, 16);
+		cache.Clear();
+		CHECK(!cache.IsCached(0));
+		CHECK_EQ(cache.GetBytes(), 0u);
+	}
+
+	void TestEviction()
+	{
+		MapChunkCache cache(4, 100);
+		cache.SetMapSize(16, 16);
+		cache.Insert(0, 40);
+		cache.Insert(1, 40);
+		CHECK(cache.Evict().empty());
+
+		// Touching chunk 0 makes chunk 1 the least recently used
+		CHECK(cache.Touch(0));
+		CHECK(!cache.Touch(2));
+		cache.Insert(2, 40);
+		CHECK(cache.Evict() == (std::vector<int>{ 1 }));
+		CHECK(cache.IsCached(0));
+		CHECK(!cache.IsCached(1));
+		CHECK(cache.IsCached(2));
+		CHECK_EQ(cache.GetBytes(), 80u);
+		// An evicted chunk has nothing to invalidate
+		CHECK(!cache.InvalidateTile(4));
+
+		// The most recently used chunk is kept even when it alone is over the limit
+		cache.Insert(3, 500);
+		CHECK(cache.Evict() == (std::vector<int>{ 0, 2 }));
+		CHECK(cache.IsCached(3));
+		CHECK_EQ(cache.GetCount(), 1u);
+		CHECK_EQ(cache.GetBytes(), 500u);
+	}
+}
+
+int main()
+{
+	TestLayout();
+	TestInvalidation();
+	TestResize();
+	TestEviction();
+	return TEST_RESULT();
+}
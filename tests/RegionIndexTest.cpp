@@ -0,0 +1,92 @@
+#include <rooms/RegionIndex.h>
+#include <TestCommon.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+	void TestEmpty()
+	{
+		RegionIndex index;
+		CHECK(index.IsEmpty());
+		CHECK(index.GetCandidates(0, 0).empty());
+		index.Insert(1, wxRect());
+		index.Insert(2, std::vector<wxPoint>{});
+		index.Insert(3, std::vector<wxPoint2DDouble>{});
+		CHECK(index.IsEmpty());
+	}
+
+	void TestBoundsAndOrder()
+	{
+		RegionIndex index(16);
+		index.Insert(7, wxRect(10, 10, 30, 30));
+		index.Insert(3, std::vector<wxPoint>{ {20, 20}, {60, 25}, {25, 50} });
+		index.Insert(5, std::vector<wxPoint2DDouble>{ {-20.5, -20.5}, {12.2, 15.7} });
+		CHECK(!index.IsEmpty());
+
+		// Overlapping regions come back in insertion order
+		CHECK(index.GetCandidates(22, 22) == (std::vector<int>{ 7, 3 }));
+		CHECK(index.GetCandidates(11, 11) == (std::vector<int>{ 7, 5 }));
+		CHECK(index.GetCandidates(60, 25) == (std::vector<int>{ 3 }));
+		CHECK(index.GetCandidates(61, 25).empty());
+		// Fractional polygon bounds are rounded outwards
+		CHECK(index.GetCandidates(-21, -21) == (std::vector<int>{ 5 }));
+		CHECK(index.GetCandidates(13, 16) == (std::vector<int>{ 7, 5 }));
+		CHECK(index.GetCandidates(-22, 0).empty());
+
+		index.Clear();
+		CHECK(index.IsEmpty());
+		CHECK(index.GetCandidates(22, 22).empty());
+	}
+
+	void TestGetBounds()
+	{
+		const wxRect r = RegionIndex::GetBounds({ {5, 8}, {-3, 12}, {7, -1} });
+		CHECK_EQ(r.GetLeft(), -3);
+		CHECK_EQ(r.GetTop(), -1);
+		CHECK_EQ(r.GetRight(), 7);
+		CHECK_EQ(r.GetBottom(), 12);
+		CHECK(RegionIndex::GetBounds({}).IsEmpty());
+	}
+
+	// The index must return exactly the regions a linear scan over the bounds would
+	void TestAgainstLinearScan()
+	{
+		std::mt19937 rng(42);
+		std::uniform_int_distribution<int> pos(-200, 600);
+		std::uniform_int_distribution<int> size(1, 150);
+		std::vector<std::pair<int, wxRect>> rects;
+		RegionIndex index(32);
+		for (int id = 0; id < 200; ++id)
+		{
+			const wxRect r(pos(rng), pos(rng), size(rng), size(rng));
+			rects.emplace_back(id, r);
+			index.Insert(id, r);
+		}
+		for (int i = 0; i < 2000; ++i)
+		{
+			const int x = pos(rng);
+			const int y = pos(rng);
+			std::vector<int> expected;
+			for (const auto& [id, r] : rects)
+			{
+				if (r.Contains(x, y))
+				{
+					expected.push_back(id);
+				}
+			}
+			CHECK(index.GetCandidates(x, y) == expected);
+		}
+	}
+}
+
+int main()
+{
+	TestEmpty();
+	TestBoundsAndOrder();
+	TestGetBounds();
+	TestAgainstLinearScan();
+	return TEST_RESULT();
+}
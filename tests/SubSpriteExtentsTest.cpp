@@ -0,0 +1,71 @@
+#include <sprites/SubSpriteExtents.h>
+#include <TestCommon.h>
+
+#include <set>
+#include <vector>
+
+namespace
+{
+	using Extent = SubSpriteExtents::Extent;
+
+	// An 8x8 grid with the origin at cell (4, 4) and 8x8 pixel tiles
+	SubSpriteExtents MakeExtents()
+	{
+		return SubSpriteExtents(8, 8, 4, 4);
+	}
+
+	void TestUnchanged()
+	{
+		auto extents = MakeExtents();
+		const std::vector<Extent> subsprites{ { 0, 0, 2, 2 }, { -16, -8, 1, 1 } };
+		extents.Reset(subsprites);
+		CHECK(extents.Update(subsprites, 8, 8).empty());
+		CHECK(extents.Update({}, 8, 8) == (std::set<int>{ 36, 37, 44, 45, 26 }));
+		CHECK(extents.Update({}, 8, 8).empty());
+	}
+
+	void TestMove()
+	{
+		auto extents = MakeExtents();
+		extents.Reset({ { 0, 0, 1, 2 }, { 8, -8, 1, 1 } });
+		// Only the moved subsprite counts, at both its old and its new cells
+		CHECK(extents.Update({ { 8, 0, 1, 2 }, { 8, -8, 1, 1 } }, 8, 8) == (std::set<int>{ 36, 44, 37, 45 }));
+		// The new position is remembered as drawn
+		CHECK(extents.Update({ { 8, 0, 1, 2 }, { 8, -8, 1, 1 } }, 8, 8).empty());
+		// Resizing covers the union of both sizes
+		CHECK(extents.Update({ { 8, 0, 2, 1 }, { 8, -8, 1, 1 } }, 8, 8) == (std::set<int>{ 37, 45, 38 }));
+	}
+
+	void TestAddRemoveAndReorder()
+	{
+		auto extents = MakeExtents();
+		extents.Reset({ { 0, 0, 1, 1 } });
+		CHECK(extents.Update({ { 0, 0, 1, 1 }, { -8, 0, 1, 1 } }, 8, 8) == (std::set<int>{ 35 }));
+		// Extents are matched by index, so swapping two subsprites redraws both
+		CHECK(extents.Update({ { -8, 0, 1, 1 }, { 0, 0, 1, 1 } }, 8, 8) == (std::set<int>{ 35, 36 }));
+		CHECK(extents.Update({ { -8, 0, 1, 1 } }, 8, 8) == (std::set<int>{ 36 }));
+	}
+
+	void TestClipping()
+	{
+		auto extents = MakeExtents();
+		// Cells outside the grid are dropped rather than wrapped onto other rows
+		CHECK(extents.Update({ { -48, -48, 2, 2 } }, 8, 8).empty());
+		extents.Reset({});
+		CHECK(extents.Update({ { 24, 24, 4, 4 } }, 8, 8) == (std::set<int>{ 63 }));
+		extents.Reset({});
+		CHECK(extents.Update({ { -40, 0, 2, 1 } }, 8, 8) == (std::set<int>{ 32 }));
+		// Tile size scales the pixel offsets
+		extents.Reset({});
+		CHECK(extents.Update({ { 16, 16, 1, 1 } }, 16, 16) == (std::set<int>{ 45 }));
+	}
+}
+
+int main()
+{
+	TestUnchanged();
+	TestMove();
+	TestAddRemoveAndReorder();
+	TestClipping();
+	return TEST_RESULT();
+}
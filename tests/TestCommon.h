@@ -0,0 +1,52 @@
+#ifndef _TEST_COMMON_H_
+#define _TEST_COMMON_H_
+
+#include <cstdint>
+#include <iostream>
+
+// Minimal check macros for the unit tests. Each test executable returns the number of
+// failed checks, so ctest reports any non-zero count as a failure.
+
+namespace TestCommon
+{
+	inline int& Failures()
+	{
+		static int failures = 0;
+		return failures;
+	}
+
+	// Prints byte values as numbers rather than characters
+	template <class T>
+	const T& Printable(const T& value)
+	{
+		return value;
+	}
+
+	inline int Printable(uint8_t value)
+	{
+		return value;
+	}
+}
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #cond ") failed" << std::endl; \
+			++TestCommon::Failures(); \
+		} \
+	} while (0)
+
+#define CHECK_EQ(a, b) \
+	do { \
+		const auto& _a = (a); \
+		const auto& _b = (b); \
+		if (!(_a == _b)) { \
+			std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK_EQ(" #a ", " #b ") failed: " \
+			          << TestCommon::Printable(_a) << " != " << TestCommon::Printable(_b) << std::endl; \
+			++TestCommon::Failures(); \
+		} \
+	} while (0)
+
+#define TEST_RESULT() (TestCommon::Failures() == 0 ? 0 : 1)
+
+#endif // _TEST_COMMON_H_
@@ -0,0 +1,130 @@
+#include <main/TileAtlas.h>
+#include <TestCommon.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+using Landstalker::Palette;
+using Landstalker::Tile;
+using Landstalker::TileAttributes;
+using Landstalker::Tileset;
+
+namespace
+{
+	std::shared_ptr<Tileset> MakeTileset(int count)
+	{
+		auto tileset = std::make_shared<Tileset>();
+		tileset->InsertTilesBefore(0, count);
+		for (int i = 0; i < count; ++i)
+		{
+			auto& pixels = tileset->GetTilePixels(i);
+			std::fill(pixels.begin(), pixels.end(), 1);
+		}
+		return tileset;
+	}
+
+	std::shared_ptr<Palette> MakePalette()
+	{
+		auto palette = std::make_shared<Palette>();
+		palette->setGenesisColour(1, 0x0EEE);
+		palette->setGenesisColour(2, 0x000E);
+		return palette;
+	}
+
+	// Changes a tile's pixels without telling the atlas, so that a cached copy can be told
+	// apart from a freshly decoded one
+	void Repaint(Tileset& tileset, int tile)
+	{
+		auto& pixels = tileset.GetTilePixels(tile);
+		std::fill(pixels.begin(), pixels.end(), 2);
+	}
+
+	void TestCaching()
+	{
+		TileAtlas::Clear();
+		auto tileset = MakeTileset(4);
+		auto palette = MakePalette();
+		const Tile tile(0);
+
+		const auto first = TileAtlas::GetTile(tileset, palette, tile);
+		CHECK(first == tileset->GetTileBGRA(tile, *palette));
+		const std::size_t bytes = TileAtlas::GetBytes();
+		CHECK(bytes > 0);
+
+		Repaint(*tileset, 0);
+		CHECK(tileset->GetTileBGRA(tile, *palette) != first);
+		CHECK(TileAtlas::GetTile(tileset, palette, tile) == first);
+		CHECK_EQ(TileAtlas::GetBytes(), bytes);
+
+		// Flipped tiles are decoded and cached separately
+		Tile flipped(0);
+		flipped.Attributes().toggleAttribute(TileAttributes::Attribute::ATTR_HFLIP);
+		CHECK(TileAtlas::GetTile(tileset, palette, flipped) == tileset->GetTileBGRA(flipped, *palette));
+		CHECK_EQ(TileAtlas::GetBytes(), bytes * 2);
+
+		TileAtlas::InvalidateTile(tileset.get(), 0);
+		CHECK_EQ(TileAtlas::GetBytes(), 0u);
+		CHECK(TileAtlas::GetTile(tileset, palette, tile) == tileset->GetTileBGRA(tile, *palette));
+	}
+
+	void TestInvalidate()
+	{
+		TileAtlas::Clear();
+		auto tileset = MakeTileset(2);
+		auto other = MakeTileset(2);
+		auto palette = MakePalette();
+		TileAtlas::GetTile(tileset, palette, Tile(0));
+		TileAtlas::GetTile(other, palette, Tile(0));
+		const std::size_t bytes = TileAtlas::GetBytes();
+
+		TileAtlas::InvalidateTileset(tileset.get());
+		CHECK_EQ(TileAtlas::GetBytes(), bytes / 2);
+		TileAtlas::InvalidatePalette(palette.get());
+		CHECK_EQ(TileAtlas::GetBytes(), 0u);
+
+		// Pages for destroyed tilesets are dropped when another page is created
+		TileAtlas::GetTile(tileset, palette, Tile(0));
+		tileset.reset();
+		TileAtlas::GetTile(other, palette, Tile(1));
+		CHECK_EQ(TileAtlas::GetBytes(), bytes / 2);
+	}
+
+	void TestLeastRecentlyUsed()
+	{
+		TileAtlas::Clear();
+		TileAtlas::SetMaxBytes(TileAtlas::DEFAULT_MAX_BYTES);
+		auto tileset = MakeTileset(4);
+		auto palette = MakePalette();
+		TileAtlas::GetTile(tileset, palette, Tile(0));
+		const std::size_t entry = TileAtlas::GetBytes();
+		TileAtlas::SetMaxBytes(entry * 3);
+
+		TileAtlas::GetTile(tileset, palette, Tile(1));
+		TileAtlas::GetTile(tileset, palette, Tile(2));
+		const auto cached = TileAtlas::GetTile(tileset, palette, Tile(0));
+		// Tile 1 is now the least recently used, and makes way for tile 3
+		TileAtlas::GetTile(tileset, palette, Tile(3));
+		CHECK_EQ(TileAtlas::GetBytes(), entry * 3);
+
+		Repaint(*tileset, 0);
+		Repaint(*tileset, 1);
+		CHECK(TileAtlas::GetTile(tileset, palette, Tile(0)) == cached);
+		CHECK(TileAtlas::GetTile(tileset, palette, Tile(1)) == tileset->GetTileBGRA(Tile(1), *palette));
+		CHECK(TileAtlas::GetTile(tileset, palette, Tile(1)) != cached);
+
+		// The most recent tile is kept even when it alone exceeds the limit
+		TileAtlas::SetMaxBytes(1);
+		CHECK_EQ(TileAtlas::GetBytes(), entry);
+		TileAtlas::SetMaxBytes(TileAtlas::DEFAULT_MAX_BYTES);
+		TileAtlas::Clear();
+	}
+}
+
+int main()
+{
+	TestCaching();
+	TestInvalidate();
+	TestLeastRecentlyUsed();
+	return TEST_RESULT();
+}
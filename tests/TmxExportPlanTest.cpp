@@ -0,0 +1,65 @@
+#include <rooms/TmxExportPlan.h>
+#include <TestCommon.h>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+	const std::vector<TmxExportPlan::Room> ROOMS{
+		{ 0, "Room000", "MapA", "BT01_12_p01.png" },
+		{ 1, "Room001", "MapA", "BT01_12_p02.png" },
+		{ 2, "Room002", "MapB", "BT01_12_p01.png" },
+		{ 3, "Room003", "MapC", "BT02_34_p01.png" },
+		{ 4, "Room004", "MapB", "BT02_34_p01.png" },
+	};
+
+	std::vector<std::string> GetNames(const std::vector<TmxExportPlan::File>& files)
+	{
+		std::vector<std::string> names;
+		for (const auto& f : files)
+		{
+			names.push_back(f.name);
+		}
+		return names;
+	}
+
+	void TestRooms()
+	{
+		const TmxExportPlan plan(ROOMS, true);
+		// Each blockset image is rendered once, from the first room that uses it
+		CHECK(GetNames(plan.GetBlocksets()) == (std::vector<std::string>{ "BT01_12_p01.png", "BT01_12_p02.png", "BT02_34_p01.png" }));
+		CHECK_EQ(plan.GetBlocksets()[0].roomnum, 0);
+		CHECK_EQ(plan.GetBlocksets()[1].roomnum, 1);
+		CHECK_EQ(plan.GetBlocksets()[2].roomnum, 3);
+		// Every room gets its own TMX file, referring to the shared image
+		CHECK(GetNames(plan.GetTmxFiles()) == (std::vector<std::string>{ "Room000.tmx", "Room001.tmx", "Room002.tmx", "Room003.tmx", "Room004.tmx" }));
+		CHECK_EQ(plan.GetTmxFiles()[2].blockset, std::string("BT01_12_p01.png"));
+		CHECK_EQ(plan.GetTmxFiles()[4].blockset, std::string("BT02_34_p01.png"));
+	}
+
+	void TestMaps()
+	{
+		const TmxExportPlan plan(ROOMS, false);
+		// Only the first room of each map is exported, so Room001's palette is never needed
+		CHECK(GetNames(plan.GetTmxFiles()) == (std::vector<std::string>{ "MapA.tmx", "MapB.tmx", "MapC.tmx" }));
+		CHECK_EQ(plan.GetTmxFiles()[1].roomnum, 2);
+		CHECK_EQ(plan.GetTmxFiles()[1].blockset, std::string("BT01_12_p01.png"));
+		CHECK(GetNames(plan.GetBlocksets()) == (std::vector<std::string>{ "BT01_12_p01.png", "BT02_34_p01.png" }));
+	}
+
+	void TestEmpty()
+	{
+		const TmxExportPlan plan({}, true);
+		CHECK(plan.GetBlocksets().empty());
+		CHECK(plan.GetTmxFiles().empty());
+	}
+}
+
+int main()
+{
+	TestRooms();
+	TestMaps();
+	TestEmpty();
+	return TEST_RESULT();
+}
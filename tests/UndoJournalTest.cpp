@@ -0,0 +1,171 @@
+#include <main/UndoJournal.h>
+#include <TestCommon.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+namespace
+{
+	using Cells = std::map<int, int>;
+
+	std::unique_ptr<CellDelta<int, int>> MakeEdit(Cells& cells, std::initializer_list<std::pair<int, int>> values)
+	{
+		auto delta = std::make_unique<CellDelta<int, int>>(&cells,
+			[&cells](const int& key, const int& value) { cells[key] = value; }, nullptr);
+		for (const auto& [key, value] : values)
+		{
+			delta->Add(key, cells[key], value);
+			cells[key] = value;
+		}
+		return delta;
+	}
+
+	void TestUndoRedo()
+	{
+		Cells cells;
+		UndoJournal journal;
+		int changes = 0;
+		journal.SetChangeHandler([&changes]() { ++changes; });
+		CHECK(!journal.CanUndo());
+		CHECK(!journal.CanRedo());
+
+		journal.Push("Paint", MakeEdit(cells, { {1, 10}, {2, 20} }));
+		journal.Push("Fill", MakeEdit(cells, { {1, 30} }));
+		CHECK(journal.CanUndo());
+		CHECK_EQ(journal.GetUndoDescription(), std::string("Fill"));
+		CHECK(changes > 0);
+
+		journal.Undo();
+		CHECK_EQ(cells[1], 10);
+		CHECK_EQ(journal.GetRedoDescription(), std::string("Fill"));
+		journal.Undo();
+		CHECK_EQ(cells[1], 0);
+		CHECK_EQ(cells[2], 0);
+		CHECK(!journal.CanUndo());
+
+		journal.Redo();
+		CHECK_EQ(cells[1], 10);
+		CHECK_EQ(cells[2], 20);
+		journal.Redo();
+		CHECK_EQ(cells[1], 30);
+		CHECK(!journal.CanRedo());
+
+		// A new edit discards the redo steps
+		journal.Undo();
+		journal.Push("Paint", MakeEdit(cells, { {3, 5} }));
+		CHECK(!journal.CanRedo());
+		CHECK_EQ(journal.GetUndoDescription(), std::string("Paint"));
+
+		journal.Clear();
+		CHECK(!journal.CanUndo());
+		CHECK_EQ(journal.GetBytes(), 0u);
+	}
+
+	void TestStrokes()
+	{
+		Cells cells;
+		UndoJournal journal;
+		{
+			StrokeGuard outer(journal, "Pencil");
+			journal.Push("Edit Cell", MakeEdit(cells, { {1, 1} }));
+			{
+				StrokeGuard inner(journal, "Inner");
+				CHECK(journal.IsStrokeOpen());
+				journal.Push("Edit Cell", MakeEdit(cells, { {1, 2}, {2, 2} }));
+			}
+			journal.Push("Edit Cell", MakeEdit(cells, { {3, 3} }));
+		}
+		CHECK(!journal.IsStrokeOpen());
+		CHECK_EQ(journal.GetUndoDescription(), std::string("Pencil"));
+
+		// The whole stroke is undone in one step, restoring the first old value of each cell
+		journal.Undo();
+		CHECK(!journal.CanUndo());
+		CHECK_EQ(cells[1], 0);
+		CHECK_EQ(cells[2], 0);
+		CHECK_EQ(cells[3], 0);
+		journal.Redo();
+		CHECK_EQ(cells[1], 2);
+		CHECK_EQ(cells[3], 3);
+	}
+
+	void TestCoalesce()
+	{
+		Cells cells;
+		UndoJournal journal;
+		journal.Push("Type", MakeEdit(cells, { {1, 1} }), true);
+		journal.Push("Type", MakeEdit(cells, { {1, 2} }), true);
+		journal.Push("Other", MakeEdit(cells, { {2, 1} }), true);
+		journal.Push("Other", MakeEdit(cells, { {2, 2} }), false);
+		journal.Undo();
+		CHECK_EQ(cells[2], 1);
+		journal.Undo();
+		CHECK_EQ(cells[2], 0);
+		journal.Undo();
+		CHECK_EQ(cells[1], 0);
+		CHECK(!journal.CanUndo());
+	}
+
+	void TestMemoryLimit()
+	{
+		Cells cells;
+		UndoJournal journal;
+		journal.Push("A", MakeEdit(cells, { {1, 1} }));
+		const std::size_t step = journal.GetBytes();
+		CHECK(step > 0);
+		journal.SetMaxBytes(step * 2);
+		journal.Push("B", MakeEdit(cells, { {2, 1} }));
+		journal.Push("C", MakeEdit(cells, { {3, 1} }));
+		CHECK(journal.GetBytes() <= journal.GetMaxBytes());
+		journal.Undo();
+		journal.Undo();
+		CHECK(!journal.CanUndo());
+		CHECK_EQ(cells[1], 1);
+		CHECK_EQ(cells[2], 0);
+
+		// The most recent step is kept even when it alone exceeds the limit
+		journal.Clear();
+		journal.SetMaxBytes(1);
+		journal.Push("Big", MakeEdit(cells, { {1, 2}, {2, 2}, {3, 2} }));
+		CHECK(journal.CanUndo());
+	}
+
+	void TestActionDelta()
+	{
+		std::string text = "ab";
+		UndoJournal journal;
+		text += "c";
+		journal.Push("Append", std::make_unique<ActionDelta>(
+			[&text]() { text.pop_back(); },
+			[&text]() { text += "c"; }));
+		journal.Undo();
+		CHECK_EQ(text, std::string("ab"));
+		journal.Redo();
+		CHECK_EQ(text, std::string("abc"));
+	}
+
+	// Edits pushed by the undo callbacks themselves must not be recorded
+	void TestReentrantPush()
+	{
+		Cells cells;
+		UndoJournal journal;
+		journal.Push("Edit", std::make_unique<ActionDelta>(
+			[&]() { journal.Push("Nested", MakeEdit(cells, { {1, 1} })); },
+			[]() {}));
+		journal.Undo();
+		CHECK(!journal.CanUndo());
+		CHECK(journal.CanRedo());
+	}
+}
+
+int main()
+{
+	TestUndoRedo();
+	TestStrokes();
+	TestCoalesce();
+	TestMemoryLimit();
+	TestActionDelta();
+	TestReentrantPush();
+	return TEST_RESULT();
+}